@@ -31,8 +31,15 @@
  */
 
 #include "node/Node.h"
+#include "node/SuccinctTree.h"
+#include "node/SubtreeDag.h"
+#include "node/IndexStore.h"
 #include "distance/Apted.h"
+#include "distance/AdaptiveApted.h"
+#include "distance/PairExecutor.h"
+#include "distance/LabelSequenceBound.h"
 
 #include "CostModel.h"
 #include "InputParser.h"
 #include "StringNodeData.h"
+#include "StringNodeSerializer.h"
@@ -54,13 +54,13 @@ public:
      * @brief Construtor da classe StringNodeData.
      * @param label Rótulo do nó.
      */
-    StringNodeData(std::string label) : label(label) { }
+    StringNodeData(std::string label) : label(std::move(label)) { }
 
     /**
      * @brief Obtém o rótulo do nó.
-     * @return Rótulo do nó.
+     * @return Referência constante para o rótulo do nó.
      */
-    std::string getLabel() const { return label; }
+    const std::string &getLabel() const { return label; }
 };
 
 /**
@@ -74,6 +74,20 @@ inline std::ostream &operator<<(std::ostream &os, StringNodeData const &stringNo
     return os;
 }
 
+/**
+ * @brief Hash do rótulo, usado por NodeIndexer::save/load para reconhecer a
+ *        árvore do cache. FNV-1a, estável entre execuções (std::hash não garante isso).
+ * @param stringNode Dados do nó como string.
+ * @return Hash de 64 bits do rótulo.
+ */
+inline uint64_t hashNodeData(StringNodeData const &stringNode) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : stringNode.getLabel()) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
 /**
  * @brief Sobrecarga do operador de inserção em stream para Node<StringNodeData>.
  * @param os Stream de saída.
@@ -83,7 +97,7 @@ inline std::ostream &operator<<(std::ostream &os, StringNodeData const &stringNo
 inline std::ostream &operator<<(std::ostream &os, Node<StringNodeData> const &node) {
     os << "{";
     os << *node.getData();
-    for (Node<StringNodeData>* child : node.getChildren()) {
+    for (const Node<StringNodeData>* child : node.getChildren()) {
         os << *child;
     }
     os << "}";
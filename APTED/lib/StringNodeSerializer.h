@@ -0,0 +1,323 @@
+#pragma once
+
+/**
+ * @file StringNodeSerializer.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Serialização iterativa de árvores de StringNodeData em notação de chaves
+ *        e em formato binário, escrevendo diretamente em um buffer pré-alocado
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <list>
+#include <utility>
+#include "StringNodeData.h"
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Percurso iterativo
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Percorre a árvore em profundidade sem recursão e sem copiar listas de filhos
+ *
+ * @param root Raiz da árvore
+ * @param onOpen Chamada ao entrar em um nó (pré-ordem)
+ * @param onClose Chamada ao sair de um nó (pós-ordem)
+ */
+template<class Open, class Close>
+inline void walkTree(const Node<StringNodeData>* root, Open onOpen, Close onClose) {
+    typedef std::list<Node<StringNodeData>*>::const_iterator ChildIter;
+    struct Frame {
+        const Node<StringNodeData>* node;
+        ChildIter next;
+        ChildIter end;
+    };
+    std::vector<Frame> stack;
+
+    onOpen(root);
+    stack.push_back({root, root->getChildren().begin(), root->getChildren().end()});
+
+    while (!stack.empty()) {
+        Frame &top = stack.back();
+        if (top.next == top.end) {
+            onClose(top.node);
+            stack.pop_back();
+            continue;
+        }
+
+        const Node<StringNodeData>* child = *top.next++;
+        onOpen(child);
+        stack.push_back({child, child->getChildren().begin(), child->getChildren().end()});
+    }
+}
+
+//------------------------------------------------------------------------------
+// Bracket String Serializer
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Escreve árvores na notação de chaves lida por BracketStringInputParser.
+ *        O tamanho exato é calculado antes, então a saída é escrita em um único
+ *        buffer sem realocações.
+ */
+class BracketStringSerializer {
+public:
+    /**
+     * @brief Calcula o número de bytes da árvore em notação de chaves
+     * @param root Raiz da árvore
+     * @return Quantidade de bytes
+     */
+    static size_t measure(const Node<StringNodeData>* root) {
+        size_t bytes = 0;
+        walkTree(root,
+            [&bytes](const Node<StringNodeData>* node) { bytes += 2 + node->getData()->getLabel().size(); },
+            [](const Node<StringNodeData>*) {});
+        return bytes;
+    }
+
+    /**
+     * @brief Escreve a árvore no buffer, que deve ter pelo menos measure(root) bytes
+     * @param root Raiz da árvore
+     * @param buffer Buffer de destino
+     * @return Quantidade de bytes escritos
+     */
+    static size_t write(const Node<StringNodeData>* root, char* buffer) {
+        char* cursor = buffer;
+        walkTree(root,
+            [&cursor](const Node<StringNodeData>* node) {
+                const std::string &label = node->getData()->getLabel();
+                *cursor++ = '{';
+                std::memcpy(cursor, label.data(), label.size());
+                cursor += label.size();
+            },
+            [&cursor](const Node<StringNodeData>*) { *cursor++ = '}'; });
+        return cursor - buffer;
+    }
+
+    /**
+     * @brief Acrescenta a árvore ao fim de out, crescendo a string uma única vez.
+     *        Reutilizar out entre registros evita alocações por árvore.
+     * @param root Raiz da árvore
+     * @param out String de destino
+     */
+    static void append(const Node<StringNodeData>* root, std::string &out) {
+        size_t start = out.size();
+        out.resize(start + measure(root));
+        write(root, &out[start]);
+    }
+
+    /**
+     * @brief Serializa a árvore em uma nova string
+     * @param root Raiz da árvore
+     * @return Árvore em notação de chaves
+     */
+    static std::string toString(const Node<StringNodeData>* root) {
+        std::string out;
+        append(root, out);
+        return out;
+    }
+};
+
+//------------------------------------------------------------------------------
+// Binary Tree Serializer
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Escreve árvores em formato binário compacto. Os nós aparecem em
+ *        pré-ordem e cada nó é codificado como:
+ *        varint(tamanho do rótulo), bytes do rótulo, varint(número de filhos),
+ *        com varints no formato LEB128 sem sinal.
+ */
+class BinaryTreeSerializer {
+public:
+    /**
+     * @brief Calcula o número de bytes de um varint
+     * @param value Valor a ser codificado
+     * @return Quantidade de bytes
+     */
+    static size_t varintSize(uint64_t value) {
+        size_t bytes = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            bytes++;
+        }
+        return bytes;
+    }
+
+    /**
+     * @brief Escreve um varint no cursor e o avança
+     * @param cursor Posição de escrita
+     * @param value Valor a ser codificado
+     */
+    static void writeVarint(char* &cursor, uint64_t value) {
+        while (value >= 0x80) {
+            *cursor++ = (char)((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        *cursor++ = (char)value;
+    }
+
+    /**
+     * @brief Calcula o número de bytes da árvore em formato binário
+     * @param root Raiz da árvore
+     * @return Quantidade de bytes
+     */
+    static size_t measure(const Node<StringNodeData>* root) {
+        size_t bytes = 0;
+        walkTree(root,
+            [&bytes](const Node<StringNodeData>* node) {
+                size_t labelSize = node->getData()->getLabel().size();
+                bytes += varintSize(labelSize) + labelSize + varintSize(node->getNumChildren());
+            },
+            [](const Node<StringNodeData>*) {});
+        return bytes;
+    }
+
+    /**
+     * @brief Escreve a árvore no buffer, que deve ter pelo menos measure(root) bytes
+     * @param root Raiz da árvore
+     * @param buffer Buffer de destino
+     * @return Quantidade de bytes escritos
+     */
+    static size_t write(const Node<StringNodeData>* root, char* buffer) {
+        char* cursor = buffer;
+        walkTree(root,
+            [&cursor](const Node<StringNodeData>* node) {
+                const std::string &label = node->getData()->getLabel();
+                writeVarint(cursor, label.size());
+                std::memcpy(cursor, label.data(), label.size());
+                cursor += label.size();
+                writeVarint(cursor, node->getNumChildren());
+            },
+            [](const Node<StringNodeData>*) {});
+        return cursor - buffer;
+    }
+
+    /**
+     * @brief Acrescenta a árvore ao fim de out, crescendo a string uma única vez
+     * @param root Raiz da árvore
+     * @param out String de destino
+     */
+    static void append(const Node<StringNodeData>* root, std::string &out) {
+        size_t start = out.size();
+        out.resize(start + measure(root));
+        write(root, &out[start]);
+    }
+};
+
+//------------------------------------------------------------------------------
+// Binary Tree Parser
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Reconstrói uma árvore escrita por BinaryTreeSerializer, sem recursão
+ */
+class BinaryTreeInputParser : public InputParser<StringNodeData> {
+private:
+    const char* data;
+    size_t length;
+    size_t position;
+
+    /**
+     * @brief Lê um varint na posição atual
+     * @param value Recebe o valor lido
+     * @return true Se o varint está completo dentro do buffer
+     */
+    bool readVarint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && position < length; shift += 7) {
+            unsigned char byte = data[position++];
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    /**
+     * @brief Construtor da classe BinaryTreeInputParser
+     * @param data Buffer com a árvore serializada
+     * @param length Tamanho do buffer
+     */
+    BinaryTreeInputParser(const char* data, size_t length) : data(data), length(length), position(0) {
+        // nop
+    }
+
+    /**
+     * @brief Obtém a quantidade de bytes consumidos pela última árvore lida.
+     *        Permite ler várias árvores gravadas em sequência no mesmo buffer.
+     * @return Posição após a árvore lida
+     */
+    size_t consumed() const {
+        return position;
+    }
+
+    /**
+     * @brief Lê a próxima árvore do buffer
+     * @return Ponteiro para a raiz da árvore, ou nullptr se o buffer está truncado ou inválido
+     */
+    virtual Node<StringNodeData>* getRoot() override {
+        Node<StringNodeData>* root = nullptr;
+        std::vector<std::pair<Node<StringNodeData>*, uint64_t>> pending;
+
+        do {
+            uint64_t labelSize, numChildren;
+            if (!readVarint(labelSize) || labelSize > length - position) {
+                delete root;
+                return nullptr;
+            }
+            std::string label(data + position, labelSize);
+            position += labelSize;
+            if (!readVarint(numChildren)) {
+                delete root;
+                return nullptr;
+            }
+
+            Node<StringNodeData>* node = new Node<StringNodeData>(new StringNodeData(std::move(label)));
+            if (root == nullptr) {
+                root = node;
+            } else {
+                pending.back().first->addChild(node);
+                pending.back().second--;
+            }
+            if (numChildren > 0) {
+                pending.emplace_back(node, numChildren);
+            }
+
+            while (!pending.empty() && pending.back().second == 0) {
+                pending.pop_back();
+            }
+        } while (!pending.empty());
+
+        return root;
+    }
+};
+
+} // namespace capted
@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * @file AdaptiveApted.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Escolha da largura dos índices do APTED em tempo de execução, de acordo
+ *        com o tamanho das árvores
+ * 
+ * @date 2024-06-22
+ * 
+ * ALgoritmo original retirado de:
+ * <p>See the source code for more algorithm-related comments.
+ *
+ * <p>References:
+ * <ul>
+ * <li>[1] M. Pawlik and N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik and N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou tradizido para melhor compreenção do grupo.
+ * 
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include "Apted.h"
+
+namespace capted {
+
+/**
+ * @brief Larguras de índice instanciadas para NodeIndexer e Apted
+ */
+enum class IndexWidth {
+    Int16,
+    Int32,
+    Int64
+};
+
+/**
+ * @brief Escolhe a menor largura de índice capaz de indexar as duas árvores
+ * 
+ * @param size1 Tamanho da árvore 1
+ * @param size2 Tamanho da árvore 2
+ * @return IndexWidth Largura escolhida
+ */
+inline IndexWidth selectIndexWidth(int64_t size1, int64_t size2) {
+    int64_t size = std::max(size1, size2);
+    if (size <= maxIndexedTreeSize<int16_t>()) {
+        return IndexWidth::Int16;
+    }
+    if (size <= maxIndexedTreeSize<int32_t>()) {
+        return IndexWidth::Int32;
+    }
+    return IndexWidth::Int64;
+}
+
+//------------------------------------------------------------------------------
+// Adaptive APTED
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Calcula a distância com Apted<Data, int16_t>, Apted<Data, int32_t> ou
+ *        Apted<Data, int64_t>, conforme o tamanho das árvores. Árvores pequenas
+ *        usam índices estreitos (mais índices por linha de cache) e árvores
+ *        grandes passam a usar índices largos em vez de transbordar.
+ * 
+ * @tparam Data Tipo dos dados armazenados nos nós da árvore
+ * @tparam Instrumentation Política de instrumentação repassada ao Apted
+ */
+template<class Data, class Instrumentation = NoInstrumentation>
+class AdaptiveApted {
+private:
+    CostModel<Data>* costModel;
+    IndexWidth lastWidth = IndexWidth::Int32;
+    InstrumentationCounts lastCounts;
+
+    template<class Index>
+    float compute(Node<Data>* t1, Node<Data>* t2) {
+        // Uma instância de Apted calcula apenas uma distância.
+        Apted<Data, Index, DenseFloatMatrix, Instrumentation> algorithm(costModel);
+        float distance = algorithm.computeEditDistance(t1, t2);
+        lastCounts = algorithm.getInstrumentation().counts();
+        return distance;
+    }
+
+public:
+    /**
+     * @brief Construtor da classe AdaptiveApted
+     * 
+     * @param costModel Modelo de custo para operações de edição de árvore
+     */
+    AdaptiveApted(CostModel<Data>* costModel) : costModel(costModel) {
+        // nop
+    }
+
+    /**
+     * @brief Calcula a distância de edição entre duas árvores, escolhendo a
+     *        largura dos índices pelo tamanho da maior delas
+     * 
+     * @param t1 Raiz da árvore 1
+     * @param t2 Raiz da árvore 2
+     * @return float Distância de edição entre as árvores
+     */
+    float computeEditDistance(Node<Data>* t1, Node<Data>* t2) {
+        lastWidth = selectIndexWidth(t1->getNodeCount(), t2->getNodeCount());
+        switch (lastWidth) {
+            case IndexWidth::Int16: return compute<int16_t>(t1, t2);
+            case IndexWidth::Int32: return compute<int32_t>(t1, t2);
+            default:                return compute<int64_t>(t1, t2);
+        }
+    }
+
+    /**
+     * @brief Obtém a largura usada no último cálculo
+     * @return IndexWidth Largura dos índices
+     */
+    IndexWidth getIndexWidth() const {
+        return lastWidth;
+    }
+
+    /**
+     * @brief Obtém os eventos contados no último cálculo (zeros com NoInstrumentation)
+     * @return const InstrumentationCounts& Eventos do último cálculo
+     */
+    const InstrumentationCounts& getInstrumentationCounts() const {
+        return lastCounts;
+    }
+};
+
+} // namespace capted
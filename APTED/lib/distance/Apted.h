@@ -29,35 +29,45 @@
  * 
  */
 
-#include "../includes/MemoryAccessTracker.hpp"
+#include <algorithm>
+#include <chrono>
 #include <vector>
-#include <stack>
+#include <limits>
 #include "TreeEditDistance.h"
 #include "../util/debug.h"
 #include "../util/int.h"
+#include "../util/FloatMatrix.h"
+#include "../util/Instrumentation.h"
 
 namespace capted {
 
 /**
  * @brief Função auxiliar para encontrar o máximo entre dois inteiros
  * 
+ * @tparam T Tipo inteiro com sinal (a largura do índice)
  * @param x Primeiro inteiro
  * @param y Segundo inteiro
- * @return int Maior valor entre x e y
+ * @return T Maior valor entre x e y
  */
-int Max(int x, int y) {
-    return x ^ ((x ^ y) & ((x - y) >> 31));
+template<typename T>
+inline T Max(T x, T y) {
+    // x - y é promovido a pelo menos int, então o deslocamento usa a largura promovida.
+    auto diff = x - y;
+    return (T)(x ^ ((x ^ y) & (diff >> (sizeof(diff) * 8 - 1))));
 }
 
 /**
  * @brief Função auxiliar para encontrar o valor absoluto de um inteiro
  * 
+ * @tparam T Tipo inteiro com sinal (a largura do índice)
  * @param x Inteiro de entrada
- * @return int Valor absoluto de x
+ * @return T Valor absoluto de x
  */
-int Abs(int x) {
-    int mask = x >> 31;
-    return (x + mask) ^ mask;
+template<typename T>
+inline T Abs(T x) {
+    auto value = +x;
+    auto mask = value >> (sizeof(value) * 8 - 1);
+    return (T)((value + mask) ^ mask);
 }
 
 /**
@@ -92,6 +102,94 @@ static inline T signum(T val) {
     }
 }
 
+//------------------------------------------------------------------------------
+// Estimativa de Memória
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Memória que um cálculo de Apted pode ocupar, em bytes, por estrutura.
+ *        Os valores são limites superiores obtidos apenas dos tamanhos das árvores.
+ */
+struct MemoryEstimate {
+    size_t indexers = 0;     /**< NodeIndexers das duas árvores, quando construídos pelo Apted */
+    size_t delta = 0;        /**< Matriz delta, viva durante todo o cálculo */
+    size_t strategyRows = 0; /**< Linhas de custo e arrays auxiliares de computeOptStrategy_* */
+    size_t spfA = 0;         /**< Matrizes s e t de spfA no pior caso */
+    size_t spfL = 0;         /**< Matriz forestdist de spfL/spfR no pior caso */
+    size_t arrays = 0;       /**< Arrays q, fn e ft de gted */
+
+    /**
+     * @brief Obtém o pico de memória: a fase de estratégia e a de distância não
+     *        coexistem, e só uma spf está ativa por vez
+     * @return size_t Quantidade de bytes
+     */
+    size_t peak() const {
+        return indexers + delta + std::max(strategyRows, arrays + std::max(spfA, spfL));
+    }
+};
+
+//------------------------------------------------------------------------------
+// Estatísticas de Fases
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Chamadas e tempo acumulado de um tipo de spf
+ */
+struct SpfStats {
+    long calls = 0;    /**< Chamadas, contadas sempre */
+    double ns = 0;     /**< Tempo total, medido só com a medição de fases ligada */
+};
+
+/**
+ * @brief Tempo de cada fase da última chamada de computeEditDistance, em ns, e
+ *        as chamadas de cada spf. O tempo de gted inclui o das spf; a diferença
+ *        é o custo da decomposição (recursão e atualização de q, fn e ft).
+ */
+struct PhaseStats {
+    double indexingNs = 0;   /**< Indexação das árvores (zero com indexadores já prontos) */
+    double strategyNs = 0;   /**< computeOptStrategy_postL ou _postR */
+    double tedInitNs = 0;    /**< tedInit */
+    double gtedNs = 0;       /**< gted, incluindo as spf */
+    SpfStats spfL;
+    SpfStats spfR;
+    SpfStats spfA;
+    SpfStats spf1;
+
+    /**
+     * @brief Obtém o tempo total das fases medidas
+     * @return double Tempo em ns
+     */
+    double totalNs() const {
+        return indexingNs + strategyNs + tedInitNs + gtedNs;
+    }
+};
+
+/**
+ * @brief Soma ao destino o tempo entre a construção e a destruição. Com destino
+ *        nulo não lê o relógio, então a medição desligada custa só um desvio.
+ */
+class PhaseTimer {
+private:
+    double* target;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit PhaseTimer(double* target) : target(target) {
+        if (target != nullptr) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if (target != nullptr) {
+            *target += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
 //------------------------------------------------------------------------------
 // Algoritmo de Distância (apted)
 //------------------------------------------------------------------------------
@@ -100,21 +198,109 @@ static inline T signum(T val) {
  * @brief Classe que implementa o algoritmo APTED para cálculo de distância de edição de árvores
  * 
  * @tparam Data Tipo dos dados armazenados nos nós da árvore
+ * @tparam Index Tipo inteiro usado pelos índices
+ * @tparam Matrix Armazenamento de delta, das linhas de custo da estratégia e
+ *         das matrizes de spf: DenseFloatMatrix (em memória) ou MappedFloatMatrix
+ *         (em arquivo, com limite de memória residente, para árvores cujo delta
+ *         não cabe na RAM)
+ * @tparam Instrumentation Política de instrumentação: NoInstrumentation (sem
+ *         custo) ou CountingInstrumentation (subproblemas, acessos a delta e
+ *         chamadas de spf do último cálculo, lidos com getInstrumentation)
  */
-template<class Data>
-class Apted : public TreeEditDistance<Data> {
+template<class Data, class Index = Integer, class Matrix = DenseFloatMatrix, class Instrumentation = NoInstrumentation>
+class Apted : public TreeEditDistance<Data, Index> {
 private:
-    static const Integer LEFT = 0;
-    static const Integer RIGHT = 1;
-    static const Integer INNER = 2;
-
-    std::vector<std::vector<float>> delta;
+    static const Index LEFT = 0;
+    static const Index RIGHT = 1;
+    static const Index INNER = 2;
+
+    // Blocos de delta com 2^8 x 2^8 posições: gted acessa retângulos de pares de subárvores.
+    static constexpr unsigned DELTA_TILE_SHIFT = 8;
+    // Blocos das linhas de custo com 1 x 2^16 posições: elas são percorridas linha a linha.
+    static constexpr unsigned COST_ROW_TILE_SHIFT = 16;
+    // Blocos das matrizes de spf com 2^8 x 2^8 posições: forestdist lê linhas distantes (lld).
+    static constexpr unsigned SPF_TILE_SHIFT = 8;
+
+    MatrixOptions matrixOptions;
+    Matrix delta;
+    // Matrizes de spf, reaproveitadas entre as chamadas: forestMatrix é s em spfA
+    // e forestdist em spfL/spfR, pathMatrix é t em spfA.
+    Matrix forestMatrix;
+    Matrix pathMatrix;
 
     std::vector<float> q;
-    std::vector<Integer> fn;
-    std::vector<Integer> ft;
+    std::vector<Index> fn;
+    std::vector<Index> ft;
     long counter = 0;
 
+    bool phaseTiming = false;
+    PhaseStats phaseStats;
+    Instrumentation instrumentation;
+
+    /**
+     * @brief Lê uma posição de delta, registrando a leitura na instrumentação
+     */
+    float deltaGet(Index row, Index col) {
+        instrumentation.deltaRead();
+        return delta.get(row, col);
+    }
+
+    /**
+     * @brief Escreve uma posição de delta, registrando a escrita na instrumentação
+     */
+    void deltaSet(Index row, Index col, float value) {
+        instrumentation.deltaWrite();
+        delta.set(row, col, value);
+    }
+
+    /**
+     * @brief Obtém o destino de um PhaseTimer: o campo dado, ou nulo com a
+     *        medição de fases desligada
+     */
+    double* timed(double &field) {
+        return phaseTiming ? &field : nullptr;
+    }
+
+    /**
+     * @brief Copia matrixOptions com outro limite de memória residente
+     */
+    MatrixOptions withResidentBytes(size_t residentBytes) const {
+        MatrixOptions options = matrixOptions;
+        options.residentBytes = residentBytes;
+        return options;
+    }
+
+    /**
+     * @brief Conta quantas linhas de custo de it1 ficam em uso ao mesmo tempo em
+     *        computeOptStrategy_postL/postR, incluindo a linha zerada das folhas.
+     *        A linha de um nó é alocada ao processar o primeiro filho e liberada
+     *        depois do próprio nó, então o pico é bem menor que o tamanho da árvore.
+     *
+     * @param postL true para a ordem de computeOptStrategy_postL, false para a de postR
+     * @return Index Quantidade de linhas
+     */
+    Index maxLiveCostRows(bool postL) const {
+        Index size1 = this->it1->getSize();
+        std::vector<uint8_t> hasRow(size1, 0);
+        Index live = 1;
+        Index peak = 1;
+
+        for (Index k = 0; k < size1; k++) {
+            Index v = postL ? this->it1->postL_to_preL[k] : size1 - 1 - k;
+            Index parent = this->it1->parents[v];
+            if (parent != -1 && !hasRow[parent]) {
+                hasRow[parent] = 1;
+                live++;
+                peak = Max(peak, live);
+            }
+            if (!this->it1->isLeaf(v)) {
+                live--;
+            }
+        }
+
+        return peak;
+    }
+
     /**
      * @brief Atualiza o array fn para o nó atual
      * 
@@ -122,7 +308,7 @@ private:
      * @param node Índice do nó atual
      * @param currentSubtreePreL Índice do nó da subárvore atual
      */
-    void updateFnArray(Integer lnForNode, Integer node, Integer currentSubtreePreL) {
+    void updateFnArray(Index lnForNode, Index node, Index currentSubtreePreL) {
         if (lnForNode >= currentSubtreePreL) {
             fn[node] = fn[lnForNode];
             fn[lnForNode] = node;
@@ -138,7 +324,7 @@ private:
      * @param lnForNode Índice do nó ft
      * @param node Índice do nó atual
      */
-    void updateFtArray(Integer lnForNode, Integer node) {
+    void updateFtArray(Index lnForNode, Index node) {
         ft[node] = lnForNode;
         if(fn[node] > -1) {
             ft[fn[node]] = node;
@@ -153,13 +339,13 @@ private:
      * @param it Iterador de nós
      * @param currentRootNodePreL Índice do nó raiz atual
      * @param currentSubtreeSize Tamanho da subárvore atual
-     * @return Integer Tipo do caminho da estratégia
+     * @return Index Tipo do caminho da estratégia
      */
-    Integer getStrategyPathType(Integer pathIDWithPathIDOffset, Integer pathIDOffset, NodeIndexer<Data>* it, Integer currentRootNodePreL, Integer currentSubtreeSize) {
+    Index getStrategyPathType(Index pathIDWithPathIDOffset, Index pathIDOffset, const NodeIndexer<Data, Index>* it, Index currentRootNodePreL, Index currentSubtreeSize) {
         if (signum(pathIDWithPathIDOffset) == -1) {
             return LEFT;
         }
-        Integer pathID = Abs(pathIDWithPathIDOffset) - 1;
+        Index pathID = Abs(pathIDWithPathIDOffset) - 1;
         if (pathID >= pathIDOffset) {
             pathID = pathID - pathIDOffset;
         }
@@ -176,45 +362,45 @@ private:
      * 
      * @param it1 Iterador de nós da árvore 1
      * @param it2 Iterador de nós da árvore 2
+     * @param currentSubtreePreL1 Raiz (pré-ordem) da subárvore atual da árvore 1
+     * @param currentSubtreePreL2 Raiz (pré-ordem) da subárvore atual da árvore 2
      * @param pathID ID do caminho
      * @param pathType Tipo do caminho
      * @param treesSwapped Flag indicando se as árvores foram trocadas
      * @return float Distância de edição entre as subárvores
      */
-    float spfA(NodeIndexer<Data>* it1, NodeIndexer<Data>* it2, Integer pathID, Integer pathType, bool treesSwapped) {
-        std::vector<Node<Data>*> &it2nodes = it2->preL_to_node;
+    float spfA(const NodeIndexer<Data, Index>* it1, const NodeIndexer<Data, Index>* it2, Index currentSubtreePreL1, Index currentSubtreePreL2, Index pathID, Index pathType, bool treesSwapped) {
+        phaseStats.spfA.calls++;
+        instrumentation.spfCall();
+        PhaseTimer timer(timed(phaseStats.spfA.ns));
+
+        auto &it2nodes = it2->preL_to_node;
         Node<Data>* lFNode;
-        std::vector<Integer> &it1sizes = it1->sizes;
-        std::vector<Integer> &it2sizes = it2->sizes;
-        std::vector<Integer> &it1parents = it1->parents;
-        std::vector<Integer> &it2parents = it2->parents;
-        std::vector<Integer> &it1preL_to_preR = it1->preL_to_preR;
-        std::vector<Integer> &it2preL_to_preR = it2->preL_to_preR;
-        std::vector<Integer> &it1preR_to_preL = it1->preR_to_preL;
-        std::vector<Integer> &it2preR_to_preL = it2->preR_to_preL;
-        Integer currentSubtreePreL1 = it1->getCurrentNode();
-        Integer currentSubtreePreL2 = it2->getCurrentNode();
+        auto &it1sizes = it1->sizes;
+        auto &it2sizes = it2->sizes;
+        auto &it1parents = it1->parents;
+        auto &it2parents = it2->parents;
+        auto &it1preL_to_preR = it1->preL_to_preR;
+        auto &it2preL_to_preR = it2->preL_to_preR;
+        auto &it1preR_to_preL = it1->preR_to_preL;
+        auto &it2preR_to_preL = it2->preR_to_preL;
 
         // Variables to incrementally sum up the forest sizes.
-        Integer currentForestSize1 = 0;
-        Integer currentForestSize2 = 0;
-        Integer tmpForestSize1 = 0;
+        Index currentForestSize1 = 0;
+        Index currentForestSize2 = 0;
+        Index tmpForestSize1 = 0;
 
         // Variables to incrementally sum up the forest cost.
         float currentForestCost1 = 0;
         float currentForestCost2 = 0;
         float tmpForestCost1 = 0;
 
-        Integer subtreeSize2 = it2->sizes[currentSubtreePreL2];
-        Integer subtreeSize1 = it1->sizes[currentSubtreePreL1];
-        std::vector<std::vector<float>> t(subtreeSize2 + 1);
-        for (size_t i = 0; i < t.size(); i++) {
-            t[i].resize(subtreeSize2 + 1);
-        }
-        std::vector<std::vector<float>> s(subtreeSize1 + 1);
-        for (size_t i = 0; i < s.size(); i++) {
-            s[i].resize(subtreeSize2 + 1);
-        }
+        Index subtreeSize2 = it2->sizes[currentSubtreePreL2];
+        Index subtreeSize1 = it1->sizes[currentSubtreePreL1];
+        Matrix &t = pathMatrix;
+        t.resize(subtreeSize2 + 1, subtreeSize2 + 1);
+        Matrix &s = forestMatrix;
+        s.resize(subtreeSize1 + 1, subtreeSize2 + 1);
 
         float minCost = -1;
 
@@ -223,31 +409,26 @@ private:
         float sp1 = 0;
         float sp2 = 0;
         float sp3 = 0;
-        Integer startPathNode = -1;
-        Integer endPathNode = pathID;
-        Integer it1PreLoff = endPathNode;
-        Integer it2PreLoff = currentSubtreePreL2;
-        Integer it1PreRoff = it1preL_to_preR[endPathNode];
-        Integer it2PreRoff = it2preL_to_preR[it2PreLoff];
+        Index startPathNode = -1;
+        Index endPathNode = pathID;
+        Index it1PreLoff = endPathNode;
+        Index it2PreLoff = currentSubtreePreL2;
+        Index it1PreRoff = it1preL_to_preR[endPathNode];
+        Index it2PreRoff = it2preL_to_preR[it2PreLoff];
         // variable declarations which were inside the loops
-        Integer rFlast,lFlast,endPathNode_in_preR,startPathNode_in_preR,parent_of_endPathNode,parent_of_endPathNode_in_preR,
+        Index rFlast,lFlast,endPathNode_in_preR,startPathNode_in_preR,parent_of_endPathNode,parent_of_endPathNode_in_preR,
         lFfirst,rFfirst,rGlast,rGfirst,lGfirst,rG_in_preL,rGminus1_in_preL,parent_of_rG_in_preL,lGlast,lF_in_preR,lFSubtreeSize,
         lGminus1_in_preR,parent_of_lG,parent_of_lG_in_preR,rF_in_preL,rFSubtreeSize,
         rGfirst_in_preL;
 
         bool leftPart,rightPart,fForestIsTree,lFIsConsecutiveNodeOfCurrentPathNode,lFIsLeftSiblingOfCurrentPathNode,
         rFIsConsecutiveNodeOfCurrentPathNode,rFIsRightSiblingOfCurrentPathNode;
-        std::vector<float>* sp1spointer;
-        std::vector<float>* sp2spointer;
-        std::vector<float>* sp3spointer;
-        std::vector<float>* sp3deltapointer;
-        std::vector<float>* swritepointer;
-        std::vector<float>* sp1tpointer;
-        std::vector<float>* sp3tpointer;
+        // Linhas de s e t lidas e escrita pela fórmula recursiva.
+        Index sp1srow, sp2srow, sp3srow, swriterow, sp1trow, sp3trow;
 
         // These variables store the id of the source (which array) of looking up
         // elements of the minimum in the recursive formula [1, Figures 12,13].
-        Integer sp1source,sp3source;
+        Index sp1source,sp3source;
 
         // Loop A [1, Algorithm 3] - walk up the path.
         while (endPathNode >= currentSubtreePreL1) {
@@ -256,9 +437,9 @@ private:
             rFlast = -1;
             lFlast = -1;
             endPathNode_in_preR = it1preL_to_preR[endPathNode];
-            startPathNode_in_preR = startPathNode == -1 ? 0x7fffffff : it1preL_to_preR[startPathNode];
+            startPathNode_in_preR = startPathNode == -1 ? std::numeric_limits<Index>::max() : it1preL_to_preR[startPathNode];
             parent_of_endPathNode = it1parents[endPathNode];
-            parent_of_endPathNode_in_preR = parent_of_endPathNode == -1 ? 0x7fffffff : it1preL_to_preR[parent_of_endPathNode];
+            parent_of_endPathNode_in_preR = parent_of_endPathNode == -1 ? std::numeric_limits<Index>::max() : it1preL_to_preR[parent_of_endPathNode];
 
             if (startPathNode - endPathNode > 1) {
                 leftPart = true;
@@ -291,7 +472,7 @@ private:
                 lFlast = rightPart ? endPathNode + 1 : endPathNode;
                 fn[fn.size() - 1] = -1;
 
-                for (Integer i = currentSubtreePreL2; i < currentSubtreePreL2 + subtreeSize2; i++) {
+                for (Index i = currentSubtreePreL2; i < currentSubtreePreL2 + subtreeSize2; i++) {
                     fn[i] = -1;
                     ft[i] = -1;
                 }
@@ -301,10 +482,10 @@ private:
                 tmpForestCost1 = currentForestCost1;
 
                 // Loop B [1, Algoritm 3] - for all nodes in G (right-hand input tree).
-                for (Integer rG = rGfirst; rG >= rGlast; rG--) {
+                for (Index rG = rGfirst; rG >= rGlast; rG--) {
                     lGfirst = it2preR_to_preL[rG];
                     rG_in_preL = it2preR_to_preL[rG];
-                    rGminus1_in_preL = rG <= it2preL_to_preR[currentSubtreePreL2] ? 0x7fffffff : it2preR_to_preL[rG - 1];
+                    rGminus1_in_preL = rG <= it2preL_to_preR[currentSubtreePreL2] ? std::numeric_limits<Index>::max() : it2preR_to_preL[rG - 1];
                     parent_of_rG_in_preL = it2parents[rG_in_preL];
                     // This if statement decides on the last lG node for Loop D [1, Algorithm 3];
                     if (pathType == 1) {
@@ -319,14 +500,14 @@ private:
 
                     updateFnArray(it2->preL_to_ln[lGfirst], lGfirst, currentSubtreePreL2);
                     updateFtArray(it2->preL_to_ln[lGfirst], lGfirst);
-                    Integer rF = rFfirst;
+                    Index rF = rFfirst;
 
                     // Reset size and cost of the forest in F.
                     currentForestSize1 = tmpForestSize1;
                     currentForestCost1 = tmpForestCost1;
 
                     // Loop C [1, Algorithm 3] - for all nodes to the left of the path node.
-                    for (Integer lF = lFfirst; lF >= lFlast; lF--) {
+                    for (Index lF = lFfirst; lF >= lFlast; lF--) {
                         // This if statement fixes rF node.
                         if (lF == lFlast && !rightPart) {
                             rF = rFlast;
@@ -344,11 +525,10 @@ private:
                         lFSubtreeSize = it1sizes[lF];
                         lFIsConsecutiveNodeOfCurrentPathNode = startPathNode - lF == 1;
                         lFIsLeftSiblingOfCurrentPathNode = lF + lFSubtreeSize == startPathNode;
-                        sp1spointer = &(s[(lF + 1) - it1PreLoff]);
-                        sp2spointer = &(s[lF - it1PreLoff]);
-                        sp3spointer = &(s[0]);
-                        sp3deltapointer = treesSwapped ? nullptr : &(delta[lF]);
-                        swritepointer = &(s[lF - it1PreLoff]);
+                        sp1srow = (lF + 1) - it1PreLoff;
+                        sp2srow = lF - it1PreLoff;
+                        sp3srow = 0;
+                        swriterow = lF - it1PreLoff;
                         sp1source = 1; // Search sp1 value in s array by default.
                         sp3source = 1; // Search second part of sp3 value in s array by default.
 
@@ -373,18 +553,18 @@ private:
                         }
 
                         if (sp3source == 1) {
-                            sp3spointer = &(s[(lF + lFSubtreeSize) - it1PreLoff]);
+                            sp3srow = (lF + lFSubtreeSize) - it1PreLoff;
                         }
 
                         // Go to first lG.
-                        Integer lG = lGfirst;
+                        Index lG = lGfirst;
 
                         // currentForestSize2++;
                         // sp1, sp2, sp3 -- Done here for the first node in Loop D. It differs for consecutive nodes.
                         // sp1 -- START
                         switch(sp1source) {
-                            case 1: sp1 = (*sp1spointer)[lG - it2PreLoff]; break;
-                            case 2: sp1 = t[lG - it2PreLoff][rG - it2PreRoff]; break;
+                            case 1: sp1 = s.get(sp1srow, lG - it2PreLoff); break;
+                            case 2: sp1 = t.get(lG - it2PreLoff, rG - it2PreRoff); break;
                             case 3: sp1 = currentForestCost2; break; // USE COST MODEL - Insert G_{lG,rG}.
                         }
                         sp1 += (treesSwapped ? this->costModel->insertCost(lFNode) : this->costModel->deleteCost(lFNode));// USE COST MODEL - Delete lF, leftmost root node in F_{lF,rF}.
@@ -405,7 +585,7 @@ private:
 
                         // sp3 -- START
                         if (sp3 < minCost) {
-                            sp3 += treesSwapped ? delta[lG][lF] : (*sp3deltapointer)[lG];
+                            sp3 += treesSwapped ? deltaGet(lG, lF) : deltaGet(lF, lG);
                             if (sp3 < minCost) {
                                 sp3 += (treesSwapped ? this->costModel->renameCost(it2nodes[lG], lFNode) : this->costModel->renameCost(lFNode, it2nodes[lG])); // USE COST MODEL - Rename the leftmost root nodes in F_{lF,rF} and G_{lG,rG}.
                                 if(sp3 < minCost) {
@@ -415,7 +595,7 @@ private:
                         }
                         // sp3 -- END
 
-                        (*swritepointer)[lG - it2PreLoff] = minCost;
+                        s.set(swriterow, lG - it2PreLoff, minCost);
 
                         // Go to next lG.
                         lG = ft[lG];
@@ -427,23 +607,23 @@ private:
                             currentForestSize2++;
                             currentForestCost2 += (treesSwapped ? this->costModel->deleteCost(it2nodes[lG]) : this->costModel->insertCost(it2nodes[lG]));
                             switch(sp1source) {
-                                case 1: sp1 = (*sp1spointer)[lG - it2PreLoff] + (treesSwapped ? this->costModel->insertCost(lFNode) : this->costModel->deleteCost(lFNode)); break; // USE COST MODEL - Delete lF, leftmost root node in F_{lF,rF}.
-                                case 2: sp1 = t[lG - it2PreLoff][rG - it2PreRoff] + (treesSwapped ? this->costModel->insertCost(lFNode) : this->costModel->deleteCost(lFNode)); break; // USE COST MODEL - Delete lF, leftmost root node in F_{lF,rF}.
+                                case 1: sp1 = s.get(sp1srow, lG - it2PreLoff) + (treesSwapped ? this->costModel->insertCost(lFNode) : this->costModel->deleteCost(lFNode)); break; // USE COST MODEL - Delete lF, leftmost root node in F_{lF,rF}.
+                                case 2: sp1 = t.get(lG - it2PreLoff, rG - it2PreRoff) + (treesSwapped ? this->costModel->insertCost(lFNode) : this->costModel->deleteCost(lFNode)); break; // USE COST MODEL - Delete lF, leftmost root node in F_{lF,rF}.
                                 case 3: sp1 = currentForestCost2 + (treesSwapped ? this->costModel->insertCost(lFNode) : this->costModel->deleteCost(lFNode)); break; // USE COST MODEL - Insert G_{lG,rG} and elete lF, leftmost root node in F_{lF,rF}.
                             }
 
-                            sp2 = (*sp2spointer)[fn[lG] - it2PreLoff] + (treesSwapped ? this->costModel->deleteCost(it2nodes[lG]) : this->costModel->insertCost(it2nodes[lG])); // USE COST MODEL - Insert lG, leftmost root node in G_{lG,rG}.
+                            sp2 = s.get(sp2srow, fn[lG] - it2PreLoff) + (treesSwapped ? this->costModel->deleteCost(it2nodes[lG]) : this->costModel->insertCost(it2nodes[lG])); // USE COST MODEL - Insert lG, leftmost root node in G_{lG,rG}.
                             minCost = sp1;
                             if(sp2 < minCost) {
                                 minCost = sp2;
                             }
 
-                            sp3 = treesSwapped ? delta[lG][lF] : (*sp3deltapointer)[lG];
+                            sp3 = treesSwapped ? deltaGet(lG, lF) : deltaGet(lF, lG);
                             if (sp3 < minCost) {
                                 switch(sp3source) {
-                                    case 1: sp3 += (*sp3spointer)[fn[(lG + it2sizes[lG]) - 1] - it2PreLoff]; break;
+                                    case 1: sp3 += s.get(sp3srow, fn[(lG + it2sizes[lG]) - 1] - it2PreLoff); break;
                                     case 2: sp3 += currentForestCost2 - (treesSwapped ? it2->preL_to_sumDelCost[lG] : it2->preL_to_sumInsCost[lG]); break; // USE COST MODEL - Insert G_{lG,rG}-G_lG.
-                                    case 3: sp3 += t[fn[(lG + it2sizes[lG]) - 1] - it2PreLoff][rG - it2PreRoff]; break;
+                                    case 3: sp3 += t.get(fn[(lG + it2sizes[lG]) - 1] - it2PreLoff, rG - it2PreRoff); break;
                                 }
 
                                 if (sp3 < minCost) {
@@ -453,7 +633,7 @@ private:
                                     }
                                 }
                             }
-                            (*swritepointer)[lG - it2PreLoff] = minCost;
+                            s.set(swriterow, lG - it2PreLoff, minCost);
                             lG = ft[lG];
                             counter++;
                         }
@@ -463,33 +643,29 @@ private:
                         if (!rightPart) {
                             if (leftPart) {
                                 if (treesSwapped) {
-                                    delta[parent_of_rG_in_preL][endPathNode] = s[(lFlast + 1) - it1PreLoff][(rGminus1_in_preL + 1) - it2PreLoff];
-                                    MAT.increment();
+                                    deltaSet(parent_of_rG_in_preL, endPathNode, s.get((lFlast + 1) - it1PreLoff, (rGminus1_in_preL + 1) - it2PreLoff));
                                 } else {
-                                    delta[endPathNode][parent_of_rG_in_preL] = s[(lFlast + 1) - it1PreLoff][(rGminus1_in_preL + 1) - it2PreLoff];
-                                    MAT.increment();
+                                    deltaSet(endPathNode, parent_of_rG_in_preL, s.get((lFlast + 1) - it1PreLoff, (rGminus1_in_preL + 1) - it2PreLoff));
                                     
                                 }
                             }
                             if (endPathNode > 0 && endPathNode == parent_of_endPathNode + 1 && endPathNode_in_preR == parent_of_endPathNode_in_preR + 1) {
                                 if (treesSwapped) {
-                                    delta[parent_of_rG_in_preL][parent_of_endPathNode] = s[lFlast - it1PreLoff][(rGminus1_in_preL + 1) - it2PreLoff];
-                                    MAT.increment();
+                                    deltaSet(parent_of_rG_in_preL, parent_of_endPathNode, s.get(lFlast - it1PreLoff, (rGminus1_in_preL + 1) - it2PreLoff));
                                 } else {
-                                    delta[parent_of_endPathNode][parent_of_rG_in_preL] = s[lFlast - it1PreLoff][(rGminus1_in_preL + 1) - it2PreLoff];
-                                    MAT.increment();
+                                    deltaSet(parent_of_endPathNode, parent_of_rG_in_preL, s.get(lFlast - it1PreLoff, (rGminus1_in_preL + 1) - it2PreLoff));
                                 }
                             }
                         }
 
-                        for (Integer lF = lFfirst; lF >= lFlast; lF--) {
-                            q[lF] = s[lF - it1PreLoff][(parent_of_rG_in_preL + 1) - it2PreLoff];
+                        for (Index lF = lFfirst; lF >= lFlast; lF--) {
+                            q[lF] = s.get(lF - it1PreLoff, (parent_of_rG_in_preL + 1) - it2PreLoff);
                         }
                     }
 
                     // TODO: first pointers can be precomputed
-                    for (Integer lG = lGfirst; lG >= lGlast; lG = ft[lG]) {
-                        t[lG - it2PreLoff][rG - it2PreRoff] = s[lFlast - it1PreLoff][lG - it2PreLoff];
+                    for (Index lG = lGfirst; lG >= lGlast; lG = ft[lG]) {
+                        t.set(lG - it2PreLoff, rG - it2PreRoff, s.get(lFlast - it1PreLoff, lG - it2PreLoff));
                     }
                 }
             }
@@ -510,7 +686,7 @@ private:
                 rFlast = it1preL_to_preR[endPathNode];
                 fn[fn.size() - 1] = -1;
 
-                for (Integer i = currentSubtreePreL2; i < currentSubtreePreL2 + subtreeSize2; i++){
+                for (Index i = currentSubtreePreL2; i < currentSubtreePreL2 + subtreeSize2; i++){
                     fn[i] = -1;
                     ft[i] = -1;
                 }
@@ -520,12 +696,12 @@ private:
                 tmpForestCost1 = currentForestCost1;
 
                 // Loop B' [1, Algorithm 3] - for all nodes in G.
-                for (Integer lG = lGfirst; lG >= lGlast; lG--) {
+                for (Index lG = lGfirst; lG >= lGlast; lG--) {
                     rGfirst = it2preL_to_preR[lG];
                     updateFnArray(it2->preR_to_ln[rGfirst], rGfirst, it2preL_to_preR[currentSubtreePreL2]);
                     updateFtArray(it2->preR_to_ln[rGfirst], rGfirst);
-                    Integer lF = lFfirst;
-                    lGminus1_in_preR = lG <= currentSubtreePreL2 ? 0x7fffffff : it2preL_to_preR[lG - 1];
+                    Index lF = lFfirst;
+                    lGminus1_in_preR = lG <= currentSubtreePreL2 ? std::numeric_limits<Index>::max() : it2preL_to_preR[lG - 1];
                     parent_of_lG = it2parents[lG];
                     parent_of_lG_in_preR = parent_of_lG == -1 ? -1 : it2preL_to_preR[parent_of_lG];
 
@@ -546,7 +722,7 @@ private:
                     }
 
                     // Loop C' [1, Algorithm 3] - for all nodes to the right of the path node.
-                    for (Integer rF = rFfirst; rF >= rFlast; rF--) {
+                    for (Index rF = rFfirst; rF >= rFlast; rF--) {
                         if (rF == rFlast) {
                             lF = lFlast;
                         }
@@ -571,13 +747,12 @@ private:
 
                         fForestIsTree = rF_in_preL == lF;
                         Node<Data>* rFNode = it1->preL_to_node[rF_in_preL];
-                        sp1spointer = &(s[(rF + 1) - it1PreRoff]);
-                        sp2spointer = &(s[rF - it1PreRoff]);
-                        sp3spointer = &(s[0]);
-                        sp3deltapointer = treesSwapped ? nullptr : &(delta[rF_in_preL]);
-                        swritepointer = &(s[rF - it1PreRoff]);
-                        sp1tpointer = &(t[lG - it2PreLoff]);
-                        sp3tpointer = &(t[lG - it2PreLoff]);
+                        sp1srow = (rF + 1) - it1PreRoff;
+                        sp2srow = rF - it1PreRoff;
+                        sp3srow = 0;
+                        swriterow = rF - it1PreRoff;
+                        sp1trow = lG - it2PreLoff;
+                        sp3trow = lG - it2PreLoff;
                         sp1source = 1;
                         sp3source = 1;
 
@@ -600,7 +775,7 @@ private:
                         }
 
                         if (sp3source == 1) {
-                            sp3spointer = &(s[(rF + rFSubtreeSize) - it1PreRoff]);
+                            sp3srow = (rF + rFSubtreeSize) - it1PreRoff;
                         }
 
                         if (currentForestSize2 == 1) {
@@ -609,13 +784,13 @@ private:
                             sp2 = q[rF];
                         }
 
-                        Integer rG = rGfirst;
+                        Index rG = rGfirst;
                         rGfirst_in_preL = it2preR_to_preL[rGfirst];
                         currentForestSize2++;
 
                         switch (sp1source) {
-                            case 1: sp1 = (*sp1spointer)[rG - it2PreRoff]; break;
-                            case 2: sp1 = (*sp1tpointer)[rG - it2PreRoff]; break;
+                            case 1: sp1 = s.get(sp1srow, rG - it2PreRoff); break;
+                            case 2: sp1 = t.get(sp1trow, rG - it2PreRoff); break;
                             case 3: sp1 = currentForestCost2; break; // USE COST MODEL - Insert G_{lG,rG}.
                         }
 
@@ -628,7 +803,7 @@ private:
                         }
 
                         if (sp3 < minCost) {
-                            sp3 += treesSwapped ? delta[rGfirst_in_preL][rF_in_preL] : (*sp3deltapointer)[rGfirst_in_preL];
+                            sp3 += treesSwapped ? deltaGet(rGfirst_in_preL, rF_in_preL) : deltaGet(rF_in_preL, rGfirst_in_preL);
                             if (sp3 < minCost) {
                                 sp3 += (treesSwapped ? this->costModel->renameCost(it2nodes[rGfirst_in_preL], rFNode) : this->costModel->renameCost(rFNode, it2nodes[rGfirst_in_preL]));
                                 if (sp3 < minCost) {
@@ -637,7 +812,7 @@ private:
                             }
                         }
 
-                        (*swritepointer)[rG - it2PreRoff] = minCost;
+                        s.set(swriterow, rG - it2PreRoff, minCost);
                         rG = ft[rG];
                         counter++;
 
@@ -648,21 +823,21 @@ private:
                             currentForestSize2++;
                             currentForestCost2 += (treesSwapped ? this->costModel->deleteCost(it2nodes[rG_in_preL]) : this->costModel->insertCost(it2nodes[rG_in_preL]));
                             switch (sp1source) {
-                                case 1: sp1 = (*sp1spointer)[rG - it2PreRoff] + (treesSwapped ? this->costModel->insertCost(rFNode) : this->costModel->deleteCost(rFNode)); break; // USE COST MODEL - Delete rF.
-                                case 2: sp1 = (*sp1tpointer)[rG - it2PreRoff] + (treesSwapped ? this->costModel->insertCost(rFNode) : this->costModel->deleteCost(rFNode)); break; // USE COST MODEL - Delete rF.
+                                case 1: sp1 = s.get(sp1srow, rG - it2PreRoff) + (treesSwapped ? this->costModel->insertCost(rFNode) : this->costModel->deleteCost(rFNode)); break; // USE COST MODEL - Delete rF.
+                                case 2: sp1 = t.get(sp1trow, rG - it2PreRoff) + (treesSwapped ? this->costModel->insertCost(rFNode) : this->costModel->deleteCost(rFNode)); break; // USE COST MODEL - Delete rF.
                                 case 3: sp1 = currentForestCost2 + (treesSwapped ? this->costModel->insertCost(rFNode) : this->costModel->deleteCost(rFNode)); break; // USE COST MODEL - Insert G_{lG,rG} and delete rF.
                             }
-                            sp2 = (*sp2spointer)[fn[rG] - it2PreRoff] + (treesSwapped ? this->costModel->deleteCost(it2nodes[rG_in_preL]) : this->costModel->insertCost(it2nodes[rG_in_preL])); // USE COST MODEL - Insert rG.
+                            sp2 = s.get(sp2srow, fn[rG] - it2PreRoff) + (treesSwapped ? this->costModel->deleteCost(it2nodes[rG_in_preL]) : this->costModel->insertCost(it2nodes[rG_in_preL])); // USE COST MODEL - Insert rG.
                             minCost = sp1;
                             if (sp2 < minCost) {
                                 minCost = sp2;
                             }
-                            sp3 = treesSwapped ? delta[rG_in_preL][rF_in_preL] : (*sp3deltapointer)[rG_in_preL];
+                            sp3 = treesSwapped ? deltaGet(rG_in_preL, rF_in_preL) : deltaGet(rF_in_preL, rG_in_preL);
                             if (sp3 < minCost) {
                                 switch (sp3source) {
-                                    case 1: sp3 += (*sp3spointer)[fn[(rG + it2sizes[rG_in_preL]) - 1] - it2PreRoff]; break;
+                                    case 1: sp3 += s.get(sp3srow, fn[(rG + it2sizes[rG_in_preL]) - 1] - it2PreRoff); break;
                                     case 2: sp3 += currentForestCost2 - (treesSwapped ? it2->preL_to_sumDelCost[rG_in_preL] : it2->preL_to_sumInsCost[rG_in_preL]); break; // USE COST MODEL - Insert G_{lG,rG}-G_rG.
-                                    case 3: sp3 += (*sp3tpointer)[fn[(rG + it2sizes[rG_in_preL]) - 1] - it2PreRoff]; break;
+                                    case 3: sp3 += t.get(sp3trow, fn[(rG + it2sizes[rG_in_preL]) - 1] - it2PreRoff); break;
                                 }
                                 if (sp3 < minCost) {
                                     sp3 += (treesSwapped ? this->costModel->renameCost(it2nodes[rG_in_preL], rFNode) : this->costModel->renameCost(rFNode, it2nodes[rG_in_preL])); // USE COST MODEL - Rename rF to rG.
@@ -671,7 +846,7 @@ private:
                                     }
                                 }
                             }
-                            (*swritepointer)[rG - it2PreRoff] = minCost;
+                            s.set(swriterow, rG - it2PreRoff, minCost);
                             rG = ft[rG];
                             counter++;
                         }
@@ -680,32 +855,28 @@ private:
                     if (lG > currentSubtreePreL2 && lG - 1 == parent_of_lG) {
                         if (rightPart) {
                             if (treesSwapped) {
-                                delta[parent_of_lG][endPathNode] = s[(rFlast + 1) - it1PreRoff][(lGminus1_in_preR + 1) - it2PreRoff];
-                                MAT.increment();
+                                deltaSet(parent_of_lG, endPathNode, s.get((rFlast + 1) - it1PreRoff, (lGminus1_in_preR + 1) - it2PreRoff));
                             } else {
-                                delta[endPathNode][parent_of_lG] = s[(rFlast + 1) - it1PreRoff][(lGminus1_in_preR + 1) - it2PreRoff];
-                                MAT.increment();
+                                deltaSet(endPathNode, parent_of_lG, s.get((rFlast + 1) - it1PreRoff, (lGminus1_in_preR + 1) - it2PreRoff));
                             }
                         }
 
                         if (endPathNode > 0 && endPathNode == parent_of_endPathNode + 1 && endPathNode_in_preR == parent_of_endPathNode_in_preR + 1) {
                             if (treesSwapped) {
-                                delta[parent_of_lG][parent_of_endPathNode] = s[rFlast - it1PreRoff][(lGminus1_in_preR + 1) - it2PreRoff];
-                                MAT.increment();
+                                deltaSet(parent_of_lG, parent_of_endPathNode, s.get(rFlast - it1PreRoff, (lGminus1_in_preR + 1) - it2PreRoff));
                             } else {
-                                delta[parent_of_endPathNode][parent_of_lG] = s[rFlast - it1PreRoff][(lGminus1_in_preR + 1) - it2PreRoff];
-                                MAT.increment();
+                                deltaSet(parent_of_endPathNode, parent_of_lG, s.get(rFlast - it1PreRoff, (lGminus1_in_preR + 1) - it2PreRoff));
                             }
                         }
 
-                        for (Integer rF = rFfirst; rF >= rFlast; rF--) {
-                            q[rF] = s[rF - it1PreRoff][(parent_of_lG_in_preR + 1) - it2PreRoff];
+                        for (Index rF = rFfirst; rF >= rFlast; rF--) {
+                            q[rF] = s.get(rF - it1PreRoff, (parent_of_lG_in_preR + 1) - it2PreRoff);
                         }
                     }
 
                     // TODO: first pointers can be precomputed
-                    for (Integer rG = rGfirst; rG >= rGlast; rG = ft[rG]) {
-                        t[lG - it2PreLoff][rG - it2PreRoff] = s[rFlast - it1PreRoff][rG - it2PreRoff];
+                    for (Index rG = rGfirst; rG >= rGlast; rG = ft[rG]) {
+                        t.set(lG - it2PreLoff, rG - it2PreRoff, s.get(rFlast - it1PreRoff, rG - it2PreRoff));
                     }
                 }
             }
@@ -724,37 +895,41 @@ private:
      * 
      * @param it1 Iterador de nós da árvore 1
      * @param it2 Iterador de nós da árvore 2
+     * @param currentSubtree1 Raiz (pré-ordem) da subárvore atual da árvore 1
+     * @param currentSubtree2 Raiz (pré-ordem) da subárvore atual da árvore 2
      * @param treesSwapped Flag indicando se as árvores foram trocadas
      * @return float Distância de edição entre as subárvores
      */
-    float spfL(NodeIndexer<Data>* it1, NodeIndexer<Data>* it2, bool treesSwapped) {
+    float spfL(const NodeIndexer<Data, Index>* it1, const NodeIndexer<Data, Index>* it2, Index currentSubtree1, Index currentSubtree2, bool treesSwapped) {
+        phaseStats.spfL.calls++;
+        instrumentation.spfCall();
+        PhaseTimer timer(timed(phaseStats.spfL.ns));
+
         // Inicializa o array para armazenar os nós raiz-chave na subárvore de entrada da direita.
-        std::vector<Integer> keyRoots(it2->sizes[it2->getCurrentNode()], -1);
+        std::vector<Index> keyRoots(it2->sizes[currentSubtree2], -1);
 
         // Obtém o nó folha mais à esquerda da subárvore de entrada da direita.
-        Integer pathID = it2->preL_to_lld(it2->getCurrentNode());
+        Index pathID = it2->preL_to_lld(currentSubtree2);
 
         // Calcula os nós raiz-chave na subárvore de entrada da direita.
         // firstKeyRoot é o índice em keyRoots do primeiro nó raiz-chave que
         // precisamos processar. Precisamos desse índice porque o array keyRoots é maior
         // do que o número de nós raiz-chave.
-        Integer firstKeyRoot = computeKeyRoots(it2, it2->getCurrentNode(), pathID, keyRoots, 0);
+        Index firstKeyRoot = computeKeyRoots(it2, currentSubtree2, pathID, keyRoots, 0);
 
         // Inicializa um array para armazenar distâncias intermediárias para pares de subflorestas.
-        std::vector<std::vector<float>> forestdist(it1->sizes[it1->getCurrentNode()] + 1);
-        for (size_t i = 0; i < forestdist.size(); i++) {
-            forestdist[i].resize(it2->sizes[it2->getCurrentNode()] + 1);
-        }
+        Matrix &forestdist = forestMatrix;
+        forestdist.resize(it1->sizes[currentSubtree1] + 1, it2->sizes[currentSubtree2] + 1);
 
         // Calcula as distâncias entre pares de nós raiz-chave. Na subárvore de
         // entrada da esquerda, apenas a raiz é o nó raiz-chave. Assim, calculamos a distância
         // entre a subárvore de entrada da esquerda e todos os nós raiz-chave na
         // subárvore de entrada da direita.
-        for (Integer i = firstKeyRoot-1; i >= 0; i--) {
-            treeEditDist(it1, it2, it1->getCurrentNode(), keyRoots[i], forestdist, treesSwapped);
+        for (Index i = firstKeyRoot-1; i >= 0; i--) {
+            treeEditDist(it1, it2, currentSubtree1, keyRoots[i], forestdist, treesSwapped);
         }
 
-        return forestdist[it1->sizes[it1->getCurrentNode()]][it2->sizes[it2->getCurrentNode()]];
+        return forestdist.get(it1->sizes[currentSubtree1], it2->sizes[currentSubtree2]);
     }
 
     /**
@@ -765,9 +940,9 @@ private:
      * @param pathID ID do caminho
      * @param keyRoots Array para armazenar os nós raiz-chave
      * @param index Índice atual no array keyRoots
-     * @return Integer Novo índice no array keyRoots
+     * @return Index Novo índice no array keyRoots
      */
-    Integer computeKeyRoots(NodeIndexer<Data>* it2, Integer subtreeRootNode, Integer pathID, std::vector<Integer> &keyRoots, Integer index) {
+    Index computeKeyRoots(const NodeIndexer<Data, Index>* it2, Index subtreeRootNode, Index pathID, std::vector<Index> &keyRoots, Index index) {
         // O nó raiz da subárvore é um nó raiz-chave. Adiciona-o a keyRoots.
         keyRoots[index] = subtreeRootNode;
 
@@ -776,13 +951,13 @@ private:
 
         // Percorre o caminho à esquerda começando pelo nó folha mais à esquerda da subárvore,
         // até o filho da subárvore.
-        Integer pathNode = pathID;
+        Index pathNode = pathID;
 
         while (pathNode > subtreeRootNode) {
-            Integer parent = it2->parents[pathNode];
+            Index parent = it2->parents[pathNode];
             // Para cada irmão à direita do nó de caminho, executa este método recursivamente.
             // Cada irmão à direita do nó de caminho é um nó raiz-chave.
-            for (Integer child : it2->children[parent]) {
+            for (Index child : it2->children[parent]) {
                 // Executa computeKeyRoots recursivamente para a nova subárvore enraizada em child e o nó folha mais à esquerda de child.
                 if (child != pathNode) {
                     index = computeKeyRoots(it2, child, it2->preL_to_lld(child), keyRoots, index);
@@ -805,18 +980,18 @@ private:
      * @param forestdist Matriz para armazenar as distâncias de subflorestas
      * @param treesSwapped Flag indicando se as árvores foram trocadas
      */
-    void treeEditDist(NodeIndexer<Data>* it1, NodeIndexer<Data>* it2, Integer it1subtree, Integer it2subtree, std::vector<std::vector<float>> &forestdist, bool treesSwapped) {
+    void treeEditDist(const NodeIndexer<Data, Index>* it1, const NodeIndexer<Data, Index>* it2, Index it1subtree, Index it2subtree, Matrix &forestdist, bool treesSwapped) {
         // Translate input subtree root nodes to left-to-right postorder.
-        Integer i = it1->preL_to_postL[it1subtree];
-        Integer j = it2->preL_to_postL[it2subtree];
+        Index i = it1->preL_to_postL[it1subtree];
+        Index j = it2->preL_to_postL[it2subtree];
 
         // We need to offset the node ids for accessing forestdist array which has
         // indices from 0 to subtree size. However, the subtree node indices do not
         // necessarily start with 0.
         // Whenever the original left-to-right postorder id has to be accessed, use
         // i+ioff and j+joff.
-        Integer ioff = it1->postL_to_lld[i] - 1;
-        Integer joff = it2->postL_to_lld[j] - 1;
+        Index ioff = it1->postL_to_lld[i] - 1;
+        Index joff = it2->postL_to_lld[j] - 1;
 
         // Variables holding costs of each minimum element.
         float da = 0;
@@ -825,44 +1000,42 @@ private:
 
         // Initialize forestdist array with deletion and insertion costs of each
         // relevant subforest.
-        forestdist[0][0] = 0;
-        for (Integer i1 = 1; i1 <= i - ioff; i1++) {
-            forestdist[i1][0] = forestdist[i1 - 1][0] + (treesSwapped ? this->costModel->insertCost(it1->postL_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postL_to_node(i1 + ioff))); // USE COST MODEL - delete i1.
+        forestdist.set(0, 0, 0);
+        for (Index i1 = 1; i1 <= i - ioff; i1++) {
+            forestdist.set(i1, 0, forestdist.get(i1 - 1, 0) + (treesSwapped ? this->costModel->insertCost(it1->postL_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postL_to_node(i1 + ioff)))); // USE COST MODEL - delete i1.
         }
-        for (Integer j1 = 1; j1 <= j - joff; j1++) {
-            forestdist[0][j1] = forestdist[0][j1 - 1] + (treesSwapped ? this->costModel->deleteCost(it2->postL_to_node(j1 + joff)) : this->costModel->insertCost(it2->postL_to_node(j1 + joff))); // USE COST MODEL - insert j1.
+        for (Index j1 = 1; j1 <= j - joff; j1++) {
+            forestdist.set(0, j1, forestdist.get(0, j1 - 1) + (treesSwapped ? this->costModel->deleteCost(it2->postL_to_node(j1 + joff)) : this->costModel->insertCost(it2->postL_to_node(j1 + joff)))); // USE COST MODEL - insert j1.
         }
 
         // Fill in the remaining costs.
-        for (Integer i1 = 1; i1 <= i - ioff; i1++) {
-            for (Integer j1 = 1; j1 <= j - joff; j1++) {
+        for (Index i1 = 1; i1 <= i - ioff; i1++) {
+            for (Index j1 = 1; j1 <= j - joff; j1++) {
                 // Increment the number of subproblems.
                 counter++;
 
                 // Calculate partial distance values for this subproblem.
                 float u = (treesSwapped ? this->costModel->renameCost(it2->postL_to_node(j1 + joff), it1->postL_to_node(i1 + ioff)) : this->costModel->renameCost(it1->postL_to_node(i1 + ioff), it2->postL_to_node(j1 + joff))); // USE COST MODEL - rename i1 to j1.
-                da = forestdist[i1 - 1][j1] + (treesSwapped ? this->costModel->insertCost(it1->postL_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postL_to_node(i1 + ioff))); // USE COST MODEL - delete i1.
-                db = forestdist[i1][j1 - 1] + (treesSwapped ? this->costModel->deleteCost(it2->postL_to_node(j1 + joff)) : this->costModel->insertCost(it2->postL_to_node(j1 + joff))); // USE COST MODEL - insert j1.
+                da = forestdist.get(i1 - 1, j1) + (treesSwapped ? this->costModel->insertCost(it1->postL_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postL_to_node(i1 + ioff))); // USE COST MODEL - delete i1.
+                db = forestdist.get(i1, j1 - 1) + (treesSwapped ? this->costModel->deleteCost(it2->postL_to_node(j1 + joff)) : this->costModel->insertCost(it2->postL_to_node(j1 + joff))); // USE COST MODEL - insert j1.
 
                 // If current subforests are subtrees.
                 if (it1->postL_to_lld[i1 + ioff] == it1->postL_to_lld[i] && it2->postL_to_lld[j1 + joff] == it2->postL_to_lld[j]) {
-                    dc = forestdist[i1 - 1][j1 - 1] + u;
+                    dc = forestdist.get(i1 - 1, j1 - 1) + u;
                     // Store the relevant distance value in delta array.
                     if (treesSwapped) {
-                        delta[it2->postL_to_preL[j1 + joff]][it1->postL_to_preL[i1 + ioff]] = forestdist[i1 - 1][j1 - 1];
-                        MAT.increment();
+                        deltaSet(it2->postL_to_preL[j1 + joff], it1->postL_to_preL[i1 + ioff], forestdist.get(i1 - 1, j1 - 1));
                     } else {
-                        delta[it1->postL_to_preL[i1 + ioff]][it2->postL_to_preL[j1 + joff]] = forestdist[i1 - 1][j1 - 1];
-                        MAT.increment();
+                        deltaSet(it1->postL_to_preL[i1 + ioff], it2->postL_to_preL[j1 + joff], forestdist.get(i1 - 1, j1 - 1));
                     }
                 } else {
-                    dc = forestdist[it1->postL_to_lld[i1 + ioff] - 1 - ioff][it2->postL_to_lld[j1 + joff] - 1 - joff] 
-                         + (treesSwapped ? delta[it2->postL_to_preL[j1 + joff]][it1->postL_to_preL[i1 + ioff]] : delta[it1->postL_to_preL[i1 + ioff]][it2->postL_to_preL[j1 + joff]])
+                    dc = forestdist.get(it1->postL_to_lld[i1 + ioff] - 1 - ioff, it2->postL_to_lld[j1 + joff] - 1 - joff) 
+                         + (treesSwapped ? deltaGet(it2->postL_to_preL[j1 + joff], it1->postL_to_preL[i1 + ioff]) : deltaGet(it1->postL_to_preL[i1 + ioff], it2->postL_to_preL[j1 + joff]))
                          + u;
                 }
 
                 // Calculate final minimum.
-                forestdist[i1][j1] = da >= db ? db >= dc ? dc : db : da >= dc ? dc : da;
+                forestdist.set(i1, j1, da >= db ? db >= dc ? dc : db : da >= dc ? dc : da);
             }
         }
     }
@@ -873,38 +1046,42 @@ private:
      * 
      * @param it1 Iterador de nós da árvore 1
      * @param it2 Iterador de nós da árvore 2
+     * @param currentSubtree1 Raiz (pré-ordem) da subárvore atual da árvore 1
+     * @param currentSubtree2 Raiz (pré-ordem) da subárvore atual da árvore 2
      * @param treesSwapped Flag indicando se as árvores foram trocadas
      * @return float Distância de edição entre as subárvores
      */
-    float spfR(NodeIndexer<Data>* it1, NodeIndexer<Data>* it2, bool treesSwapped) {
+    float spfR(const NodeIndexer<Data, Index>* it1, const NodeIndexer<Data, Index>* it2, Index currentSubtree1, Index currentSubtree2, bool treesSwapped) {
+        phaseStats.spfR.calls++;
+        instrumentation.spfCall();
+        PhaseTimer timer(timed(phaseStats.spfR.ns));
+
         // Inicializa o array para armazenar os nós raiz-chave na subárvore de entrada da direita.
-        std::vector<Integer> revKeyRoots(it2->sizes[it2->getCurrentNode()], -1);
+        std::vector<Index> revKeyRoots(it2->sizes[currentSubtree2], -1);
 
         // Obtém o nó folha mais à direita da subárvore de entrada da direita.
-        Integer pathID = it2->preL_to_rld(it2->getCurrentNode());
+        Index pathID = it2->preL_to_rld(currentSubtree2);
 
         // Calcula os nós raiz-chave na subárvore de entrada da direita.
         // firstKeyRoot é o índice em keyRoots do primeiro nó raiz-chave que
         // precisamos processar. Precisamos desse índice porque o array keyRoots é maior
         // do que o número de nós raiz-chave.
-        Integer firstKeyRoot = computeRevKeyRoots(it2, it2->getCurrentNode(), pathID, revKeyRoots, 0);
+        Index firstKeyRoot = computeRevKeyRoots(it2, currentSubtree2, pathID, revKeyRoots, 0);
 
         // Inicializa um array para armazenar distâncias intermediárias para pares de subflorestas.
-        std::vector<std::vector<float>> forestdist(it1->sizes[it1->getCurrentNode()] + 1);
-        for (size_t i = 0; i < forestdist.size(); i++) {
-            forestdist[i].resize(it2->sizes[it2->getCurrentNode()] + 1);
-        }
+        Matrix &forestdist = forestMatrix;
+        forestdist.resize(it1->sizes[currentSubtree1] + 1, it2->sizes[currentSubtree2] + 1);
 
         // Calcula as distâncias entre pares de nós raiz-chave. Na subárvore de
         // entrada da esquerda, apenas a raiz é o nó raiz-chave. Assim, calculamos a distância
         // entre a subárvore de entrada da esquerda e todos os nós raiz-chave na
         // subárvore de entrada da direita.
-        for (Integer i = firstKeyRoot - 1; i >= 0; i--) {
-            revTreeEditDist(it1, it2, it1->getCurrentNode(), revKeyRoots[i], forestdist, treesSwapped);
+        for (Index i = firstKeyRoot - 1; i >= 0; i--) {
+            revTreeEditDist(it1, it2, currentSubtree1, revKeyRoots[i], forestdist, treesSwapped);
         }
 
         // Retorna a distância entre as subárvores de entrada.
-        return forestdist[it1->sizes[it1->getCurrentNode()]][it2->sizes[it2->getCurrentNode()]];
+        return forestdist.get(it1->sizes[currentSubtree1], it2->sizes[currentSubtree2]);
     }
 
     /**
@@ -915,9 +1092,9 @@ private:
      * @param pathID ID do caminho
      * @param revKeyRoots Array para armazenar os nós raiz-chave
      * @param index Índice atual no array revKeyRoots
-     * @return Integer Novo índice no array revKeyRoots
+     * @return Index Novo índice no array revKeyRoots
      */
-    Integer computeRevKeyRoots(NodeIndexer<Data>* it2, Integer subtreeRootNode, Integer pathID, std::vector<Integer> &revKeyRoots, Integer index) {
+    Index computeRevKeyRoots(const NodeIndexer<Data, Index>* it2, Index subtreeRootNode, Index pathID, std::vector<Index> &revKeyRoots, Index index) {
         // O nó raiz da subárvore é um nó raiz-chave. Adiciona-o a revKeyRoots.
         revKeyRoots[index] = subtreeRootNode;
 
@@ -926,13 +1103,13 @@ private:
 
         // Percorre o caminho à direita começando pelo nó folha mais à direita da subárvore,
         // até o filho da subárvore.
-        Integer pathNode = pathID;
+        Index pathNode = pathID;
 
         while (pathNode > subtreeRootNode) {
-            Integer parent = it2->parents[pathNode];
+            Index parent = it2->parents[pathNode];
             // Para cada irmão à esquerda do nó de caminho, executa este método recursivamente.
             // Cada irmão à esquerda do nó de caminho é um nó raiz-chave.
-            for (Integer child : it2->children[parent]) {
+            for (Index child : it2->children[parent]) {
                 // Executa computeRevKeyRoots recursivamente para a nova subárvore enraizada em child e o nó folha mais à direita de child.
                 if (child != pathNode) {
                     index = computeRevKeyRoots(it2, child, it2->preL_to_rld(child), revKeyRoots, index);
@@ -955,18 +1132,18 @@ private:
      * @param forestdist Matriz para armazenar as distâncias de subflorestas
      * @param treesSwapped Flag indicando se as árvores foram trocadas
      */
-    void revTreeEditDist(NodeIndexer<Data>* it1, NodeIndexer<Data>* it2, Integer it1subtree, Integer it2subtree, std::vector<std::vector<float>> &forestdist, bool treesSwapped) {
+    void revTreeEditDist(const NodeIndexer<Data, Index>* it1, const NodeIndexer<Data, Index>* it2, Index it1subtree, Index it2subtree, Matrix &forestdist, bool treesSwapped) {
         // Translate input subtree root nodes to right-to-left postorder.
-        Integer i = it1->preL_to_postR[it1subtree];
-        Integer j = it2->preL_to_postR[it2subtree];
+        Index i = it1->preL_to_postR[it1subtree];
+        Index j = it2->preL_to_postR[it2subtree];
 
         // We need to offset the node ids for accessing forestdist array which has
         // indices from 0 to subtree size. However, the subtree node indices do not
         // necessarily start with 0.
         // Whenever the original right-to-left postorder id has to be accessed, use
         // i+ioff and j+joff.
-        Integer ioff = it1->postR_to_rld[i] - 1;
-        Integer joff = it2->postR_to_rld[j] - 1;
+        Index ioff = it1->postR_to_rld[i] - 1;
+        Index joff = it2->postR_to_rld[j] - 1;
 
         // Variables holding costs of each minimum element.
         float da = 0;
@@ -975,43 +1152,41 @@ private:
 
         // Initialize forestdist array with deletion and insertion costs of each
         // relevant subforest.
-        forestdist[0][0] = 0;
-        for (Integer i1 = 1; i1 <= i - ioff; i1++) {
-            forestdist[i1][0] = forestdist[i1 - 1][0] + (treesSwapped ? this->costModel->insertCost(it1->postR_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postR_to_node(i1 + ioff))); // USE COST MODEL - delete i1.
+        forestdist.set(0, 0, 0);
+        for (Index i1 = 1; i1 <= i - ioff; i1++) {
+            forestdist.set(i1, 0, forestdist.get(i1 - 1, 0) + (treesSwapped ? this->costModel->insertCost(it1->postR_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postR_to_node(i1 + ioff)))); // USE COST MODEL - delete i1.
         }
-        for (Integer j1 = 1; j1 <= j - joff; j1++) {
-            forestdist[0][j1] = forestdist[0][j1 - 1] + (treesSwapped ? this->costModel->deleteCost(it2->postR_to_node(j1 + joff)) : this->costModel->insertCost(it2->postR_to_node(j1 + joff))); // USE COST MODEL - insert j1.
+        for (Index j1 = 1; j1 <= j - joff; j1++) {
+            forestdist.set(0, j1, forestdist.get(0, j1 - 1) + (treesSwapped ? this->costModel->deleteCost(it2->postR_to_node(j1 + joff)) : this->costModel->insertCost(it2->postR_to_node(j1 + joff)))); // USE COST MODEL - insert j1.
         }
 
         // Fill in the remaining costs.
-        for (Integer i1 = 1; i1 <= i - ioff; i1++) {
-            for (Integer j1 = 1; j1 <= j - joff; j1++) {
+        for (Index i1 = 1; i1 <= i - ioff; i1++) {
+            for (Index j1 = 1; j1 <= j - joff; j1++) {
                 // Increment the number of subproblems.
                 counter++;
 
                 // Calculate partial distance values for this subproblem.
                 float u = (treesSwapped ? this->costModel->renameCost(it2->postR_to_node(j1 + joff), it1->postR_to_node(i1 + ioff)) : this->costModel->renameCost(it1->postR_to_node(i1 + ioff), it2->postR_to_node(j1 + joff))); // USE COST MODEL - rename i1 to j1.
-                da = forestdist[i1 - 1][j1] + (treesSwapped ? this->costModel->insertCost(it1->postR_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postR_to_node(i1 + ioff))); // USE COST MODEL - delete i1.
-                db = forestdist[i1][j1 - 1] + (treesSwapped ? this->costModel->deleteCost(it2->postR_to_node(j1 + joff)) : this->costModel->insertCost(it2->postR_to_node(j1 + joff))); // USE COST MODEL - insert j1.
+                da = forestdist.get(i1 - 1, j1) + (treesSwapped ? this->costModel->insertCost(it1->postR_to_node(i1 + ioff)) : this->costModel->deleteCost(it1->postR_to_node(i1 + ioff))); // USE COST MODEL - delete i1.
+                db = forestdist.get(i1, j1 - 1) + (treesSwapped ? this->costModel->deleteCost(it2->postR_to_node(j1 + joff)) : this->costModel->insertCost(it2->postR_to_node(j1 + joff))); // USE COST MODEL - insert j1.
                 
                 // If current subforests are subtrees.
                 if (it1->postR_to_rld[i1 + ioff] == it1->postR_to_rld[i] && it2->postR_to_rld[j1 + joff] == it2->postR_to_rld[j]) {
-                    dc = forestdist[i1 - 1][j1 - 1] + u;
+                    dc = forestdist.get(i1 - 1, j1 - 1) + u;
                     // Store the relevant distance value in delta array.
                     if (treesSwapped) {
-                        delta[it2->postR_to_preL[j1+joff]][it1->postR_to_preL[i1+ioff]] = forestdist[i1 - 1][j1 - 1];
-                        MAT.increment();
+                        deltaSet(it2->postR_to_preL[j1+joff], it1->postR_to_preL[i1+ioff], forestdist.get(i1 - 1, j1 - 1));
                     } else {
-                        delta[it1->postR_to_preL[i1+ioff]][it2->postR_to_preL[j1+joff]] = forestdist[i1 - 1][j1 - 1];
-                        MAT.increment();
+                        deltaSet(it1->postR_to_preL[i1+ioff], it2->postR_to_preL[j1+joff], forestdist.get(i1 - 1, j1 - 1));
                     }
                 } else {
-                    dc = forestdist[it1->postR_to_rld[i1 + ioff] - 1 - ioff][it2->postR_to_rld[j1 + joff] - 1 - joff] +
-                    (treesSwapped ? delta[it2->postR_to_preL[j1 + joff]][it1->postR_to_preL[i1 + ioff]] : delta[it1->postR_to_preL[i1 + ioff]][it2->postR_to_preL[j1 + joff]]) + u;
+                    dc = forestdist.get(it1->postR_to_rld[i1 + ioff] - 1 - ioff, it2->postR_to_rld[j1 + joff] - 1 - joff) +
+                    (treesSwapped ? deltaGet(it2->postR_to_preL[j1 + joff], it1->postR_to_preL[i1 + ioff]) : deltaGet(it1->postR_to_preL[i1 + ioff], it2->postR_to_preL[j1 + joff])) + u;
                 }
                 
                 // Calculate final minimum.
-                forestdist[i1][j1] = da >= db ? db >= dc ? dc : db : da >= dc ? dc : da;
+                forestdist.set(i1, j1, da >= db ? db >= dc ? dc : db : da >= dc ? dc : da);
             }
         }
     }
@@ -1027,9 +1202,13 @@ private:
      * @param subtreeRootNode2 Nó raiz da subárvore na árvore 2
      * @return float Distância de edição entre as subárvores
      */
-    float spf1(NodeIndexer<Data>* ni1, Integer subtreeRootNode1, NodeIndexer<Data>* ni2, Integer subtreeRootNode2) {
-        Integer subtreeSize1 = ni1->sizes[subtreeRootNode1];
-        Integer subtreeSize2 = ni2->sizes[subtreeRootNode2];
+    float spf1(const NodeIndexer<Data, Index>* ni1, Index subtreeRootNode1, const NodeIndexer<Data, Index>* ni2, Index subtreeRootNode2) {
+        phaseStats.spf1.calls++;
+        instrumentation.spfCall();
+        PhaseTimer timer(timed(phaseStats.spf1.ns));
+
+        Index subtreeSize1 = ni1->sizes[subtreeRootNode1];
+        Index subtreeSize2 = ni2->sizes[subtreeRootNode2];
 
         if (subtreeSize1 == 1 && subtreeSize2 == 1) {
             Node<Data>* n1 = ni1->preL_to_node[subtreeRootNode1];
@@ -1046,7 +1225,7 @@ private:
             float maxCost = cost + this->costModel->deleteCost(n1);
             float minRenMinusIns = cost;
             float nodeRenMinusIns = 0;
-            for (Integer i = subtreeRootNode2; i < subtreeRootNode2 + subtreeSize2; i++) {
+            for (Index i = subtreeRootNode2; i < subtreeRootNode2 + subtreeSize2; i++) {
                 n2 = ni2->preL_to_node[i];
                 nodeRenMinusIns = this->costModel->renameCost(n1, n2) - this->costModel->insertCost(n2);
                 if (nodeRenMinusIns < minRenMinusIns) {
@@ -1067,7 +1246,7 @@ private:
             float minRenMinusDel = cost;
             float nodeRenMinusDel = 0;
 
-            for (Integer i = subtreeRootNode1; i < subtreeRootNode1 + subtreeSize1; i++) {
+            for (Index i = subtreeRootNode1; i < subtreeRootNode1 + subtreeSize1; i++) {
                 n1 = ni1->preL_to_node[i];
                 nodeRenMinusDel = this->costModel->renameCost(n1, n2) - this->costModel->deleteCost(n1);
 
@@ -1084,79 +1263,78 @@ private:
     }
 
     void computeOptStrategy_postL() {
-        Integer size1 = this->it1->getSize();
-        Integer size2 = this->it2->getSize();
-
-        assert(delta.size() == 0);
-        delta.resize(size1);
-        for (size_t i = 0; i < delta.size(); i++) {
-            delta[i].resize(size2);
-        }
-
-        std::vector<std::vector<float>> cost1_L(size1);
-        std::vector<std::vector<float>> cost1_R(size1);
-        std::vector<std::vector<float>> cost1_I(size1);
+        Index size1 = this->it1->getSize();
+        Index size2 = this->it2->getSize();
+
+        assert(delta.rows() == 0);
+        delta.resize(size1, size2);
+
+        // Linhas de custo dos nós de it1 ainda em uso; a linha 0 fica zerada e é
+        // compartilhada pelas folhas. As demais são reaproveitadas após o uso.
+        // Com delta usando metade do limite, cada uma das três recebe um sexto.
+        MatrixOptions costRowOptions = withResidentBytes(matrixOptions.residentBytes / 6);
+        Matrix cost1_L(costRowOptions, 0, COST_ROW_TILE_SHIFT);
+        Matrix cost1_R(costRowOptions, 0, COST_ROW_TILE_SHIFT);
+        Matrix cost1_I(costRowOptions, 0, COST_ROW_TILE_SHIFT);
+        Index numCostRows = maxLiveCostRows(true);
+        cost1_L.resize(numCostRows, size2);
+        cost1_R.resize(numCostRows, size2);
+        cost1_I.resize(numCostRows, size2);
+        std::vector<Index> costRow(size1, -1);
+        std::vector<Index> freeCostRows;
+        Index nextCostRow = 1;
         std::vector<float> cost2_L(size2);
         std::vector<float> cost2_R(size2);
         std::vector<float> cost2_I(size2);
-        std::vector<Integer> cost2_path(size2);
-        std::vector<float> leafRow(size2);
-        Integer pathIDOffset = size1;
+        std::vector<Index> cost2_path(size2);
+        Index pathIDOffset = size1;
         float minCost = 0x7fffffffffffffffL;
-        Integer strategyPath = -1;
-
-        std::vector<Integer> &pre2size1 = this->it1->sizes;
-        std::vector<Integer> &pre2size2 = this->it2->sizes;
-        std::vector<Integer> &pre2descSum1 = this->it1->preL_to_desc_sum;
-        std::vector<Integer> &pre2descSum2 = this->it2->preL_to_desc_sum;
-        std::vector<Integer> &pre2krSum1 = this->it1->preL_to_kr_sum;
-        std::vector<Integer> &pre2krSum2 = this->it2->preL_to_kr_sum;
-        std::vector<Integer> &pre2revkrSum1 = this->it1->preL_to_rev_kr_sum;
-        std::vector<Integer> &pre2revkrSum2 = this->it2->preL_to_rev_kr_sum;
-        std::vector<Integer> &preL_to_preR_1 = this->it1->preL_to_preR;
-        std::vector<Integer> &preL_to_preR_2 = this->it2->preL_to_preR;
-        std::vector<Integer> &preR_to_preL_1 = this->it1->preR_to_preL;
-        std::vector<Integer> &preR_to_preL_2 = this->it2->preR_to_preL;
-        std::vector<Integer> &pre2parent1 = this->it1->parents;
-        std::vector<Integer> &pre2parent2 = this->it2->parents;
-        std::vector<bool> &nodeType_L_1 = this->it1->nodeType_L;
-        std::vector<bool> &nodeType_L_2 = this->it2->nodeType_L;
-        std::vector<bool> &nodeType_R_1 = this->it1->nodeType_R;
-        std::vector<bool> &nodeType_R_2 = this->it2->nodeType_R;
-
-        std::vector<Integer> &preL_to_postL_1 = this->it1->preL_to_postL;
-        std::vector<Integer> &preL_to_postL_2 = this->it2->preL_to_postL;
-        std::vector<Integer> &postL_to_preL_1 = this->it1->postL_to_preL;
-        std::vector<Integer> &postL_to_preL_2 = this->it2->postL_to_preL;
-
-        Integer size_w,
+        Index strategyPath = -1;
+
+        auto &pre2size1 = this->it1->sizes;
+        auto &pre2size2 = this->it2->sizes;
+        auto &pre2descSum1 = this->it1->preL_to_desc_sum;
+        auto &pre2descSum2 = this->it2->preL_to_desc_sum;
+        auto &pre2krSum1 = this->it1->preL_to_kr_sum;
+        auto &pre2krSum2 = this->it2->preL_to_kr_sum;
+        auto &pre2revkrSum1 = this->it1->preL_to_rev_kr_sum;
+        auto &pre2revkrSum2 = this->it2->preL_to_rev_kr_sum;
+        auto &preL_to_preR_1 = this->it1->preL_to_preR;
+        auto &preL_to_preR_2 = this->it2->preL_to_preR;
+        auto &preR_to_preL_1 = this->it1->preR_to_preL;
+        auto &preR_to_preL_2 = this->it2->preR_to_preL;
+        auto &pre2parent1 = this->it1->parents;
+        auto &pre2parent2 = this->it2->parents;
+        auto &nodeType_L_1 = this->it1->nodeType_L;
+        auto &nodeType_L_2 = this->it2->nodeType_L;
+        auto &nodeType_R_1 = this->it1->nodeType_R;
+        auto &nodeType_R_2 = this->it2->nodeType_R;
+
+        auto &preL_to_postL_1 = this->it1->preL_to_postL;
+        auto &preL_to_postL_2 = this->it2->preL_to_postL;
+        auto &postL_to_preL_1 = this->it1->postL_to_preL;
+        auto &postL_to_preL_2 = this->it2->postL_to_preL;
+
+        Index size_w,
             size_v,
             parent_w_preL,
             parent_v_preL,
             parent_w_postL = -1,
             parent_v_postL = -1;
-        Integer leftPath_v,
+        Index leftPath_v,
             rightPath_v;
 
-        std::vector<float> cost_Lpointer_v,
-                           cost_Rpointer_v,
-                           cost_Ipointer_v;
-        std::vector<float> cost_Lpointer_parent_v, 
-                           cost_Rpointer_parent_v,
-                           cost_Ipointer_parent_v;
-        std::vector<float> strategypointer_parent_v;
+        Index row_v,
+            row_parent_v = -1;
 
-        Integer krSum_v, revkrSum_v, descSum_v;
+        Index krSum_v, revkrSum_v, descSum_v;
         bool is_v_leaf;
 
-        Integer v_in_preL;
-        Integer w_in_preL;
+        Index v_in_preL;
+        Index w_in_preL;
 
-        std::stack<std::vector<float>> rowsToReuse_L;
-        std::stack<std::vector<float>> rowsToReuse_R;
-        std::stack<std::vector<float>> rowsToReuse_I;
 
-        for(Integer v = 0; v < size1; v++) {
+        for(Index v = 0; v < size1; v++) {
             v_in_preL = postL_to_preL_1[v];
 
             is_v_leaf = this->it1->isLeaf(v_in_preL);
@@ -1174,48 +1352,32 @@ private:
             descSum_v = pre2descSum1[v_in_preL];
 
             if (is_v_leaf) {
-                cost1_L[v] = leafRow;
-                cost1_R[v] = leafRow;
-                cost1_I[v] = leafRow;
-                for(Integer i = 0; i < size2; i++) {
-                    delta[v_in_preL][postL_to_preL_2[i]] = v_in_preL;
+                costRow[v] = 0;
+                for(Index i = 0; i < size2; i++) {
+                    deltaSet(v_in_preL, postL_to_preL_2[i], v_in_preL);
                 }
             }
 
-            cost_Lpointer_v = cost1_L[v];
-            cost_Rpointer_v = cost1_R[v];
-            cost_Ipointer_v = cost1_I[v];
-
-            if (parent_v_preL != -1 && cost1_L[parent_v_postL].size() == 0) {
-                if (rowsToReuse_L.empty()) {
-                    cost1_L[parent_v_postL] = std::vector<float>(size2);
-                    cost1_R[parent_v_postL] = std::vector<float>(size2);
-                    cost1_I[parent_v_postL] = std::vector<float>(size2);
-                } else {
-                    cost1_L[parent_v_postL] = rowsToReuse_L.top();
-                    rowsToReuse_L.pop();
-
-                    cost1_R[parent_v_postL] = rowsToReuse_R.top();
-                    rowsToReuse_R.pop();
-
-                    cost1_I[parent_v_postL] = rowsToReuse_I.top();
-                    rowsToReuse_I.pop();
-                }
-            }
+            row_v = costRow[v];
 
             if (parent_v_preL != -1) {
-                cost_Lpointer_parent_v = cost1_L[parent_v_postL];
-                cost_Rpointer_parent_v = cost1_R[parent_v_postL];
-                cost_Ipointer_parent_v = cost1_I[parent_v_postL];
-                strategypointer_parent_v = delta[parent_v_preL];
+                if (costRow[parent_v_postL] == -1) {
+                    if (freeCostRows.empty()) {
+                        costRow[parent_v_postL] = nextCostRow++;
+                    } else {
+                        costRow[parent_v_postL] = freeCostRows.back();
+                        freeCostRows.pop_back();
+                    }
+                }
+                row_parent_v = costRow[parent_v_postL];
             }
 
             fillArray(cost2_L, 0.0f);
             fillArray(cost2_R, 0.0f);
             fillArray(cost2_I, 0.0f);
-            fillArray(cost2_path, (Integer)0);
+            fillArray(cost2_path, (Index)0);
 
-            for(Integer w = 0; w < size2; w++) {
+            for(Index w = 0; w < size2; w++) {
                 w_in_preL = postL_to_preL_2[w];
 
                 parent_w_preL = pre2parent2[w_in_preL];
@@ -1238,20 +1400,20 @@ private:
                 if (size_v <= 1 || size_w <= 1) { // USE NEW SINGLE_PATH FUNCTIONS FOR SMALL SUBTREES
                     minCost = std::max(size_v, size_w);
                 } else {
-                    tmpCost = (float) size_v * (float) pre2krSum2[w_in_preL] + cost_Lpointer_v[w];
+                    tmpCost = (float) size_v * (float) pre2krSum2[w_in_preL] + cost1_L.get(row_v, w);
                     if (tmpCost < minCost) {
                         minCost = tmpCost;
                         strategyPath = leftPath_v;
                     }
-                    tmpCost = (float) size_v * (float) pre2revkrSum2[w_in_preL] + cost_Rpointer_v[w];
+                    tmpCost = (float) size_v * (float) pre2revkrSum2[w_in_preL] + cost1_R.get(row_v, w);
                     if (tmpCost < minCost) {
                         minCost = tmpCost;
                         strategyPath = rightPath_v;
                     }
-                    tmpCost = (float) size_v * (float) pre2descSum2[w_in_preL] + cost_Ipointer_v[w];
+                    tmpCost = (float) size_v * (float) pre2descSum2[w_in_preL] + cost1_I.get(row_v, w);
                     if (tmpCost < minCost) {
                         minCost = tmpCost;
-                        strategyPath = (Integer)delta[v_in_preL][w_in_preL] + 1;
+                        strategyPath = (Index)deltaGet(v_in_preL, w_in_preL) + 1;
                     }
                     tmpCost = (float) size_w * (float) krSum_v + cost2_L[w];
                     if (tmpCost < minCost) {
@@ -1271,21 +1433,26 @@ private:
                 }
 
                 if (parent_v_preL != -1) {
-                    cost_Rpointer_parent_v[w] += minCost;
-                    tmpCost = -minCost + cost1_I[v][w];
-                    if (tmpCost < cost1_I[parent_v_postL][w]) {
-                        cost_Ipointer_parent_v[w] = tmpCost;
-                        strategypointer_parent_v[w_in_preL] = delta[v_in_preL][w_in_preL];
+                    float parentCost_L = cost1_L.get(row_parent_v, w);
+                    float parentCost_R = cost1_R.get(row_parent_v, w) + minCost;
+                    float parentCost_I = cost1_I.get(row_parent_v, w);
+                    tmpCost = -minCost + cost1_I.get(row_v, w);
+                    if (tmpCost < parentCost_I) {
+                        parentCost_I = tmpCost;
+                        deltaSet(parent_v_preL, w_in_preL, deltaGet(v_in_preL, w_in_preL));
                     }
                     if (nodeType_R_1[v_in_preL]) {
-                        cost_Ipointer_parent_v[w] += cost_Rpointer_parent_v[w];
-                        cost_Rpointer_parent_v[w] += cost_Rpointer_v[w] - minCost;
+                        parentCost_I += parentCost_R;
+                        parentCost_R += cost1_R.get(row_v, w) - minCost;
                     }
                     if (nodeType_L_1[v_in_preL]) {
-                        cost_Lpointer_parent_v[w] += cost_Lpointer_v[w];
+                        parentCost_L += cost1_L.get(row_v, w);
                     } else {
-                        cost_Lpointer_parent_v[w] += minCost;
+                        parentCost_L += minCost;
                     }
+                    cost1_L.set(row_parent_v, w, parentCost_L);
+                    cost1_R.set(row_parent_v, w, parentCost_R);
+                    cost1_I.set(row_parent_v, w, parentCost_I);
                 }
                 if (parent_w_preL != -1) {
                     cost2_R[parent_w_postL] += minCost;
@@ -1304,16 +1471,14 @@ private:
                         cost2_L[parent_w_postL] += minCost;
                     }
                 }
-                delta[v_in_preL][w_in_preL] = strategyPath;
+                deltaSet(v_in_preL, w_in_preL, strategyPath);
             }
 
             if (!this->it1->isLeaf(v_in_preL)) {
-                fillArray(cost1_L[v], 0.0f);
-                fillArray(cost1_R[v], 0.0f);
-                fillArray(cost1_I[v], 0.0f);
-                rowsToReuse_L.push(cost1_L[v]);
-                rowsToReuse_R.push(cost1_R[v]);
-                rowsToReuse_I.push(cost1_I[v]);
+                cost1_L.clearRow(row_v);
+                cost1_R.clearRow(row_v);
+                cost1_I.clearRow(row_v);
+                freeCostRows.push_back(row_v);
             }
         }
     }
@@ -1324,69 +1489,68 @@ private:
      * @brief Computa a estratégia ótima de edição de árvore usando pós-ordem da esquerda para a direita
      */
     void computeOptStrategy_postR() {
-        Integer size1 = this->it1->getSize();
-        Integer size2 = this->it2->getSize();
-
-        assert(delta.size() == 0);
-        delta.resize(size1);
-        for (size_t i = 0; i < delta.size(); i++) {
-            delta[i].resize(size2);
-        }
-
-        std::vector<std::vector<float>> cost1_L(size1);
-        std::vector<std::vector<float>> cost1_R(size1);
-        std::vector<std::vector<float>> cost1_I(size1);
+        Index size1 = this->it1->getSize();
+        Index size2 = this->it2->getSize();
+
+        assert(delta.rows() == 0);
+        delta.resize(size1, size2);
+
+        // Linhas de custo dos nós de it1 ainda em uso; a linha 0 fica zerada e é
+        // compartilhada pelas folhas. As demais são reaproveitadas após o uso.
+        // Com delta usando metade do limite, cada uma das três recebe um sexto.
+        MatrixOptions costRowOptions = withResidentBytes(matrixOptions.residentBytes / 6);
+        Matrix cost1_L(costRowOptions, 0, COST_ROW_TILE_SHIFT);
+        Matrix cost1_R(costRowOptions, 0, COST_ROW_TILE_SHIFT);
+        Matrix cost1_I(costRowOptions, 0, COST_ROW_TILE_SHIFT);
+        Index numCostRows = maxLiveCostRows(false);
+        cost1_L.resize(numCostRows, size2);
+        cost1_R.resize(numCostRows, size2);
+        cost1_I.resize(numCostRows, size2);
+        std::vector<Index> costRow(size1, -1);
+        std::vector<Index> freeCostRows;
+        Index nextCostRow = 1;
         std::vector<float> cost2_L(size2);
         std::vector<float> cost2_R(size2);
         std::vector<float> cost2_I(size2);
-        std::vector<Integer> cost2_path(size2);
-        std::vector<float> leafRow(size2);
-        Integer pathIDOffset = size1;
+        std::vector<Index> cost2_path(size2);
+        Index pathIDOffset = size1;
         float minCost = 0x7fffffffffffffffL;
-        Integer strategyPath = -1;
-
-        std::vector<Integer> &pre2size1 = this->it1->sizes;
-        std::vector<Integer> &pre2size2 = this->it2->sizes;
-        std::vector<Integer> &pre2descSum1 = this->it1->preL_to_desc_sum;
-        std::vector<Integer> &pre2descSum2 = this->it2->preL_to_desc_sum;
-        std::vector<Integer> &pre2krSum1 = this->it1->preL_to_kr_sum;
-        std::vector<Integer> &pre2krSum2 = this->it2->preL_to_kr_sum;
-        std::vector<Integer> &pre2revkrSum1 = this->it1->preL_to_rev_kr_sum;
-        std::vector<Integer> &pre2revkrSum2 = this->it2->preL_to_rev_kr_sum;
-        std::vector<Integer> &preL_to_preR_1 = this->it1->preL_to_preR;
-        std::vector<Integer> &preL_to_preR_2 = this->it2->preL_to_preR;
-        std::vector<Integer> &preR_to_preL_1 = this->it1->preR_to_preL;
-        std::vector<Integer> &preR_to_preL_2 = this->it2->preR_to_preL;
-        std::vector<Integer> &pre2parent1 = this->it1->parents;
-        std::vector<Integer> &pre2parent2 = this->it2->parents;
-        std::vector<bool> &nodeType_L_1 = this->it1->nodeType_L;
-        std::vector<bool> &nodeType_L_2 = this->it2->nodeType_L;
-        std::vector<bool> &nodeType_R_1 = this->it1->nodeType_R;
-        std::vector<bool> &nodeType_R_2 = this->it2->nodeType_R;
-
-        Integer size_v,
+        Index strategyPath = -1;
+
+        auto &pre2size1 = this->it1->sizes;
+        auto &pre2size2 = this->it2->sizes;
+        auto &pre2descSum1 = this->it1->preL_to_desc_sum;
+        auto &pre2descSum2 = this->it2->preL_to_desc_sum;
+        auto &pre2krSum1 = this->it1->preL_to_kr_sum;
+        auto &pre2krSum2 = this->it2->preL_to_kr_sum;
+        auto &pre2revkrSum1 = this->it1->preL_to_rev_kr_sum;
+        auto &pre2revkrSum2 = this->it2->preL_to_rev_kr_sum;
+        auto &preL_to_preR_1 = this->it1->preL_to_preR;
+        auto &preL_to_preR_2 = this->it2->preL_to_preR;
+        auto &preR_to_preL_1 = this->it1->preR_to_preL;
+        auto &preR_to_preL_2 = this->it2->preR_to_preL;
+        auto &pre2parent1 = this->it1->parents;
+        auto &pre2parent2 = this->it2->parents;
+        auto &nodeType_L_1 = this->it1->nodeType_L;
+        auto &nodeType_L_2 = this->it2->nodeType_L;
+        auto &nodeType_R_1 = this->it1->nodeType_R;
+        auto &nodeType_R_2 = this->it2->nodeType_R;
+
+        Index size_v,
             size_w,
             parent_v,
             parent_w;
-        Integer leftPath_v,
+        Index leftPath_v,
             rightPath_v;
-        std::vector<float> cost_Lpointer_v,
-                           cost_Rpointer_v,
-                           cost_Ipointer_v;
-        std::vector<float> cost_Lpointer_parent_v, 
-                           cost_Rpointer_parent_v,
-                           cost_Ipointer_parent_v;
-        std::vector<float> strategypointer_parent_v;
-        Integer krSum_v, 
+        Index row_v,
+            row_parent_v = -1;
+        Index krSum_v, 
             revkrSum_v,
             descSum_v;
         bool is_v_leaf;
 
-        std::stack<std::vector<float>> rowsToReuse_L;
-        std::stack<std::vector<float>> rowsToReuse_R;
-        std::stack<std::vector<float>> rowsToReuse_I;
 
-        for(Integer v = size1 - 1; v >= 0; v--) {
+        for(Index v = size1 - 1; v >= 0; v--) {
             is_v_leaf = this->it1->isLeaf(v);
             parent_v = pre2parent1[v];
 
@@ -1398,49 +1562,32 @@ private:
             descSum_v = pre2descSum1[v];
 
             if (is_v_leaf) {
-                cost1_L[v] = leafRow;
-                cost1_R[v] = leafRow;
-                cost1_I[v] = leafRow;
-                for (Integer i = 0; i < size2; i++) {
-                    delta[v][i] = v;
-                    MAT.increment();
+                costRow[v] = 0;
+                for (Index i = 0; i < size2; i++) {
+                    deltaSet(v, i, v);
                 }
             }
 
-            cost_Lpointer_v = cost1_L[v];
-            cost_Rpointer_v = cost1_R[v];
-            cost_Ipointer_v = cost1_I[v];
-
-            if (parent_v != -1 && cost1_L[parent_v].size() == 0) {
-                if (rowsToReuse_L.empty()) {
-                    cost1_L[parent_v] = std::vector<float>(size2);
-                    cost1_R[parent_v] = std::vector<float>(size2);
-                    cost1_I[parent_v] = std::vector<float>(size2);
-                } else {
-                    cost1_L[parent_v] = rowsToReuse_L.top();
-                    rowsToReuse_L.pop();
-
-                    cost1_R[parent_v] = rowsToReuse_R.top();
-                    rowsToReuse_R.pop();
-
-                    cost1_I[parent_v] = rowsToReuse_I.top();
-                    rowsToReuse_I.pop();
-                }
-            }
+            row_v = costRow[v];
 
             if (parent_v != -1) {
-                cost_Lpointer_parent_v = cost1_L[parent_v];
-                cost_Rpointer_parent_v = cost1_R[parent_v];
-                cost_Ipointer_parent_v = cost1_I[parent_v];
-                strategypointer_parent_v = delta[parent_v];
+                if (costRow[parent_v] == -1) {
+                    if (freeCostRows.empty()) {
+                        costRow[parent_v] = nextCostRow++;
+                    } else {
+                        costRow[parent_v] = freeCostRows.back();
+                        freeCostRows.pop_back();
+                    }
+                }
+                row_parent_v = costRow[parent_v];
             }
 
             fillArray(cost2_L, 0.0f);
             fillArray(cost2_R, 0.0f);
             fillArray(cost2_I, 0.0f);
-            fillArray(cost2_path, (Integer)0);
+            fillArray(cost2_path, (Index)0);
 
-            for (Integer w = size2 - 1; w >= 0; w--) {
+            for (Index w = size2 - 1; w >= 0; w--) {
                 size_w = pre2size2[w];
                 if (this->it2->isLeaf(w)) {
                     cost2_L[w] = 0.0f;
@@ -1456,20 +1603,20 @@ private:
                 if (size_v <= 1 || size_w <= 1) { // USE NEW SINGLE_PATH FUNCTIONS FOR SMALL SUBTREES
                     minCost = Max(size_v, size_w);
                 } else {
-                    tmpCost = (float) size_v * (float) pre2krSum2[w] + cost_Lpointer_v[w];
+                    tmpCost = (float) size_v * (float) pre2krSum2[w] + cost1_L.get(row_v, w);
                     if (tmpCost < minCost) {
                         minCost = tmpCost;
                         strategyPath = leftPath_v;
                     }
-                    tmpCost = (float) size_v * (float) pre2revkrSum2[w] + cost_Rpointer_v[w];
+                    tmpCost = (float) size_v * (float) pre2revkrSum2[w] + cost1_R.get(row_v, w);
                     if (tmpCost < minCost){
                         minCost = tmpCost;
                         strategyPath = rightPath_v;
                     }
-                    tmpCost = (float) size_v * (float) pre2descSum2[w] + cost_Ipointer_v[w];
+                    tmpCost = (float) size_v * (float) pre2descSum2[w] + cost1_I.get(row_v, w);
                     if (tmpCost < minCost) {
                         minCost = tmpCost;
-                        strategyPath = (Integer)delta[v][w] + 1;
+                        strategyPath = (Index)deltaGet(v, w) + 1;
                     }
                     tmpCost = (float) size_w * (float) krSum_v + cost2_L[w];
                     if (tmpCost < minCost) {
@@ -1489,21 +1636,26 @@ private:
                 }
 
                 if (parent_v != -1) {
-                    cost_Lpointer_parent_v[w] += minCost;
-                    tmpCost = -minCost + cost1_I[v][w];
-                    if (tmpCost < cost1_I[parent_v][w]) {
-                        cost_Ipointer_parent_v[w] = tmpCost;
-                        strategypointer_parent_v[w] = delta[v][w];
+                    float parentCost_L = cost1_L.get(row_parent_v, w) + minCost;
+                    float parentCost_R = cost1_R.get(row_parent_v, w);
+                    float parentCost_I = cost1_I.get(row_parent_v, w);
+                    tmpCost = -minCost + cost1_I.get(row_v, w);
+                    if (tmpCost < parentCost_I) {
+                        parentCost_I = tmpCost;
+                        deltaSet(parent_v, w, deltaGet(v, w));
                     }
                     if (nodeType_L_1[v]) {
-                        cost_Ipointer_parent_v[w] += cost_Lpointer_parent_v[w];
-                        cost_Lpointer_parent_v[w] += cost_Lpointer_v[w] - minCost;
+                        parentCost_I += parentCost_L;
+                        parentCost_L += cost1_L.get(row_v, w) - minCost;
                     }
                     if (nodeType_R_1[v]) {
-                        cost_Rpointer_parent_v[w] += cost_Rpointer_v[w];
+                        parentCost_R += cost1_R.get(row_v, w);
                     } else {
-                        cost_Rpointer_parent_v[w] += minCost;
+                        parentCost_R += minCost;
                     }
+                    cost1_L.set(row_parent_v, w, parentCost_L);
+                    cost1_R.set(row_parent_v, w, parentCost_R);
+                    cost1_I.set(row_parent_v, w, parentCost_I);
                 }
                 parent_w = pre2parent2[w];
                 if (parent_w != -1) {
@@ -1523,17 +1675,14 @@ private:
                         cost2_R[parent_w] += minCost;
                     }
                 }
-                delta[v][w] = strategyPath;
-                MAT.increment();
+                deltaSet(v, w, strategyPath);
             }
 
             if (!this->it1->isLeaf(v)) {
-                fillArray(cost1_L[v], 0.0f);
-                fillArray(cost1_R[v], 0.0f);
-                fillArray(cost1_I[v], 0.0f);
-                rowsToReuse_L.push(cost1_L[v]);
-                rowsToReuse_R.push(cost1_R[v]);
-                rowsToReuse_I.push(cost1_I[v]);
+                cost1_L.clearRow(row_v);
+                cost1_R.clearRow(row_v);
+                cost1_I.clearRow(row_v);
+                freeCostRows.push_back(row_v);
             }
         }
     }
@@ -1547,7 +1696,7 @@ private:
         counter = 0L;
 
         // Inicializa arrays.
-        Integer maxSize = Max(this->size1, this->size2) + 1;
+        Index maxSize = Max(this->size1, this->size2) + 1;
 
         // TODO: Mover inicialização de q para spfA.
         q.resize(maxSize);
@@ -1558,14 +1707,14 @@ private:
 
         // Computa distâncias de subárvores sem os nós raiz quando uma das subárvores
         // é um único nó.
-        Integer sizeX = -1;
-        Integer sizeY = -1;
+        Index sizeX = -1;
+        Index sizeY = -1;
 
         // Loop pelos nós em pós-ordem da esquerda para a direita invertida.
-        for(Integer x = 0; x < this->size1; x++) {
+        for(Index x = 0; x < this->size1; x++) {
             sizeX = this->it1->sizes[x];
 
-            for(Integer y = 0; y < this->size2; y++) {
+            for(Index y = 0; y < this->size2; y++) {
                 sizeY = this->it2->sizes[y];
 
                 // Define valores em delta com base nas somas dos custos de exclusão e inserção.
@@ -1573,14 +1722,11 @@ private:
                 // Neste método, não precisamos verificar a ordem das árvores de entrada
                 // porque é igual à original.
                 if (sizeX == 1 && sizeY == 1) {
-                    delta[x][y] = 0.0f;
-                    MAT.increment();
+                    deltaSet(x, y, 0.0f);
                 } else if (sizeX == 1) {
-                    delta[x][y] = this->it2->preL_to_sumInsCost[y] - this->costModel->insertCost(this->it2->preL_to_node[y]); // USA O MODELO DE CUSTO.
-                    MAT.increment();
+                    deltaSet(x, y, this->it2->preL_to_sumInsCost[y] - this->costModel->insertCost(this->it2->preL_to_node[y])); // USA O MODELO DE CUSTO.
                 } else if (sizeY == 1) {
-                    delta[x][y] = this->it1->preL_to_sumDelCost[x] - this->costModel->deleteCost(this->it1->preL_to_node[x]); // USA O MODELO DE CUSTO.
-                    MAT.increment();
+                    deltaSet(x, y, this->it1->preL_to_sumDelCost[x] - this->costModel->deleteCost(this->it1->preL_to_node[x])); // USA O MODELO DE CUSTO.
                 }
             }
         }
@@ -1593,111 +1739,233 @@ private:
      * 
      * @param it1 Iterador de nós da árvore 1
      * @param it2 Iterador de nós da árvore 2
+     * @param currentSubtree1 Raiz (pré-ordem) da subárvore atual da árvore 1
+     * @param currentSubtree2 Raiz (pré-ordem) da subárvore atual da árvore 2
      * @return float Distância de edição entre as árvores
      */
-    float gted(NodeIndexer<Data>* it1, NodeIndexer<Data>* it2) {
-        Integer currentSubtree1 = it1->getCurrentNode();
-        Integer currentSubtree2 = it2->getCurrentNode();
-        Integer subtreeSize1 = it1->sizes[currentSubtree1];
-        Integer subtreeSize2 = it2->sizes[currentSubtree2];
+    float gted(const NodeIndexer<Data, Index>* it1, const NodeIndexer<Data, Index>* it2, Index currentSubtree1, Index currentSubtree2) {
+        Index subtreeSize1 = it1->sizes[currentSubtree1];
+        Index subtreeSize2 = it2->sizes[currentSubtree2];
 
         // Usa spf1.
         if ((subtreeSize1 == 1 || subtreeSize2 == 1)) {
             return spf1(it1, currentSubtree1, it2, currentSubtree2);
         }
 
-        Integer strategyPathID = (Integer)delta[currentSubtree1][currentSubtree2];
+        Index strategyPathID = (Index)deltaGet(currentSubtree1, currentSubtree2);
 
-        Integer strategyPathType = -1;
-        Integer currentPathNode = Abs(strategyPathID) - 1;
-        Integer pathIDOffset = it1->getSize();
+        Index strategyPathType = -1;
+        Index currentPathNode = Abs(strategyPathID) - 1;
+        Index pathIDOffset = it1->getSize();
 
-        Integer parent = -1;
+        Index parent = -1;
         if(currentPathNode < pathIDOffset) {
             strategyPathType = getStrategyPathType(strategyPathID, pathIDOffset, it1, currentSubtree1, subtreeSize1);
             while((parent = it1->parents[currentPathNode]) >= currentSubtree1) {
-                std::vector<Integer> ai;
-                Integer k = (ai = it1->children[parent]).size();
-                for(Integer i = 0; i < k; i++) {
-                    Integer child = ai[i];
+                ChildRange<Index> ai = it1->children[parent];
+                Index k = ai.size();
+                for(Index i = 0; i < k; i++) {
+                    Index child = ai[i];
                     if(child != currentPathNode) {
-                        it1->setCurrentNode(child);
-                        gted(it1, it2);
+                        gted(it1, it2, child, currentSubtree2);
                     }
                 }
                 currentPathNode = parent;
             }
-            // TODO: Mover essa propriedade para fora do indexador de nós e passar diretamente para os spfs.
-            it1->setCurrentNode(currentSubtree1);
-
             // Passa para os spfs um bool que indica se a ordem das subárvores de entrada
             // foi trocada em comparação com a ordem das árvores de entrada iniciais.
             // Usado para acessar a matriz delta e decidir sobre a operação de edição
             // [1, Seção 3.4].
             if (strategyPathType == 0) {
-                return spfL(it1, it2, false);
+                return spfL(it1, it2, currentSubtree1, currentSubtree2, false);
             }
             if (strategyPathType == 1) {
-                return spfR(it1, it2, false);
+                return spfR(it1, it2, currentSubtree1, currentSubtree2, false);
             }
-            return spfA(it1, it2, Abs(strategyPathID) - 1, strategyPathType, false);
+            return spfA(it1, it2, currentSubtree1, currentSubtree2, Abs(strategyPathID) - 1, strategyPathType, false);
         }
 
         currentPathNode -= pathIDOffset;
         strategyPathType = getStrategyPathType(strategyPathID, pathIDOffset, it2, currentSubtree2, subtreeSize2);
         while((parent = it2->parents[currentPathNode]) >= currentSubtree2) {
-            std::vector<Integer> ai1;
-            Integer l = (ai1 = it2->children[parent]).size();
-            for(Integer j = 0; j < l; j++) {
-                Integer child = ai1[j];
+            ChildRange<Index> ai1 = it2->children[parent];
+            Index l = ai1.size();
+            for(Index j = 0; j < l; j++) {
+                Index child = ai1[j];
                 if(child != currentPathNode) {
-                    it2->setCurrentNode(child);
-                    gted(it1, it2);
+                    gted(it1, it2, currentSubtree1, child);
                 }
             }
             currentPathNode = parent;
         }
-        // TODO: Mover essa propriedade para fora do indexador de nós e passar diretamente para os spfs.
-        it2->setCurrentNode(currentSubtree2);
-
         // Passa para os spfs um bool que indica se a ordem das subárvores de entrada
         // foi trocada em comparação com a ordem das árvores de entrada iniciais.
         // Usado para acessar a matriz delta e decidir sobre a operação de edição
         // [1, Seção 3.4].
         if (strategyPathType == 0) {
-            return spfL(it2, it1, true);
+            return spfL(it2, it1, currentSubtree2, currentSubtree1, true);
         }
         if (strategyPathType == 1) {
-            return spfR(it2, it1, true);
+            return spfR(it2, it1, currentSubtree2, currentSubtree1, true);
         }
 
-        return spfA(it2, it1, Abs(strategyPathID) - pathIDOffset - 1, strategyPathType, true);
+        return spfA(it2, it1, currentSubtree2, currentSubtree1, Abs(strategyPathID) - pathIDOffset - 1, strategyPathType, true);
     }
 
 public:
-    MemoryAccessTracker MAT;
+    /**
+     * @brief Estima, sem indexar nem calcular, a memória de um cálculo entre
+     *        árvores com os tamanhos dados
+     *
+     * @param size1 Tamanho da árvore 1
+     * @param size2 Tamanho da árvore 2
+     * @param matrixOptions Opções passadas ao construtor (limitam delta, as
+     *        linhas de custo e as matrizes de spf quando Matrix é MappedFloatMatrix)
+     * @return MemoryEstimate Memória de cada estrutura
+     */
+    static MemoryEstimate estimateMemory(size_t size1, size_t size2, const MatrixOptions &matrixOptions = MatrixOptions()) {
+        MatrixOptions deltaOptions = matrixOptions;
+        deltaOptions.residentBytes = matrixOptions.residentBytes / 2;
+        MatrixOptions costRowOptions = matrixOptions;
+        costRowOptions.residentBytes = matrixOptions.residentBytes / 6;
+        MatrixOptions spfOptions = matrixOptions;
+        spfOptions.residentBytes = matrixOptions.residentBytes / 4;
+
+        // Cada linha de custo em uso pertence a um ancestral do nó atual com um
+        // filho já processado fora do caminho, então há no máximo size1 / 2 delas,
+        // além da linha zerada das folhas.
+        size_t costRows = std::min(size1, size1 / 2 + 1) + 1;
+        size_t maxSize = std::max(size1, size2) + 1;
+
+        MemoryEstimate estimate;
+        estimate.indexers = NodeIndexer<Data, Index>::estimateBytes(size1) + NodeIndexer<Data, Index>::estimateBytes(size2);
+        estimate.delta = Matrix::estimateBytes(size1, size2, deltaOptions, DELTA_TILE_SHIFT, DELTA_TILE_SHIFT);
+        estimate.strategyRows = 3 * Matrix::estimateBytes(costRows, size2, costRowOptions, 0, COST_ROW_TILE_SHIFT)
+                              + size2 * (3 * sizeof(float) + sizeof(Index))
+                              + size1 * (2 * sizeof(Index) + sizeof(uint8_t));
+        // spf* pode receber as árvores trocadas; t tem o tamanho da segunda árvore ao quadrado.
+        estimate.spfA = Matrix::estimateBytes(size1 + 1, size2 + 1, spfOptions, SPF_TILE_SHIFT, SPF_TILE_SHIFT)
+                      + Matrix::estimateBytes(maxSize, maxSize, spfOptions, SPF_TILE_SHIFT, SPF_TILE_SHIFT);
+        estimate.spfL = Matrix::estimateBytes(size1 + 1, size2 + 1, spfOptions, SPF_TILE_SHIFT, SPF_TILE_SHIFT);
+        estimate.arrays = maxSize * sizeof(float) + 2 * (maxSize + 1) * sizeof(Index);
+        return estimate;
+    }
 
-    Apted(CostModel<Data>* costModel) : TreeEditDistance<Data>(costModel) {
+    /**
+     * @brief Construtor da classe Apted
+     * 
+     * @param costModel Modelo de custo
+     * @param matrixOptions Limite de memória e diretório usados por MappedFloatMatrix
+     */
+    Apted(CostModel<Data>* costModel, const MatrixOptions &matrixOptions = MatrixOptions())
+        : TreeEditDistance<Data, Index>(costModel), matrixOptions(matrixOptions),
+          // delta fica com metade do limite durante todo o cálculo; na fase de
+          // distância, as duas matrizes de spf dividem a outra metade (na fase de
+          // estratégia, ela vai para as linhas de custo).
+          delta(withResidentBytes(matrixOptions.residentBytes / 2), DELTA_TILE_SHIFT, DELTA_TILE_SHIFT),
+          forestMatrix(withResidentBytes(matrixOptions.residentBytes / 4), SPF_TILE_SHIFT, SPF_TILE_SHIFT),
+          pathMatrix(withResidentBytes(matrixOptions.residentBytes / 4), SPF_TILE_SHIFT, SPF_TILE_SHIFT) {
         // nop
     }
 
     virtual float computeEditDistance(Node<Data>* t1, Node<Data>* t2) override {
-        // Indexa os nós de ambas as árvores de entrada.
-        this->init(t1, t2);
-        MAT.reset();
-        // Determina a estratégia ótima para o cálculo da distância.
-        // Usa a heurística de [2, Seção 5.3].
-        if (this->it1->lchl < this->it1->rchl) {
-            computeOptStrategy_postL();
-        } else {
-            computeOptStrategy_postR();
+        phaseStats = PhaseStats();
+        {
+            // Indexa os nós de ambas as árvores de entrada.
+            PhaseTimer timer(timed(phaseStats.indexingNs));
+            this->init(t1, t2);
         }
+        return computeIndexedEditDistance();
+    }
+
+    /**
+     * @brief Calcula a distância de edição entre duas árvores já indexadas,
+     *        sem refazer a indexação (ex.: índices carregados com NodeIndexer::load)
+     * 
+     * @param ni1 Indexador da árvore 1
+     * @param ni2 Indexador da árvore 2
+     * @return float Distância de edição entre as árvores
+     */
+    float computeEditDistance(const NodeIndexer<Data, Index>* ni1, const NodeIndexer<Data, Index>* ni2) {
+        phaseStats = PhaseStats();
+        this->init(ni1, ni2);
+        return computeIndexedEditDistance();
+    }
+
+    /**
+     * @brief Obtém a quantidade de subproblemas calculados na última chamada de
+     *        computeEditDistance. Depende só do formato das árvores, não dos
+     *        rótulos, e mede o trabalho do algoritmo sem o ruído do tempo.
+     *
+     * @return long Quantidade de subproblemas
+     */
+    long getSubproblemCount() const {
+        return counter;
+    }
 
-        // Inicializa as estruturas para o cálculo da distância.
-        tedInit();
+    /**
+     * @brief Obtém a instrumentação do último cálculo. Com CountingInstrumentation,
+     *        counts() tem os eventos contados; com NoInstrumentation, zeros.
+     *
+     * @return const Instrumentation& Política de instrumentação desta instância
+     */
+    const Instrumentation& getInstrumentation() const {
+        return instrumentation;
+    }
+
+    /**
+     * @brief Liga ou desliga a medição do tempo das fases e das spf. Desligada,
+     *        computeEditDistance não lê o relógio e só conta as chamadas das spf.
+     *
+     * @param enabled true para medir os tempos
+     */
+    void setPhaseTiming(bool enabled) {
+        phaseTiming = enabled;
+    }
+
+    /**
+     * @brief Obtém o tempo das fases e as chamadas das spf da última chamada de
+     *        computeEditDistance
+     *
+     * @return const PhaseStats& Estatísticas da última chamada
+     */
+    const PhaseStats& getPhaseStats() const {
+        return phaseStats;
+    }
+
+private:
+    /**
+     * @brief Executa as fases de estratégia e distância sobre it1 e it2 já inicializados
+     * 
+     * @return float Distância de edição entre as árvores
+     */
+    float computeIndexedEditDistance() {
+        instrumentation.reset();
+        {
+            // Determina a estratégia ótima para o cálculo da distância.
+            // Usa a heurística de [2, Seção 5.3].
+            PhaseTimer timer(timed(phaseStats.strategyNs));
+            if (this->it1->lchl < this->it1->rchl) {
+                computeOptStrategy_postL();
+            } else {
+                computeOptStrategy_postR();
+            }
+        }
+
+        {
+            // Inicializa as estruturas para o cálculo da distância.
+            PhaseTimer timer(timed(phaseStats.tedInitNs));
+            tedInit();
+        }
 
         // Computa a distância.
-        return gted(this->it1, this->it2);
+        float distance;
+        {
+            PhaseTimer timer(timed(phaseStats.gtedNs));
+            distance = gted(this->it1, this->it2, 0, 0);
+        }
+        instrumentation.cells(counter);
+        return distance;
     }
 };
 
@@ -0,0 +1,130 @@
+#pragma once
+
+/**
+ * @file LabelSequenceBound.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Limite inferior da distância de edição de árvores pelas sequências de
+ *        rótulos em pré-ordem e pós-ordem
+ *
+ * @date 2024-06-22
+ *
+ * ALgoritmo original retirado de:
+ * <p>See the source code for more algorithm-related comments.
+ *
+ * <p>References:
+ * <ul>
+ * <li>[1] M. Pawlik and N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik and N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * <li>[3] S. Guha, H. V. Jagadish, N. Koudas, D. Srivastava e T. Yu.
+ *      Approximate XML joins. SIGMOD 2002.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou tradizido para melhor compreenção do grupo.
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "../StringNodeData.h"
+#include "../StringNodeSerializer.h"
+#include "../util/LabelDictionary.h"
+#include "../util/SequenceEditDistance.h"
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Label Sequences
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Rótulos internalizados de uma árvore em pré-ordem e em pós-ordem
+ */
+struct LabelSequences {
+    std::vector<uint32_t> preorder;
+    std::vector<uint32_t> postorder;
+};
+
+//------------------------------------------------------------------------------
+// Label Sequence Bound
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Limite inferior da distância de edição com custos unitários
+ *        (StringCostModel): a distância de edição entre as sequências de rótulos
+ *        em pré-ordem, e também em pós-ordem, nunca passa da distância entre as
+ *        árvores [3]. O limite é o maior dos dois, calculado com
+ *        SequenceEditDistance em O(n * m / 64).
+ *
+ *        Para filtrar muitos pares, as sequências de cada árvore são obtidas uma
+ *        vez com sequences() e comparadas com lowerBound(LabelSequences, ...).
+ *        Uma instância não deve ser usada por várias threads ao mesmo tempo.
+ */
+class LabelSequenceBound {
+private:
+    LabelDictionary dictionary;
+    SequenceEditDistance editDistance;
+
+public:
+    LabelSequenceBound() { }
+
+    LabelSequenceBound(const LabelSequenceBound&) = delete;
+    LabelSequenceBound& operator=(const LabelSequenceBound&) = delete;
+
+    /**
+     * @brief Obtém as sequências de rótulos de uma árvore, internalizando os
+     *        rótulos no dicionário desta instância
+     *
+     * @param root Raiz da árvore
+     * @return LabelSequences Rótulos em pré-ordem e em pós-ordem
+     */
+    LabelSequences sequences(const Node<StringNodeData>* root) {
+        LabelSequences result;
+        walkTree(root,
+            [this, &result](const Node<StringNodeData>* node) {
+                result.preorder.push_back(dictionary.intern(node->getData()->getLabel()));
+            },
+            [this, &result](const Node<StringNodeData>* node) {
+                result.postorder.push_back(dictionary.intern(node->getData()->getLabel()));
+            });
+        return result;
+    }
+
+    /**
+     * @brief Calcula o limite inferior entre árvores cujas sequências foram
+     *        obtidas desta mesma instância
+     *
+     * @param s1 Sequências da árvore 1
+     * @param s2 Sequências da árvore 2
+     * @return size_t max(distância em pré-ordem, distância em pós-ordem)
+     */
+    size_t lowerBound(const LabelSequences &s1, const LabelSequences &s2) {
+        size_t preorder = editDistance.compute(s1.preorder, s2.preorder);
+        size_t postorder = editDistance.compute(s1.postorder, s2.postorder);
+        return std::max(preorder, postorder);
+    }
+
+    /**
+     * @brief Calcula o limite inferior entre duas árvores
+     *
+     * @param t1 Raiz da árvore 1
+     * @param t2 Raiz da árvore 2
+     * @return float Valor que não passa de Apted<StringNodeData> com StringCostModel
+     */
+    float lowerBound(const Node<StringNodeData>* t1, const Node<StringNodeData>* t2) {
+        LabelSequences s1 = sequences(t1);
+        LabelSequences s2 = sequences(t2);
+        return (float)lowerBound(s1, s2);
+    }
+};
+
+} // namespace capted
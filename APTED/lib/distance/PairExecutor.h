@@ -0,0 +1,246 @@
+#pragma once
+
+/**
+ * @file PairExecutor.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Execução de lotes de pares em paralelo, com controle de admissão pela
+ *        memória estimada de cada par
+ *
+ * @date 2024-06-22
+ *
+ * ALgoritmo original retirado de:
+ * <p>See the source code for more algorithm-related comments.
+ *
+ * <p>References:
+ * <ul>
+ * <li>[1] M. Pawlik and N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik and N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou tradizido para melhor compreenção do grupo.
+ *
+ */
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Apted.h"
+#include "../node/IndexStore.h"
+#include "../util/ThreadPool.h"
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Executor Options
+//------------------------------------------------------------------------------
+
+/**
+ * @brief O que fazer com um par cuja estimativa sozinha passa do limite de memória
+ */
+enum class OverBudgetPolicy {
+    Queue,  /**< Espera os pares em execução terminarem e executa o par sozinho */
+    Reject  /**< Não executa o par e marca o resultado como rejeitado */
+};
+
+/**
+ * @brief Configuração de PairExecutor
+ */
+struct ExecutorOptions {
+    size_t memoryBudget = 0;                               /**< Soma máxima das estimativas dos pares em execução; 0 desliga o controle */
+    OverBudgetPolicy overBudget = OverBudgetPolicy::Queue; /**< Tratamento dos pares maiores que o limite */
+    MatrixOptions matrixOptions;                           /**< Repassado a cada instância de Apted */
+};
+
+/**
+ * @brief Resultado de um par do lote
+ */
+struct PairResult {
+    float distance = -1;        /**< Distância de edição, ou -1 se o par não foi calculado */
+    size_t estimatedBytes = 0;  /**< Pico de memória estimado para o par */
+    bool rejected = false;      /**< O par passou do limite com OverBudgetPolicy::Reject */
+    std::string error;          /**< Mensagem de erro, vazia se o par foi calculado */
+};
+
+//------------------------------------------------------------------------------
+// Pair Executor
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Calcula a distância de vários pares nas threads de um ThreadPool. Antes
+ *        de cada par, a memória necessária é estimada com Apted::estimateMemory e
+ *        reservada de um limite compartilhado; o par espera enquanto a reserva não
+ *        cabe. A admissão segue a ordem dos pares, então um par grande não fica
+ *        esperando indefinidamente atrás de pares menores que chegaram depois.
+ *        Uma instância executa um lote por vez.
+ *
+ * @tparam Data Tipo dos dados armazenados nos nós da árvore
+ * @tparam Index Tipo inteiro usado pelos índices
+ * @tparam Matrix Armazenamento de delta e das linhas de custo em Apted
+ */
+template<class Data, class Index = Integer, class Matrix = DenseFloatMatrix>
+class PairExecutor {
+private:
+    CostModel<Data>* costModel;
+    ThreadPool &pool;
+    ExecutorOptions options;
+
+    std::mutex mutex;
+    std::condition_variable released;
+    size_t reservedBytes = 0;
+    size_t nextAdmission = 0;
+
+    /**
+     * @brief Espera a vez do par e a memória estimada ficar disponível
+     *
+     * @param position Posição do par no lote
+     * @param bytes Memória estimada do par
+     * @return true Se o par foi admitido (e a memória reservada)
+     */
+    bool admit(size_t position, size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [this, position] { return nextAdmission == position; });
+
+        bool admitted = true;
+        if (options.memoryBudget != 0) {
+            if (bytes > options.memoryBudget && options.overBudget == OverBudgetPolicy::Reject) {
+                admitted = false;
+            } else {
+                // Um par maior que o limite só começa quando nada mais está em execução.
+                released.wait(lock, [this, bytes] {
+                    return reservedBytes == 0 || reservedBytes + bytes <= options.memoryBudget;
+                });
+            }
+        }
+
+        if (admitted) {
+            reservedBytes += bytes;
+        }
+        nextAdmission++;
+        released.notify_all();
+        return admitted;
+    }
+
+    /**
+     * @brief Devolve a memória reservada por um par admitido
+     * @param bytes Memória estimada do par
+     */
+    void release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            reservedBytes -= bytes;
+        }
+        released.notify_all();
+    }
+
+    /**
+     * @brief Executa os pares em paralelo, na ordem de admissão
+     *
+     * @param count Quantidade de pares
+     * @param estimate Função que devolve a memória estimada do i-ésimo par
+     * @param compute Função que calcula a distância do i-ésimo par
+     * @return std::vector<PairResult> Um resultado por par, na ordem de entrada
+     */
+    template<class Estimate, class Compute>
+    std::vector<PairResult> execute(size_t count, Estimate estimate, Compute compute) {
+        std::vector<PairResult> results(count);
+        reservedBytes = 0;
+        nextAdmission = 0;
+
+        pool.parallelFor(count, [&](size_t i) {
+            PairResult &result = results[i];
+            result.estimatedBytes = estimate(i);
+            if (!admit(i, result.estimatedBytes)) {
+                result.rejected = true;
+                result.error = "estimated memory exceeds the budget";
+                return;
+            }
+
+            try {
+                Apted<Data, Index, Matrix> algorithm(costModel, options.matrixOptions);
+                result.distance = compute(algorithm, i);
+            } catch (const std::exception &e) {
+                result.distance = -1;
+                result.error = e.what();
+            }
+            release(result.estimatedBytes);
+        });
+
+        return results;
+    }
+
+public:
+    /**
+     * @brief Construtor da classe PairExecutor
+     *
+     * @param costModel Modelo de custo, compartilhado pelas threads
+     * @param pool Threads usadas nos cálculos
+     * @param options Limite de memória e tratamento dos pares maiores que ele
+     */
+    PairExecutor(CostModel<Data>* costModel, ThreadPool &pool, const ExecutorOptions &options = ExecutorOptions())
+        : costModel(costModel), pool(pool), options(options) {
+        // nop
+    }
+
+    PairExecutor(const PairExecutor&) = delete;
+    PairExecutor& operator=(const PairExecutor&) = delete;
+
+    /**
+     * @brief Calcula a distância de cada par de árvores. As árvores são indexadas
+     *        dentro do cálculo, então a estimativa inclui os indexadores.
+     *
+     * @param pairs Pares de raízes; as árvores devem sobreviver à chamada
+     * @return std::vector<PairResult> Um resultado por par, na ordem de entrada
+     */
+    std::vector<PairResult> run(const std::vector<std::pair<Node<Data>*, Node<Data>*>> &pairs) {
+        return execute(pairs.size(), [&](size_t i) {
+            return Apted<Data, Index, Matrix>::estimateMemory(pairs[i].first->getNodeCount(),
+                                                              pairs[i].second->getNodeCount(),
+                                                              options.matrixOptions).peak();
+        }, [&](Apted<Data, Index, Matrix> &algorithm, size_t i) {
+            return algorithm.computeEditDistance(pairs[i].first, pairs[i].second);
+        });
+    }
+
+    /**
+     * @brief Calcula a distância de pares de árvores de um IndexStore. Os
+     *        indexadores já estão em memória e não entram na estimativa.
+     *
+     * @param store Árvores indexadas
+     * @param pairs Pares de posições em store
+     * @return std::vector<PairResult> Um resultado por par, na ordem de entrada;
+     *         pares com entradas que falharam na indexação trazem o erro delas
+     */
+    std::vector<PairResult> run(const IndexStore<Data, Index> &store, const std::vector<std::pair<size_t, size_t>> &pairs) {
+        return execute(pairs.size(), [&](size_t i) -> size_t {
+            if (store.failed(pairs[i].first) || store.failed(pairs[i].second)) {
+                return 0;
+            }
+            MemoryEstimate estimate = Apted<Data, Index, Matrix>::estimateMemory(store.index(pairs[i].first)->getSize(),
+                                                                                 store.index(pairs[i].second)->getSize(),
+                                                                                 options.matrixOptions);
+            estimate.indexers = 0;
+            return estimate.peak();
+        }, [&](Apted<Data, Index, Matrix> &algorithm, size_t i) -> float {
+            size_t failed = store.failed(pairs[i].first) ? pairs[i].first : pairs[i].second;
+            if (store.failed(failed)) {
+                throw std::runtime_error(store.error(failed));
+            }
+            return algorithm.computeEditDistance(store.index(pairs[i].first), store.index(pairs[i].second));
+        });
+    }
+};
+
+} // namespace capted
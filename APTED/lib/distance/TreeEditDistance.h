@@ -42,24 +42,46 @@ namespace capted {
 
 typedef std::pair<Integer, Integer> IntPair;
 
-template<class Data>
+template<class Data, class Index = Integer>
 class TreeEditDistance {
 protected:
-    NodeIndexer<Data>* it1; /**< Iterador de nós da árvore 1 */
-    NodeIndexer<Data>* it2; /**< Iterador de nós da árvore 2 */
-    Integer size1;          /**< Tamanho da árvore 1 */
-    Integer size2;          /**< Tamanho da árvore 2 */
+    const NodeIndexer<Data, Index>* it1; /**< Iterador de nós da árvore 1 */
+    const NodeIndexer<Data, Index>* it2; /**< Iterador de nós da árvore 2 */
+    Index size1;          /**< Tamanho da árvore 1 */
+    Index size2;          /**< Tamanho da árvore 2 */
     const CostModel<Data>* costModel; /**< Modelo de custo para operações de edição de árvore */
+    bool ownsIndexers;      /**< Indica se it1 e it2 foram criados (e devem ser liberados) por esta instância */
 
     /**
      * @brief Inicializa os indexadores de nós e os tamanhos das árvores
      * 
      * @param t1 Raiz da árvore 1
      * @param t2 Raiz da árvore 2
+     * @throw std::overflow_error Se alguma árvore é grande demais para a largura Index
      */
     void init(Node<Data>* t1, Node<Data>* t2) {
-        it1 = new NodeIndexer<Data>(t1, costModel);
-        it2 = new NodeIndexer<Data>(t2, costModel);
+        // Marca a posse antes de indexar: se a segunda indexação lançar exceção,
+        // o destrutor ainda libera a primeira.
+        ownsIndexers = true;
+        it1 = nullptr;
+        it2 = nullptr;
+        it1 = new NodeIndexer<Data, Index>(t1, costModel);
+        it2 = new NodeIndexer<Data, Index>(t2, costModel);
+        size1 = it1->getSize();
+        size2 = it2->getSize();
+    }
+
+    /**
+     * @brief Usa indexadores já construídos (por exemplo, carregados do cache).
+     *        Os indexadores continuam pertencendo a quem chamou.
+     * 
+     * @param ni1 Indexador da árvore 1
+     * @param ni2 Indexador da árvore 2
+     */
+    void init(const NodeIndexer<Data, Index>* ni1, const NodeIndexer<Data, Index>* ni2) {
+        it1 = ni1;
+        it2 = ni2;
+        ownsIndexers = false;
         size1 = it1->getSize();
         size2 = it2->getSize();
     }
@@ -73,6 +95,7 @@ public:
     TreeEditDistance(CostModel<Data>* costModel) : costModel(costModel) {
         it1 = nullptr;
         it2 = nullptr;
+        ownsIndexers = false;
         size1 = -1;
         size2 = -1;
     }
@@ -81,8 +104,10 @@ public:
      * @brief Destrutor da classe TreeEditDistance
      */
     ~TreeEditDistance() {
-        delete it1;
-        delete it2;
+        if (ownsIndexers) {
+            delete it1;
+            delete it2;
+        }
     }
 
     /**
@@ -0,0 +1,207 @@
+#pragma once
+
+/**
+ * @file IndexStore.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Indexação paralela de coleções de árvores em um repositório imutável
+ *        de NodeIndexers, compartilhável entre threads
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Node.h"
+#include "NodeIndexer.h"
+#include "../CostModel.h"
+#include "../StringNodeData.h"
+#include "../util/ThreadPool.h"
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Index Store
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Coleção imutável de árvores já indexadas. Depois de construída, a
+ *        coleção só expõe acessos const, então o mesmo NodeIndexer pode ser
+ *        usado por várias instâncias de Apted em threads diferentes.
+ *
+ * @tparam Data Tipo dos dados armazenados nos nós
+ * @tparam Index Tipo inteiro usado pelos índices
+ */
+template<class Data, class Index = Integer>
+class IndexStore {
+public:
+    /**
+     * @brief Função de progresso, chamada após cada árvore processada com a
+     *        quantidade concluída e o total. As chamadas são serializadas.
+     */
+    typedef std::function<void(size_t done, size_t total)> Progress;
+
+private:
+    struct Entry {
+        std::unique_ptr<Node<Data>> tree;
+        std::unique_ptr<const NodeIndexer<Data, Index>> indexer;
+        std::string error;
+    };
+
+    std::vector<Entry> entries;
+    size_t failures = 0;
+
+    explicit IndexStore(size_t count) : entries(count) { }
+
+public:
+    IndexStore(const IndexStore&) = delete;
+    IndexStore& operator=(const IndexStore&) = delete;
+
+    /**
+     * @brief Lê e indexa count árvores em paralelo
+     *
+     * @param count Quantidade de árvores
+     * @param parseTree Função que recebe a posição i e devolve a raiz da i-ésima
+     *        árvore (posse transferida para o repositório); nullptr ou uma
+     *        exceção marcam a entrada como falha, sem interromper as demais
+     * @param costModel Modelo de custo usado pelos indexadores; deve sobreviver ao repositório
+     * @param pool Threads usadas na indexação
+     * @param progress Função de progresso opcional
+     * @return Repositório imutável com uma entrada por árvore, na ordem de entrada
+     */
+    template<class Parse>
+    static std::shared_ptr<const IndexStore> build(size_t count, Parse parseTree,
+                                                   const CostModel<Data>* costModel,
+                                                   ThreadPool &pool,
+                                                   Progress progress = Progress()) {
+        std::shared_ptr<IndexStore> store(new IndexStore(count));
+        std::mutex progressMutex;
+        size_t done = 0;
+
+        pool.parallelFor(count, [&](size_t i) {
+            Entry &entry = store->entries[i];
+            try {
+                entry.tree.reset(parseTree(i));
+                if (entry.tree == nullptr) {
+                    entry.error = "tree could not be parsed";
+                } else {
+                    entry.indexer.reset(new NodeIndexer<Data, Index>(entry.tree.get(), costModel));
+                }
+            } catch (const std::exception &e) {
+                entry.indexer.reset();
+                entry.tree.reset();
+                entry.error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(progressMutex);
+            if (entry.indexer == nullptr) {
+                store->failures++;
+            }
+            done++;
+            if (progress) {
+                progress(done, count);
+            }
+        });
+
+        return store;
+    }
+
+    /**
+     * @brief Lê e indexa árvores em notação de chaves em paralelo
+     *
+     * @param inputs Árvores em notação de chaves; devem sobreviver à chamada
+     * @param costModel Modelo de custo usado pelos indexadores
+     * @param pool Threads usadas na indexação
+     * @param progress Função de progresso opcional
+     * @return Repositório imutável com uma entrada por string
+     */
+    static std::shared_ptr<const IndexStore> buildFromBracketStrings(const std::vector<std::string> &inputs,
+                                                                     const CostModel<Data>* costModel,
+                                                                     ThreadPool &pool,
+                                                                     Progress progress = Progress()) {
+        return build(inputs.size(), [&inputs](size_t i) {
+            BracketStringInputParser parser(inputs[i]);
+            return parser.getRoot();
+        }, costModel, pool, progress);
+    }
+
+    /**
+     * @brief Obtém a quantidade de entradas
+     */
+    size_t size() const {
+        return entries.size();
+    }
+
+    /**
+     * @brief Obtém a quantidade de entradas que falharam
+     */
+    size_t numFailures() const {
+        return failures;
+    }
+
+    /**
+     * @brief Verifica se a i-ésima entrada falhou
+     */
+    bool failed(size_t i) const {
+        return entries[i].indexer == nullptr;
+    }
+
+    /**
+     * @brief Obtém a mensagem de erro da i-ésima entrada, vazia se não falhou
+     */
+    const std::string &error(size_t i) const {
+        return entries[i].error;
+    }
+
+    /**
+     * @brief Obtém a árvore da i-ésima entrada, ou nullptr se falhou
+     */
+    const Node<Data>* tree(size_t i) const {
+        return entries[i].tree.get();
+    }
+
+    /**
+     * @brief Obtém o indexador da i-ésima entrada, ou nullptr se falhou
+     */
+    const NodeIndexer<Data, Index>* index(size_t i) const {
+        return entries[i].indexer.get();
+    }
+
+    /**
+     * @brief Obtém a memória ocupada pelos indexadores
+     * @return Quantidade de bytes
+     */
+    size_t sizeInBytes() const {
+        size_t bytes = 0;
+        for (const Entry &entry : entries) {
+            if (entry.indexer != nullptr) {
+                bytes += entry.indexer->sizeInBytes();
+            }
+        }
+        return bytes;
+    }
+};
+
+} // namespace capted
@@ -131,6 +131,7 @@ public:
                 assert(!replacement->parent);
                 *iter = replacement;
                 replacement->parent = this;
+                child->parent = nullptr;
                 madeChange = true;
             }
 
@@ -203,9 +204,9 @@ public:
     /**
      * @brief Obtém a lista de filhos do nó (versão constante)
      * 
-     * @return std::list<Node<Data>*> Lista de filhos
+     * @return const std::list<Node<Data>*>& Referência constante para a lista de filhos
      */
-    std::list<Node<Data>*> getChildren() const {
+    const std::list<Node<Data>*> &getChildren() const {
         return children;
     }
 
@@ -34,9 +34,26 @@
  */
 
 #include <vector>
+#include <list>
+#include <algorithm>
+#include <memory>
+#include <utility>
 #include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "../util/debug.h"
 #include "../util/int.h"
+#include "../util/IndexArray.h"
 
 namespace capted {
 
@@ -44,93 +61,284 @@ namespace capted {
 // Node Indexer
 //------------------------------------------------------------------------------
 
-template <class NodeData>
+/**
+ * @brief Obtém o maior tamanho de árvore que pode ser indexado com a largura Index.
+ *        O limite vem dos somatórios quadráticos (preL_to_desc_sum chega a
+ *        (n + 1)(n + 4) / 2), que precisam caber em Index.
+ *
+ * @tparam Index Tipo inteiro com sinal usado nos índices
+ * @return int64_t Quantidade máxima de nós
+ */
+template<class Index>
+inline int64_t maxIndexedTreeSize() {
+    const __int128 limit = std::numeric_limits<Index>::max();
+    int64_t lo = 1;
+    int64_t hi = std::numeric_limits<Index>::max();
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo + 1) / 2;
+        if ((__int128)(mid + 1) * (mid + 4) / 2 <= limit) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+template <class NodeData, class Index>
 class AllPossibleMappings;
 
-template <class NodeData>
+template <class NodeData, class Index, class Matrix, class Instrumentation>
 class Apted;
 
-template<class Data>
+template<class Data, class Index = Integer>
 class NodeIndexer {
 private:
     typedef Node<Data> N;
 
-    friend AllPossibleMappings<Data>;
-    friend Apted<Data>;
+    friend AllPossibleMappings<Data, Index>;
+    template<class, class, class, class> friend class Apted;
+
+    /**
+     * @brief Campos lidos juntos nos laços das spfs (sizes, parents,
+     *        preL_to_preR, preL_to_postL), intercalados por nó em pré-ordem
+     */
+    static const size_t HOT_FIELDS = 4;
 
     const CostModel<Data>* costModel; /**< Modelo de custo para operações de edição de árvore */
-    const Integer treeSize; /**< Tamanho da árvore */
+    Index treeSize; /**< Tamanho da árvore */
+    Index capacity; /**< Nós que cabem no buffer; passa de treeSize após edições locais que aumentam a árvore */
+
+    // Alocação única com todos os arrays abaixo, na ordem:
+    // nós | campos intercalados | arrays de Index | filhos (CSR) | custos | tipos de nó
+    std::vector<uint64_t> storage;
 
     // Índices de estrutura
-    std::vector<Integer> sizes;
-    std::vector<Integer> parents;
-    std::vector<std::vector<Integer>> children;
+    IndexArray<Index, HOT_FIELDS> sizes;
+    IndexArray<Index, HOT_FIELDS> parents;
+    ChildLists<Index> children;
+    Index* childOffsets; /**< treeSize + 1 posições em childTargets */
+    Index* childTargets; /**< Filhos de cada nó, da esquerda para a direita */
 
-    std::vector<Integer> postL_to_lld;
-    std::vector<Integer> postR_to_rld;
-    std::vector<Integer> preL_to_ln;
-    std::vector<Integer> preR_to_ln;
+    IndexArray<Index> postL_to_lld;
+    IndexArray<Index> postR_to_rld;
+    IndexArray<Index> preL_to_ln;
+    IndexArray<Index> preR_to_ln;
 
-    std::vector<N*> preL_to_node;
-    std::vector<bool> nodeType_L;
-    std::vector<bool> nodeType_R;
+    IndexArray<N*> preL_to_node;
+    IndexArray<uint8_t> nodeType_L;
+    IndexArray<uint8_t> nodeType_R;
 
     // Índices de tradução de travessia
-    std::vector<Integer> preL_to_preR;
-    std::vector<Integer> preR_to_preL;
-    std::vector<Integer> preL_to_postL;
-    std::vector<Integer> preL_to_postR;
-    std::vector<Integer> postL_to_preL;
-    std::vector<Integer> postR_to_preL;
+    IndexArray<Index, HOT_FIELDS> preL_to_preR;
+    IndexArray<Index> preR_to_preL;
+    IndexArray<Index, HOT_FIELDS> preL_to_postL;
+    IndexArray<Index> preL_to_postR;
+    IndexArray<Index> postL_to_preL;
+    IndexArray<Index> postR_to_preL;
 
     // Índices de custo
-    std::vector<Integer> preL_to_kr_sum;
-    std::vector<Integer> preL_to_rev_kr_sum;
-    std::vector<Integer> preL_to_desc_sum;
-    std::vector<float> preL_to_sumDelCost;
-    std::vector<float> preL_to_sumInsCost;
+    IndexArray<Index> preL_to_kr_sum;
+    IndexArray<Index> preL_to_rev_kr_sum;
+    IndexArray<Index> preL_to_desc_sum;
+    IndexArray<float> preL_to_sumDelCost;
+    IndexArray<float> preL_to_sumInsCost;
 
     // Variáveis temporárias
-    Integer currentNode;
-    Integer lchl;
-    Integer rchl;
-    Integer sizeTmp;
-    Integer descSizesTmp;
-    Integer krSizesSumTmp;
-    Integer revkrSizesSumTmp;
-    Integer preorderTmp;
+    Index lchl;
+    Index rchl;
+    Index sizeTmp;
+    Index descSizesTmp;
+    Index krSizesSumTmp;
+    Index revkrSizesSumTmp;
+    Index preorderTmp;
+
+    /**
+     * @brief Posições, em bytes, de cada parte do buffer único
+     */
+    struct Layout {
+        size_t nodesAt;
+        size_t hotAt;
+        size_t coldAt;
+        size_t offsetsAt;
+        size_t targetsAt;
+        size_t costsAt;
+        size_t flagsAt;
+        size_t end;   /**< Fim dos dados */
+        size_t words; /**< Tamanho do buffer em palavras de 64 bits */
+    };
+
+    /**
+     * @brief Calcula a disposição do buffer único para uma árvore de n nós
+     * @param n Quantidade de nós
+     * @return Layout Posição de cada parte
+     */
+    static Layout layout(size_t n) {
+        const size_t coldArrays = 11;
+        size_t offset = 0;
+        auto reserve = [&offset](size_t bytes, size_t align) {
+            offset = (offset + align - 1) / align * align;
+            size_t at = offset;
+            offset += bytes;
+            return at;
+        };
+
+        Layout l;
+        l.nodesAt = reserve(n * sizeof(N*), alignof(N*));
+        l.hotAt = reserve(HOT_FIELDS * n * sizeof(Index), alignof(Index));
+        l.coldAt = reserve(coldArrays * n * sizeof(Index), alignof(Index));
+        l.offsetsAt = reserve((n + 1) * sizeof(Index), alignof(Index));
+        l.targetsAt = reserve((n > 0 ? n - 1 : 0) * sizeof(Index), alignof(Index));
+        l.costsAt = reserve(2 * n * sizeof(float), alignof(float));
+        l.flagsAt = reserve(2 * n, 1);
+        l.end = offset;
+        l.words = (offset + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        return l;
+    }
+
+    /**
+     * @brief Lista as partes do buffer com dados de uma árvore de n nós disposta
+     *        para c nós: a posição em bytes e o tamanho de cada array. Cada array
+     *        usa só o início da sua parte, então as partes são as mesmas para
+     *        qualquer c >= n, e com c == n formam a disposição compacta do cache.
+     *
+     * @param n Quantidade de nós da árvore
+     * @param c Quantidade de nós para a qual o buffer foi disposto
+     * @return Pares (posição, bytes), na ordem do buffer; o primeiro é preL_to_node
+     */
+    static std::vector<std::pair<size_t, size_t>> pieces(size_t n, size_t c) {
+        const Layout l = layout(c);
+        std::vector<std::pair<size_t, size_t>> result;
+        result.emplace_back(l.nodesAt, n * sizeof(N*));
+        result.emplace_back(l.hotAt, HOT_FIELDS * n * sizeof(Index));
+        for (size_t k = 0; k < 11; k++) {
+            result.emplace_back(l.coldAt + k * c * sizeof(Index), n * sizeof(Index));
+        }
+        result.emplace_back(l.offsetsAt, (n + 1) * sizeof(Index));
+        result.emplace_back(l.targetsAt, (n > 0 ? n - 1 : 0) * sizeof(Index));
+        result.emplace_back(l.costsAt, n * sizeof(float));
+        result.emplace_back(l.costsAt + c * sizeof(float), n * sizeof(float));
+        result.emplace_back(l.flagsAt, n);
+        result.emplace_back(l.flagsAt + c, n);
+        return result;
+    }
+
+    /**
+     * @brief Aloca o buffer único, zerado e do tamanho exato da árvore, e aponta
+     *        cada array para a sua parte
+     */
+    void allocate() {
+        capacity = treeSize;
+        storage.assign(layout(capacity).words, 0);
+        bindArrays();
+    }
+
+    /**
+     * @brief Aponta cada array para a sua parte do buffer, disposto para capacity
+     *        nós, com os treeSize primeiros elementos em uso
+     */
+    void bindArrays() {
+        const size_t n = treeSize;
+        const size_t c = capacity;
+        const Layout l = layout(c);
+
+        char* base = reinterpret_cast<char*>(storage.data());
+        Index* hot = reinterpret_cast<Index*>(base + l.hotAt);
+        Index* cold = reinterpret_cast<Index*>(base + l.coldAt);
+        float* costs = reinterpret_cast<float*>(base + l.costsAt);
+        uint8_t* flags = reinterpret_cast<uint8_t*>(base + l.flagsAt);
+
+        preL_to_node = IndexArray<N*>(reinterpret_cast<N**>(base + l.nodesAt), n);
+
+        sizes = IndexArray<Index, HOT_FIELDS>(hot + 0, n);
+        parents = IndexArray<Index, HOT_FIELDS>(hot + 1, n);
+        preL_to_preR = IndexArray<Index, HOT_FIELDS>(hot + 2, n);
+        preL_to_postL = IndexArray<Index, HOT_FIELDS>(hot + 3, n);
+
+        postL_to_lld = IndexArray<Index>(cold + 0 * c, n);
+        postR_to_rld = IndexArray<Index>(cold + 1 * c, n);
+        preL_to_ln = IndexArray<Index>(cold + 2 * c, n);
+        preR_to_ln = IndexArray<Index>(cold + 3 * c, n);
+        preR_to_preL = IndexArray<Index>(cold + 4 * c, n);
+        preL_to_postR = IndexArray<Index>(cold + 5 * c, n);
+        postL_to_preL = IndexArray<Index>(cold + 6 * c, n);
+        postR_to_preL = IndexArray<Index>(cold + 7 * c, n);
+        preL_to_kr_sum = IndexArray<Index>(cold + 8 * c, n);
+        preL_to_rev_kr_sum = IndexArray<Index>(cold + 9 * c, n);
+        preL_to_desc_sum = IndexArray<Index>(cold + 10 * c, n);
+
+        childOffsets = reinterpret_cast<Index*>(base + l.offsetsAt);
+        childTargets = reinterpret_cast<Index*>(base + l.targetsAt);
+        children = ChildLists<Index>(childOffsets, childTargets, n);
+
+        preL_to_sumDelCost = IndexArray<float>(costs, n);
+        preL_to_sumInsCost = IndexArray<float>(costs + c, n);
+        nodeType_L = IndexArray<uint8_t>(flags, n);
+        nodeType_R = IndexArray<uint8_t>(flags + c, n);
+    }
+
+    /**
+     * @brief Move os arrays para um buffer disposto para newCapacity nós
+     * @param newCapacity Nova capacidade, pelo menos treeSize
+     */
+    void relayout(Index newCapacity) {
+        std::vector<uint64_t> moved(layout(newCapacity).words, 0);
+        const char* from = reinterpret_cast<const char*>(storage.data());
+        char* to = reinterpret_cast<char*>(moved.data());
+        auto source = pieces(treeSize, capacity);
+        auto target = pieces(treeSize, newCapacity);
+        for (size_t k = 0; k < source.size(); k++) {
+            std::memcpy(to + target[k].first, from + source[k].first, source[k].second);
+        }
+        storage.swap(moved);
+        capacity = newCapacity;
+        bindArrays();
+    }
+
+    /**
+     * @brief Inicializa as variáveis temporárias e aloca os arrays
+     */
+    void initialize() {
+        lchl = 0;
+        rchl = 0;
+        sizeTmp = 0;
+        descSizesTmp = 0;
+        krSizesSumTmp = 0;
+        revkrSizesSumTmp = 0;
+        preorderTmp = 0;
+        allocate();
+    }
 
     /**
      * @brief Indexa os nós da árvore em pré-ordem e pós-ordem
      * 
      * @param node Nó atual
      * @param postorder Índice em pós-ordem
-     * @return Integer Novo índice em pós-ordem
+     * @return Index Novo índice em pós-ordem
      */
-    Integer indexNodes(N* node, Integer postorder) {
+    Index indexNodes(N* node, Index postorder) {
         // Inicializa variáveis.
-        Integer currentSize = 0;
-        Integer childrenCount = 0;
-        Integer descSizes = 0;
-        Integer krSizesSum = 0;
-        Integer revkrSizesSum = 0;
-        Integer preorder = preorderTmp;
-        Integer preorderR = 0;
-        Integer currentPreorder = -1;
+        Index currentSize = 0;
+        Index childrenCount = 0;
+        Index descSizes = 0;
+        Index krSizesSum = 0;
+        Index revkrSizesSum = 0;
+        Index preorder = preorderTmp;
+        Index preorderR = 0;
+        Index currentPreorder = -1;
 
         // Armazena o ID de pré-ordem do nó atual para usar após a recursão.
         preorderTmp++;
 
-        // Loop sobre os filhos de um nó.
-        std::vector<N*> childNodes = node->getChildrenAsVector();
-        for (size_t i = 0; i < childNodes.size(); i++) {
+        // Loop sobre os filhos de um nó. Os filhos em CSR são montados depois, a partir de parents.
+        std::list<N*> &childNodes = node->getChildren();
+        for (auto child = childNodes.begin(); child != childNodes.end(); ++child) {
             childrenCount++;
             currentPreorder = preorderTmp;
             parents[currentPreorder] = preorder;
 
             // Executa o método recursivamente para o próximo filho.
-            postorder = indexNodes(childNodes[i], postorder);
-            children[preorder].push_back(currentPreorder);
+            postorder = indexNodes(*child, postorder);
 
             currentSize += 1 + sizeTmp;
             descSizes += descSizesTmp;
@@ -139,28 +347,25 @@ private:
                 krSizesSum += krSizesSumTmp + sizeTmp + 1;
             } else {
                 krSizesSum += krSizesSumTmp;
-                nodeType_L[currentPreorder] = true;
+                nodeType_L[currentPreorder] = 1;
             }
 
-            if (i < childNodes.size() - 1) {
+            if (std::next(child) != childNodes.end()) {
                 revkrSizesSum += revkrSizesSumTmp + sizeTmp + 1;
             } else {
                 revkrSizesSum += revkrSizesSumTmp;
-                nodeType_R[currentPreorder] = true;
+                nodeType_R[currentPreorder] = 1;
             }
         }
 
         postorder++;
 
-        Integer currentDescSizes = descSizes + currentSize + 1;
+        Index currentDescSizes = descSizes + currentSize + 1;
 
-        Integer temp_mul = (currentSize + 1) * (currentSize + 1 + 3);
-        if (__builtin_mul_overflow((currentSize + 1), (currentSize + 1 + 3), &temp_mul)) {
-            printf("Overflow in %s::%d\n", __FILE__, __LINE__);
-            exit(1);
-        }
+        // Não transborda: o construtor já garantiu treeSize <= maxIndexedTreeSize<Index>().
+        int64_t temp_mul = (int64_t)(currentSize + 1) * (currentSize + 1 + 3);
 
-        preL_to_desc_sum[preorder] = (temp_mul) / 2 - currentDescSizes;
+        preL_to_desc_sum[preorder] = temp_mul / 2 - currentDescSizes;
         preL_to_kr_sum[preorder] = krSizesSum + currentSize + 1;
         preL_to_rev_kr_sum[preorder] = revkrSizesSum + currentSize + 1;
 
@@ -189,26 +394,26 @@ private:
      * @brief Realiza a indexação pós-ordem na árvore
      */
     void postTraversalIndexing() {
-        Integer currentLeaf = -1;
-        Integer nodeForSum = -1;
-        Integer parentForSum = -1;
+        Index currentLeaf = -1;
+        Index nodeForSum = -1;
+        Index parentForSum = -1;
 
-        for (Integer i = 0; i < treeSize; i++) {
+        for (Index i = 0; i < treeSize; i++) {
             preL_to_ln[i] = currentLeaf;
             if (isLeaf(i)) {
                 currentLeaf = i;
             }
 
             // Armazena os descendentes folha mais à esquerda para cada nó indexado em pós-ordem.
-            Integer postl = i; // Assume que o loop itera em pós-ordem.
-            Integer preorder = postL_to_preL[i];
+            Index postl = i; // Assume que o loop itera em pós-ordem.
+            Index preorder = postL_to_preL[i];
             if (sizes[preorder] == 1) {
                 postL_to_lld[postl] = postl;
             } else {
                 postL_to_lld[postl] = postL_to_lld[preL_to_postL[children[preorder][0]]];
             }
             // Armazena os descendentes folha mais à direita para cada nó indexado em pós-ordem reversa.
-            Integer postr = i; // Assume que o loop itera em pós-ordem reversa.
+            Index postr = i; // Assume que o loop itera em pós-ordem reversa.
             preorder = postR_to_preL[postr];
             if (sizes[preorder] == 1) {
                 postR_to_rld[postr] = postr;
@@ -217,7 +422,7 @@ private:
             }
             // Conta lchl e rchl.
             if (sizes[i] == 1) {
-                Integer parent = parents[i];
+                Index parent = parents[i];
                 if (parent > -1) {
                     if (parent + 1 == i) {
                         lchl++;
@@ -242,12 +447,490 @@ private:
 
         currentLeaf = -1;
         // Itera sobre os nós novamente para completar as listas de folhas.
-        for (Integer i = 0; i < sizes[0]; i++) {
+        for (Index i = 0; i < sizes[0]; i++) {
+            preR_to_ln[i] = currentLeaf;
+            if (isLeaf(preR_to_preL[i])) {
+                currentLeaf = i;
+            }
+        }
+    }
+
+    /**
+     * @brief Monta os filhos em CSR a partir de parents. Os filhos de p são os
+     *        nós com parents[i] == p, já em ordem crescente de pré-ordem.
+     */
+    void buildChildren() {
+        for (Index i = 1; i < treeSize; i++) {
+            childOffsets[parents[i] + 1]++;
+        }
+        for (Index i = 0; i < treeSize; i++) {
+            childOffsets[i + 1] += childOffsets[i];
+        }
+        // Usa childOffsets[p] como cursor de escrita; ao final ele aponta para o
+        // início do próximo nó, então os offsets são deslocados de volta.
+        for (Index i = 1; i < treeSize; i++) {
+            childTargets[childOffsets[parents[i]]++] = i;
+        }
+        for (Index i = treeSize - 1; i > 0; i--) {
+            childOffsets[i] = childOffsets[i - 1];
+        }
+        childOffsets[0] = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // Manutenção incremental
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Soma em lchl e rchl a contribuição do nó i (folha que é filho
+     *        mais à esquerda ou mais à direita), com o sinal dado
+     */
+    void countLeafChild(Index i, Index sign) {
+        if (sizes[i] != 1 || parents[i] < 0) {
+            return;
+        }
+        Index parent = parents[i];
+        if (parent + 1 == i) {
+            lchl += sign;
+        } else if (preL_to_preR[parent] + 1 == preL_to_preR[i]) {
+            rchl += sign;
+        }
+    }
+
+    /**
+     * @brief Soma em lchl e rchl as contribuições dos nós cuja condição de folha
+     *        ou de primeiro/último filho pode mudar com uma edição sob parent:
+     *        parent, seus filhos e os nós internos da subárvore [q + 1, q + m)
+     */
+    void countAffectedLeafChildren(Index parent, Index q, Index m, Index sign) {
+        countLeafChild(parent, sign);
+        for (Index child : children[parent]) {
+            countLeafChild(child, sign);
+        }
+        for (Index i = q + 1; i < q + m; i++) {
+            countLeafChild(i, sign);
+        }
+    }
+
+    /**
+     * @brief Recalcula os índices agregados de um nó a partir dos filhos, na
+     *        mesma ordem de soma usada por indexNodes e postTraversalIndexing
+     * @param preL Nó em pré-ordem cujos filhos já estão atualizados
+     */
+    void refreshAggregates(Index preL) {
+        ChildRange<Index> kids = children[preL];
+        int64_t size = 1;
+        int64_t descSizes = 0;
+        int64_t krSum = 0;
+        int64_t revKrSum = 0;
+        for (Index child : kids) {
+            int64_t childSize = sizes[child];
+            size += childSize;
+            descSizes += childSize * (childSize + 3) / 2 - preL_to_desc_sum[child];
+            krSum += preL_to_kr_sum[child];
+            revKrSum += preL_to_rev_kr_sum[child];
+        }
+        if (!kids.empty()) {
+            krSum -= sizes[kids[0]];
+            revKrSum -= sizes[kids[kids.size() - 1]];
+        }
+
+        sizes[preL] = size;
+        preL_to_desc_sum[preL] = size * (size + 3) / 2 - (descSizes + size);
+        preL_to_kr_sum[preL] = krSum + size;
+        preL_to_rev_kr_sum[preL] = revKrSum + size;
+
+        float sumDel = 0;
+        float sumIns = 0;
+        for (Index k = (Index)kids.size() - 1; k >= 0; k--) {
+            sumDel += preL_to_sumDelCost[kids[k]];
+            sumIns += preL_to_sumInsCost[kids[k]];
+        }
+        preL_to_sumDelCost[preL] = sumDel + costModel->deleteCost(preL_to_node[preL]);
+        preL_to_sumInsCost[preL] = sumIns + costModel->insertCost(preL_to_node[preL]);
+    }
+
+    /**
+     * @brief Move count elementos de um array de passo stride, da posição from
+     *        para a posição to (as faixas podem se sobrepor)
+     */
+    template<class T>
+    static void shift(T* data, Index from, Index to, Index count, size_t stride = 1) {
+        if (count > 0 && from != to) {
+            std::memmove(data + to * stride, data + from * stride, count * stride * sizeof(T));
+        }
+    }
+
+    /**
+     * @brief Atualiza os filhos em CSR para a edição de splice: só mudam a lista
+     *        de parent (perde ou ganha a raiz da região), os números dos filhos
+     *        dos ancestrais que vêm após a região e as listas a partir da região,
+     *        que são deslocadas. Usa os offsets anteriores à edição.
+     *
+     * @param parent Pai da região editada, em pré-ordem
+     * @param q Início da região em pré-ordem
+     * @param removed Quantidade de nós removidos
+     * @param inserted Índice da subárvore inserida, ou nullptr
+     * @param ancestors parent e os seus ancestrais
+     */
+    void spliceChildren(Index parent, Index q, Index removed, const NodeIndexer* inserted,
+                        const std::vector<Index> &ancestors) {
+        const Index n = treeSize;
+        const Index m = inserted != nullptr ? inserted->treeSize : 0;
+        const Index d = m - removed;
+        // Arestas de parent para a região: +1 ao inserir, -1 ao remover, 0 ao substituir.
+        const Index e = (m > 0 ? 1 : 0) - (removed > 0 ? 1 : 0);
+        const Index insertedEdges = m > 0 ? m - 1 : 0;
+
+        for (Index a : ancestors) {
+            for (Index k = childOffsets[a]; k < childOffsets[a + 1]; k++) {
+                if (childTargets[k] >= q + removed) {
+                    childTargets[k] += d;
+                }
+            }
+        }
+
+        // Posição da raiz da região na lista de parent.
+        Index at = childOffsets[parent];
+        while (at < childOffsets[parent + 1] && childTargets[at] < q) {
+            at++;
+        }
+
+        // Listas dos nós antes da região | arestas internas da região | listas dos nós após a região
+        const Index prefixEnd = childOffsets[q];
+        const Index suffixFrom = childOffsets[q + removed];
+        const Index suffixCount = (n - 1) - suffixFrom;
+        const Index suffixTo = prefixEnd + e + insertedEdges;
+        const Index middleFrom = removed > 0 ? at + 1 : at;
+        if (e > 0) {
+            shift(childTargets, suffixFrom, suffixTo, suffixCount);
+            shift(childTargets, middleFrom, middleFrom + e, prefixEnd - middleFrom);
+        } else {
+            shift(childTargets, middleFrom, middleFrom + e, prefixEnd - middleFrom);
+            shift(childTargets, suffixFrom, suffixTo, suffixCount);
+        }
+        if (removed == 0) {
+            childTargets[at] = q;
+        }
+        for (Index k = suffixTo; k < suffixTo + suffixCount; k++) {
+            childTargets[k] += d;
+        }
+        for (Index k = 0; k < insertedEdges; k++) {
+            childTargets[prefixEnd + e + k] = inserted->childTargets[k] + q;
+        }
+
+        shift(childOffsets, q + removed + 1, q + m + 1, n - q - removed);
+        for (Index p = q + m + 1; p <= n + d; p++) {
+            childOffsets[p] += suffixTo - suffixFrom;
+        }
+        for (Index p = parent + 1; p <= q; p++) {
+            childOffsets[p] += e;
+        }
+        for (Index k = 1; k <= m; k++) {
+            childOffsets[q + k] = prefixEnd + e + inserted->childOffsets[k];
+        }
+    }
+
+    /**
+     * @brief Substitui os nós [q, q + removed) em pré-ordem, todos sob parent,
+     *        pelos nós de inserted, no próprio buffer. Em cada ordem de travessia
+     *        a região é contígua: os nós antes dela não mudam de posição, e os
+     *        nós depois dela são deslocados com memmove e têm somados d = m -
+     *        removed aos índices que apontam para depois da região. Recalcula
+     *        apenas a cadeia de ancestrais de parent e, a partir da região, os
+     *        índices de folhas de cada ordem.
+     *
+     * @param parent Pai da região editada, em pré-ordem
+     * @param q Início da região em pré-ordem
+     * @param removed Quantidade de nós removidos (uma subárvore inteira, ou 0)
+     * @param inserted Índice da subárvore inserida na posição q, ou nullptr
+     */
+    void splice(Index parent, Index q, Index removed, const NodeIndexer* inserted) {
+        const Index n = treeSize;
+        const Index m = inserted != nullptr ? inserted->treeSize : 0;
+        const Index d = m - removed;
+        const Index nNew = n + d;
+        // Primeira posição em pós-ordem da região: descendentes de parent que terminam antes dela.
+        const Index r = preL_to_postL[parent] - sizes[parent] + q - parent;
+        // Início da região na pré-ordem reversa e na pós-ordem reversa.
+        const Index preRAt = n - r - removed;
+        const Index postRAt = n - q - removed;
+
+        std::vector<Index> ancestors;
+        for (Index a = parent; a >= 0; a = parents[a]) {
+            ancestors.push_back(a);
+        }
+
+        countAffectedLeafChildren(parent, q, removed, -1);
+        if (nNew > capacity) {
+            // Folga para as próximas inserções, como no crescimento de um vector.
+            relayout(nNew + nNew / 8);
+        }
+        spliceChildren(parent, q, removed, inserted, ancestors);
+        treeSize = nNew;
+        bindArrays();
+
+        // Arrays em pré-ordem: os nós após a região mudam de posição.
+        const Index tail = n - q - removed;
+        shift(&sizes[0], q + removed, q + m, tail, HOT_FIELDS);
+        shift(&preL_to_node[0], q + removed, q + m, tail);
+        shift(&preL_to_postR[0], q + removed, q + m, tail);
+        shift(&preL_to_kr_sum[0], q + removed, q + m, tail);
+        shift(&preL_to_rev_kr_sum[0], q + removed, q + m, tail);
+        shift(&preL_to_desc_sum[0], q + removed, q + m, tail);
+        shift(&preL_to_sumDelCost[0], q + removed, q + m, tail);
+        shift(&preL_to_sumInsCost[0], q + removed, q + m, tail);
+        shift(&nodeType_L[0], q + removed, q + m, tail);
+        shift(&nodeType_R[0], q + removed, q + m, tail);
+        for (Index i = q + m; i < nNew; i++) {
+            if (parents[i] >= q) {
+                parents[i] += d;
+            }
+            preL_to_postL[i] += d;
+        }
+        // Antes da região, só os ancestrais terminam depois dela em pós-ordem;
+        // os demais vêm depois dela nas ordens reversas.
+        for (Index i = 0; i < q; i++) {
+            preL_to_preR[i] += d;
+            preL_to_postR[i] += d;
+        }
+        for (Index a : ancestors) {
+            preL_to_preR[a] -= d;
+            preL_to_postL[a] += d;
+        }
+        for (Index k = 0; k < m; k++) {
+            Index i = q + k;
+            preL_to_node[i] = inserted->preL_to_node[k];
+            parents[i] = k == 0 ? parent : inserted->parents[k] + q;
+            sizes[i] = inserted->sizes[k];
+            preL_to_postL[i] = inserted->preL_to_postL[k] + r;
+            preL_to_preR[i] = inserted->preL_to_preR[k] + preRAt;
+            preL_to_postR[i] = nNew - 1 - i;
+            preL_to_desc_sum[i] = inserted->preL_to_desc_sum[k];
+            preL_to_kr_sum[i] = inserted->preL_to_kr_sum[k];
+            preL_to_rev_kr_sum[i] = inserted->preL_to_rev_kr_sum[k];
+            preL_to_sumDelCost[i] = inserted->preL_to_sumDelCost[k];
+            preL_to_sumInsCost[i] = inserted->preL_to_sumInsCost[k];
+            nodeType_L[i] = inserted->nodeType_L[k];
+            nodeType_R[i] = inserted->nodeType_R[k];
+        }
+
+        // Pós-ordem: a região começa em r.
+        shift(&postL_to_preL[0], r + removed, r + m, n - r - removed);
+        for (Index j = r + m; j < nNew; j++) {
+            if (postL_to_preL[j] >= q) {
+                postL_to_preL[j] += d;
+            }
+        }
+        for (Index k = 0; k < m; k++) {
+            postL_to_preL[r + k] = inserted->postL_to_preL[k] + q;
+        }
+
+        // Pré-ordem reversa: antes da região ficam os nós após ela em pré-ordem e os ancestrais.
+        shift(&preR_to_preL[0], n - r, nNew - r, r);
+        for (Index j = 0; j < preRAt; j++) {
+            if (preR_to_preL[j] >= q) {
+                preR_to_preL[j] += d;
+            }
+        }
+        for (Index k = 0; k < m; k++) {
+            preR_to_preL[preRAt + k] = inserted->preR_to_preL[k] + q;
+        }
+
+        // Pós-ordem reversa: a posição j é o nó nNew - 1 - j em pré-ordem.
+        shift(&postR_to_preL[0], n - q, nNew - q, q);
+        for (Index j = 0; j < postRAt; j++) {
+            postR_to_preL[j] += d;
+        }
+        for (Index k = 0; k < m; k++) {
+            postR_to_preL[postRAt + k] = q + m - 1 - k;
+        }
+
+        // Apenas os filhos de parent mudam de primeiro/último filho.
+        ChildRange<Index> siblings = children[parent];
+        const Index numSiblings = siblings.size();
+        for (Index k = 0; k < numSiblings; k++) {
+            nodeType_L[siblings[k]] = k == 0;
+            nodeType_R[siblings[k]] = k == numSiblings - 1;
+        }
+        for (Index a : ancestors) {
+            refreshAggregates(a);
+        }
+
+        // Descendentes folha e listas de folhas: em cada ordem, só mudam a
+        // partir da região (os ancestrais vêm depois dela em pós-ordem).
+        for (Index postL = r; postL < nNew; postL++) {
+            Index preorder = postL_to_preL[postL];
+            postL_to_lld[postL] = sizes[preorder] == 1
+                ? postL : postL_to_lld[preL_to_postL[preorder + 1]];
+        }
+        for (Index postR = postRAt; postR < nNew; postR++) {
+            Index preorder = postR_to_preL[postR];
+            ChildRange<Index> kids = children[preorder];
+            postR_to_rld[postR] = sizes[preorder] == 1
+                ? postR : postR_to_rld[preL_to_postR[kids[kids.size() - 1]]];
+        }
+        Index currentLeaf = isLeaf(q - 1) ? q - 1 : preL_to_ln[q - 1];
+        for (Index i = q; i < nNew; i++) {
+            preL_to_ln[i] = currentLeaf;
+            if (isLeaf(i)) {
+                currentLeaf = i;
+            }
+        }
+        currentLeaf = isLeaf(preR_to_preL[preRAt - 1]) ? preRAt - 1 : preR_to_ln[preRAt - 1];
+        for (Index i = preRAt; i < nNew; i++) {
             preR_to_ln[i] = currentLeaf;
             if (isLeaf(preR_to_preL[i])) {
                 currentLeaf = i;
             }
         }
+
+        countAffectedLeafChildren(parent, q, m, 1);
+    }
+
+    /**
+     * @brief Encontra a pré-ordem de um nó da árvore indexada descendo a partir
+     *        da raiz e somando os tamanhos dos irmãos à esquerda em cada nível
+     * @param node Nó da árvore indexada
+     * @return Index Índice em pré-ordem
+     */
+    Index findPreL(N* node) const {
+        std::vector<N*> path;
+        for (N* current = node; current != nullptr; current = current->getParent()) {
+            path.push_back(current);
+        }
+        if (path.back() != preL_to_node[0]) {
+            throw std::invalid_argument("NodeIndexer: o nó não pertence à árvore indexada");
+        }
+
+        Index preL = 0;
+        for (size_t level = path.size() - 1; level > 0; level--) {
+            N* target = path[level - 1];
+            Index child = preL + 1;
+            for (N* sibling : path[level]->getChildren()) {
+                if (sibling == target) {
+                    break;
+                }
+                child += sizes[child];
+            }
+            preL = child;
+        }
+        assert(preL_to_node[preL] == node);
+        return preL;
+    }
+
+    /**
+     * @brief Indexa uma subárvore ainda solta e confere se a árvore editada
+     *        continuará cabendo na largura Index
+     * @param subtree Raiz da subárvore a ser inserida
+     * @param removed Quantidade de nós removidos pela mesma edição
+     * @return NodeIndexer* Índice da subárvore (posse do chamador)
+     */
+    NodeIndexer* indexSubtree(N* subtree, Index removed) const {
+        int64_t size = (int64_t)treeSize - removed + subtree->getNodeCount();
+        if (size > maxIndexedTreeSize<Index>()) {
+            throw std::overflow_error("NodeIndexer: árvore editada com " + std::to_string(size) +
+                                      " nós excede o limite de " + std::to_string(maxIndexedTreeSize<Index>()) +
+                                      " para índices de " + std::to_string(8 * sizeof(Index)) + " bits");
+        }
+        return new NodeIndexer(subtree, costModel);
+    }
+
+    //-------------------------------------------------------------------------
+    // Cache persistido em disco
+    //-------------------------------------------------------------------------
+
+    static constexpr uint32_t CACHE_VERSION = 3;
+
+    /**
+     * @brief Cabeçalho do arquivo de cache. O restante do arquivo é a parte do
+     *        buffer único após preL_to_node, copiada byte a byte. treeHash
+     *        identifica a árvore indexada (formato e rótulos, veja treeHash()).
+     */
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t integerBytes;
+        int64_t treeSize;
+        int64_t lchl;
+        int64_t rchl;
+        uint64_t costModelId;
+        uint64_t treeHash;
+    };
+
+    static uint64_t mixHash(uint64_t h, uint64_t v) {
+        // Combinação no estilo boost::hash_combine com constantes de 64 bits.
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+        return h * 0xff51afd7ed558ccdULL;
+    }
+
+    /**
+     * @brief Acrescenta um nó da pré-ordem ao hash da árvore: a quantidade de
+     *        filhos de cada nó em pré-ordem determina o formato, e o rótulo
+     *        entra por hashNodeData (encontrada por ADL no namespace de Data)
+     */
+    static uint64_t hashNode(uint64_t h, N* node) {
+        h = mixHash(h, node->getChildren().size());
+        return mixHash(h, hashNodeData(*node->getData()));
+    }
+
+    /**
+     * @brief Construtor usado pelo carregamento do cache. Apenas aloca o buffer,
+     *        que é preenchido por quem chamou.
+     *
+     * @param treeSize Tamanho da árvore lido do cabeçalho
+     * @param costModel Modelo de custo
+     */
+    NodeIndexer(Index treeSize, const CostModel<Data>* costModel)
+        : costModel(costModel), treeSize(treeSize) {
+        initialize();
+    }
+
+    /**
+     * @brief Preenche preL_to_node percorrendo a árvore em pré-ordem sem recursão
+     *
+     * @param inputTree Árvore correspondente ao índice
+     * @param expectedHash treeHash da árvore indexada originalmente
+     * @return true Se a árvore tem exatamente treeSize nós e o mesmo formato e rótulos
+     */
+    bool attachNodes(N* inputTree, uint64_t expectedHash) {
+        std::vector<N*> stack(1, inputTree);
+        Index preorder = 0;
+        uint64_t hash = 0;
+
+        while (!stack.empty()) {
+            N* node = stack.back();
+            stack.pop_back();
+
+            if (preorder >= treeSize) {
+                return false;
+            }
+            preL_to_node[preorder++] = node;
+            hash = hashNode(hash, node);
+
+            std::list<N*> &nodeChildren = node->getChildren();
+            for (auto it = nodeChildren.rbegin(); it != nodeChildren.rend(); it++) {
+                stack.push_back(*it);
+            }
+        }
+
+        return preorder == treeSize && hash == expectedHash;
+    }
+
+    /**
+     * @brief Conta os nós da árvore e confere se cabem na largura Index
+     *
+     * @param inputTree Árvore de entrada
+     * @return Index Tamanho da árvore
+     */
+    static Index checkedTreeSize(N* inputTree) {
+        int64_t size = inputTree->getNodeCount();
+        if (size > maxIndexedTreeSize<Index>()) {
+            throw std::overflow_error("NodeIndexer: árvore com " + std::to_string(size) +
+                                      " nós excede o limite de " + std::to_string(maxIndexedTreeSize<Index>()) +
+                                      " para índices de " + std::to_string(8 * sizeof(Index)) + " bits");
+        }
+        return (Index)size;
     }
 
 public:
@@ -256,75 +939,300 @@ public:
      * 
      * @param inputTree Árvore de entrada
      * @param costModel Modelo de custo
+     * @throw std::overflow_error Se a árvore é grande demais para a largura Index
      */
     NodeIndexer(N* inputTree, const CostModel<Data>* costModel)
-        : costModel(costModel), treeSize(inputTree->getNodeCount()) {
-        // Inicializa variáveis temporárias
-        currentNode = 0;
-        lchl = 0;
-        rchl = 0;
-        sizeTmp = 0;
-        descSizesTmp = 0;
-        krSizesSumTmp = 0;
-        revkrSizesSumTmp = 0;
-        preorderTmp = 0;
-
-        // Inicializa índices
-        sizes.resize(treeSize, 0);
-        children.resize(treeSize);
-        parents.resize(treeSize, 0);
+        : costModel(costModel), treeSize(checkedTreeSize(inputTree)) {
+        initialize();
         parents[0] = -1; // Raiz não tem pai
 
-        postL_to_lld.resize(treeSize, 0);
-        postR_to_rld.resize(treeSize, 0);
-        preL_to_ln.resize(treeSize, 0);
-        preR_to_ln.resize(treeSize, 0);
+        // Indexa
+        indexNodes(inputTree, -1);
+        buildChildren();
+        postTraversalIndexing();
+    }
 
-        preL_to_node.resize(treeSize, nullptr);
-        nodeType_L.resize(treeSize, false);
-        nodeType_R.resize(treeSize, false);
+    // Os arrays apontam para o buffer desta instância.
+    NodeIndexer(const NodeIndexer&) = delete;
+    NodeIndexer& operator=(const NodeIndexer&) = delete;
 
-        preL_to_preR.resize(treeSize, 0);
-        preR_to_preL.resize(treeSize, 0);
-        preL_to_postL.resize(treeSize, 0);
-        preL_to_postR.resize(treeSize, 0);
-        postL_to_preL.resize(treeSize, 0);
-        postR_to_preL.resize(treeSize, 0);
+    /**
+     * @brief Obtém a memória ocupada pelos arrays do índice
+     * @return size_t Quantidade de bytes do buffer único, incluindo a folga
+     *         reservada por edições locais que aumentaram a árvore
+     */
+    size_t sizeInBytes() const {
+        return storage.size() * sizeof(uint64_t);
+    }
 
-        preL_to_kr_sum.resize(treeSize, 0);
-        preL_to_rev_kr_sum.resize(treeSize, 0);
-        preL_to_desc_sum.resize(treeSize, 0);
-        preL_to_sumDelCost.resize(treeSize, 0.0f);
-        preL_to_sumInsCost.resize(treeSize, 0.0f);
+    /**
+     * @brief Estima, sem indexar, a memória dos arrays de uma árvore
+     * @param treeSize Quantidade de nós da árvore
+     * @return size_t Quantidade de bytes do buffer único
+     */
+    static size_t estimateBytes(size_t treeSize) {
+        return layout(treeSize).words * sizeof(uint64_t);
+    }
 
-        // Indexa
-        indexNodes(inputTree, -1);
-        postTraversalIndexing();
+    /**
+     * @brief Libera a folga reservada por edições locais, deixando o buffer com
+     *        o tamanho exato da árvore
+     */
+    void releaseSpareStorage() {
+        if (capacity != treeSize) {
+            relayout(treeSize);
+        }
+    }
+
+    /**
+     * @brief Obtém o hash do formato e dos rótulos da árvore indexada, gravado no
+     *        cache para que load recuse o índice de outra árvore com o mesmo
+     *        tamanho. Data precisa de uma função hashNodeData (veja StringNodeData).
+     *
+     * @return uint64_t Hash da árvore
+     */
+    uint64_t treeHash() const {
+        uint64_t hash = 0;
+        for (Index i = 0; i < treeSize; i++) {
+            hash = hashNode(hash, preL_to_node[i]);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Grava o índice completo em disco para ser recarregado sem recomputação.
+     *        Os custos somados dependem do modelo de custo, por isso o arquivo
+     *        guarda um identificador do modelo que é conferido no carregamento.
+     *
+     * @param path Caminho do arquivo de cache
+     * @param costModelId Identificador do modelo de custo usado na indexação
+     * @return true Se o arquivo foi gravado com sucesso
+     */
+    bool save(const std::string &path, uint64_t costModelId = 0) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        CacheHeader header;
+        std::memcpy(header.magic, "CAPTEDIX", sizeof(header.magic));
+        header.version = CACHE_VERSION;
+        header.integerBytes = sizeof(Index);
+        header.treeSize = treeSize;
+        header.lchl = lchl;
+        header.rchl = rchl;
+        header.costModelId = costModelId;
+        header.treeHash = treeHash();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        // Grava os arrays na disposição compacta (capacidade igual a treeSize),
+        // com zeros nos bytes de alinhamento entre eles.
+        const char* base = reinterpret_cast<const char*>(storage.data());
+        const auto source = pieces(treeSize, capacity);
+        const auto target = pieces(treeSize, treeSize);
+        const Layout compact = layout(treeSize);
+        const char zeros[sizeof(uint64_t)] = {};
+        size_t written = compact.hotAt;
+        for (size_t k = 1; k < source.size(); k++) {
+            out.write(zeros, target[k].first - written);
+            out.write(base + source[k].first, source[k].second);
+            written = target[k].first + target[k].second;
+        }
+        out.write(zeros, compact.end - written);
+
+        return (bool)out;
+    }
+
+    /**
+     * @brief Carrega um índice gravado por save(). Nenhum array é recomputado: o
+     *        arquivo é mapeado e copiado de uma vez para o buffer único (o índice
+     *        não fica apoiado no mapeamento, pois as edições locais alteram o
+     *        buffer), e apenas preL_to_node é religado aos nós da árvore. Uma
+     *        árvore diferente da indexada originalmente (formato ou rótulos, pelo
+     *        treeHash do cabeçalho) é recusada.
+     *
+     * @param path Caminho do arquivo de cache
+     * @param inputTree Árvore correspondente ao índice
+     * @param costModel Modelo de custo
+     * @param costModelId Identificador do modelo de custo esperado
+     * @return NodeIndexer<Data, Index>* Índice carregado, ou nullptr se o arquivo é inválido ou não corresponde à árvore
+     */
+    static NodeIndexer<Data, Index>* load(const std::string &path, N* inputTree, const CostModel<Data>* costModel, uint64_t costModelId = 0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader)) {
+            close(fd);
+            return nullptr;
+        }
+
+        size_t fileSize = st.st_size;
+        void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            return nullptr;
+        }
+
+        const char* cursor = static_cast<const char*>(mapped);
+        CacheHeader header;
+        std::memcpy(&header, cursor, sizeof(header));
+        cursor += sizeof(header);
+
+        if (std::memcmp(header.magic, "CAPTEDIX", sizeof(header.magic)) != 0
+            || header.version != CACHE_VERSION
+            || header.integerBytes != sizeof(Index)
+            || header.costModelId != costModelId
+            || header.treeSize <= 0
+            || header.treeSize > maxIndexedTreeSize<Index>()) {
+            munmap(mapped, fileSize);
+            return nullptr;
+        }
+
+        NodeIndexer<Data, Index>* indexer = new NodeIndexer<Data, Index>((Index)header.treeSize, costModel);
+        const Layout l = layout(header.treeSize);
+        size_t cachedBytes = l.end - l.hotAt;
+        if (fileSize != sizeof(CacheHeader) + cachedBytes) {
+            munmap(mapped, fileSize);
+            delete indexer;
+            return nullptr;
+        }
+
+        indexer->lchl = header.lchl;
+        indexer->rchl = header.rchl;
+        char* base = reinterpret_cast<char*>(indexer->storage.data());
+        std::memcpy(base + l.hotAt, cursor, cachedBytes);
+
+        munmap(mapped, fileSize);
+
+        if (!indexer->attachNodes(inputTree, header.treeHash)) {
+            delete indexer;
+            return nullptr;
+        }
+
+        return indexer;
+    }
+
+    //-------------------------------------------------------------------------
+    // Edições locais
+    //-------------------------------------------------------------------------
+
+    /*
+     * As funções abaixo aplicam a edição correspondente de Node na árvore
+     * indexada e atualizam o índice sem reindexar a árvore inteira: apenas a
+     * subárvore inserida é indexada, os demais nós têm os índices deslocados e
+     * só a cadeia de ancestrais do ponto editado é recalculada.
+     */
+
+    /**
+     * @brief Adiciona child como último filho de parent e atualiza o índice
+     * @param parent Nó da árvore indexada
+     * @param child Raiz de uma subárvore solta
+     * @throw std::overflow_error Se a árvore editada excede a largura Index
+     */
+    void addChild(N* parent, N* child) {
+        Index parentPreL = findPreL(parent);
+        std::unique_ptr<NodeIndexer> inserted(indexSubtree(child, 0));
+        parent->addChild(child);
+        splice(parentPreL, parentPreL + sizes[parentPreL], 0, inserted.get());
+    }
+
+    /**
+     * @brief Insere child na lista de filhos de parent antes de destIter e atualiza o índice
+     * @param parent Nó da árvore indexada
+     * @param destIter Posição na lista de filhos de parent
+     * @param child Raiz de uma subárvore solta
+     * @return Iterador para o nó inserido
+     * @throw std::overflow_error Se a árvore editada excede a largura Index
+     */
+    typename std::list<N*>::iterator insertChild(N* parent, typename std::list<N*>::iterator destIter, N* child) {
+        Index parentPreL = findPreL(parent);
+        Index q = parentPreL + 1;
+        for (auto it = parent->getChildren().begin(); it != destIter; it++) {
+            q += sizes[q];
+        }
+        std::unique_ptr<NodeIndexer> inserted(indexSubtree(child, 0));
+        auto result = parent->insertChild(destIter, child);
+        splice(parentPreL, q, 0, inserted.get());
+        return result;
+    }
+
+    /**
+     * @brief Substitui o filho child de parent por replacement e atualiza o índice.
+     *        child passa a ser uma árvore solta, de posse do chamador.
+     * @param parent Nó da árvore indexada
+     * @param child Filho de parent
+     * @param replacement Raiz de uma subárvore solta
+     * @throw std::invalid_argument Se child não é filho de parent
+     * @throw std::overflow_error Se a árvore editada excede a largura Index
+     */
+    void replaceChild(N* parent, N* child, N* replacement) {
+        Index q = findPreL(child);
+        if (q == 0 || parents[q] != findPreL(parent)) {
+            throw std::invalid_argument("NodeIndexer: child não é filho de parent");
+        }
+        std::unique_ptr<NodeIndexer> inserted(indexSubtree(replacement, sizes[q]));
+        parent->replaceChild(child, replacement);
+        splice(parents[q], q, sizes[q], inserted.get());
+    }
+
+    /**
+     * @brief Desanexa node de seu pai e atualiza o índice. node passa a ser uma
+     *        árvore solta, de posse do chamador.
+     * @param node Nó da árvore indexada, diferente da raiz
+     */
+    void detachFromParent(N* node) {
+        Index q = findPreL(node);
+        assert(q > 0);
+        node->detachFromParent();
+        splice(parents[q], q, sizes[q], nullptr);
+    }
+
+    /**
+     * @brief Atualiza os custos somados após uma mudança nos dados de node
+     *        (por exemplo, um novo rótulo), recalculando apenas seus ancestrais
+     * @param node Nó da árvore indexada
+     */
+    void dataChanged(N* node) {
+        for (Index a = findPreL(node); a >= 0; a = parents[a]) {
+            refreshAggregates(a);
+        }
     }
 
     /**
      * @brief Obtém o tamanho da árvore
-     * @return Integer Tamanho da árvore
+     * @return Index Tamanho da árvore
      */
-    Integer getSize() {
+    Index getSize() const {
         return treeSize;
     }
 
     /**
      * @brief Obtém o índice da folha mais à esquerda para um nó dado em pré-ordem
      * @param preL Índice em pré-ordem
-     * @return Integer Índice da folha mais à esquerda
+     * @return Index Índice da folha mais à esquerda
      */
-    Integer preL_to_lld(Integer preL) {
+    Index preL_to_lld(Index preL) const {
         return postL_to_preL[postL_to_lld[preL_to_postL[preL]]];
     }
 
+    /**
+     * @brief Obtém a folha mais à esquerda de um nó, ambos em pós-ordem
+     * @param postL Índice em pós-ordem
+     * @return Index Índice em pós-ordem da folha mais à esquerda
+     */
+    Index leftmostLeaf(Index postL) const {
+        return postL_to_lld[postL];
+    }
+
     /**
      * @brief Obtém o índice da folha mais à direita para um nó dado em pré-ordem
      * @param preL Índice em pré-ordem
-     * @return Integer Índice da folha mais à direita
+     * @return Index Índice da folha mais à direita
      */
-    Integer preL_to_rld(Integer preL) {
+    Index preL_to_rld(Index preL) const {
         return postR_to_preL[postR_to_rld[preL_to_postR[preL]]];
     }
 
@@ -333,7 +1241,7 @@ public:
      * @param postL Índice em pós-ordem
      * @return Node<Data>* Ponteiro para o nó
      */
-    Node<Data>* postL_to_node(Integer postL) {
+    Node<Data>* postL_to_node(Index postL) const {
         return preL_to_node[postL_to_preL[postL]];
     }
 
@@ -342,7 +1250,7 @@ public:
      * @param postR Índice em pós-ordem reverso
      * @return Node<Data>* Ponteiro para o nó
      */
-    Node<Data>* postR_to_node(Integer postR) {
+    Node<Data>* postR_to_node(Index postR) const {
         return preL_to_node[postR_to_preL[postR]];
     }
 
@@ -352,30 +1260,14 @@ public:
      * @return true Se o nó é folha
      * @return false Se o nó não é folha
      */
-    bool isLeaf(Integer nodeId) {
+    bool isLeaf(Index nodeId) const {
         return sizes[nodeId] == 1;
     }
 
-    /**
-     * @brief Obtém o nó atual
-     * @return Integer ID do nó atual
-     */
-    Integer getCurrentNode() const {
-        return currentNode;
-    }
-
-    /**
-     * @brief Define o nó atual
-     * @param preorder Índice em pré-ordem
-     */
-    void setCurrentNode(Integer preorder) {
-        currentNode = preorder;
-    }
-
     /**
      * @brief Exibe os índices e outras informações da árvore
      */
-    void dump() {
+    void dump() const {
         std::cerr << std::string(80, '-') << std::endl;
         std::cerr << "sizes: "              << arrayToString(sizes)              << std::endl;
         std::cerr << "preL_to_preR: "       << arrayToString(preL_to_preR)       << std::endl;
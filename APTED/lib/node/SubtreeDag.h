@@ -0,0 +1,370 @@
+#pragma once
+
+/**
+ * @file SubtreeDag.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Armazenamento de coleções de árvores como um DAG com compartilhamento
+ *        de subárvores (hash-consing): cada subárvore rotulada distinta é
+ *        guardada uma única vez e cada árvore é representada por uma raiz do DAG.
+ * @date 2024-06-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code for more algorithm-related comments.
+ *
+ * <p>References:
+ * <ul>
+ * <li>[1] M. Pawlik and N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik and N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou tradizido para melhor compreenção do grupo.
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Node.h"
+#include "../StringNodeData.h"
+#include "../StringNodeSerializer.h"
+#include "../util/LabelDictionary.h"
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Subtree DAG
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Coleção de árvores com subárvores idênticas compartilhadas.
+ *
+ * Dois nós do DAG são a mesma entrada se e somente se têm o mesmo rótulo e a
+ * mesma sequência de filhos (já compartilhados), então a igualdade de
+ * identificadores equivale à igualdade das subárvores. O hash de cada
+ * subárvore é estrutural (depende apenas de rótulos e formato) e pode ser
+ * usado para deduplicação e cache fora do processo.
+ *
+ * O Apted trabalha sobre Node, então as árvores são expandidas sob demanda
+ * com expand() antes de serem indexadas.
+ */
+class SubtreeDag {
+public:
+    typedef uint32_t DagId;
+
+private:
+    /**
+     * @brief Subárvore única. Os filhos ficam contíguos em childIds.
+     */
+    struct DagNode {
+        uint64_t hash;
+        uint64_t size;        /**< Quantidade de nós da subárvore expandida */
+        uint32_t label;
+        uint32_t firstChild;  /**< Posição do primeiro filho em childIds */
+        uint32_t numChildren;
+    };
+
+    std::vector<DagNode> nodes;
+    std::vector<DagId> childIds;
+    std::vector<DagId> roots;
+    std::unordered_multimap<uint64_t, DagId> byHash;
+    LabelDictionary dictionary;
+
+    static uint64_t mix(uint64_t h, uint64_t v) {
+        // Combinação no estilo boost::hash_combine com constantes de 64 bits.
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 12) + (h >> 4);
+        return h * 0xff51afd7ed558ccdULL;
+    }
+
+    static uint64_t hashLabel(const std::string &label) {
+        // FNV-1a, estável entre execuções (std::hash não garante isso).
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : label) {
+            h = (h ^ c) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    /**
+     * @brief Obtém o identificador da subárvore (label, children), criando-a se é nova
+     * @param label Identificador do rótulo da raiz
+     * @param labelHash Hash do rótulo da raiz
+     * @param children Identificadores dos filhos, em ordem
+     * @param count Quantidade de filhos
+     * @return DagId Identificador da subárvore
+     */
+    DagId intern(uint32_t label, uint64_t labelHash, const DagId* children, uint32_t count) {
+        uint64_t hash = mix(labelHash, count);
+        uint64_t size = 1;
+        for (uint32_t i = 0; i < count; i++) {
+            hash = mix(hash, nodes[children[i]].hash);
+            size += nodes[children[i]].size;
+        }
+
+        auto range = byHash.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const DagNode &candidate = nodes[it->second];
+            if (candidate.label != label || candidate.numChildren != count) {
+                continue;
+            }
+            bool same = true;
+            for (uint32_t i = 0; i < count && same; i++) {
+                same = childIds[candidate.firstChild + i] == children[i];
+            }
+            if (same) {
+                return it->second;
+            }
+        }
+
+        DagId id = (DagId)nodes.size();
+        nodes.push_back({hash, size, label, (uint32_t)childIds.size(), count});
+        childIds.insert(childIds.end(), children, children + count);
+        byHash.emplace(hash, id);
+        return id;
+    }
+
+public:
+    SubtreeDag() { }
+
+    SubtreeDag(const SubtreeDag&) = delete;
+    SubtreeDag& operator=(const SubtreeDag&) = delete;
+
+    /**
+     * @brief Acrescenta uma árvore à coleção, compartilhando subárvores já vistas
+     * @param root Raiz da árvore
+     * @return size_t Índice da árvore na coleção
+     */
+    size_t addTree(const Node<StringNodeData>* root) {
+        // Pilha de filhos já internalizados; cada nó aberto guarda onde os seus começam.
+        std::vector<DagId> pending;
+        std::vector<size_t> starts;
+
+        walkTree(root,
+            [&](const Node<StringNodeData>*) { starts.push_back(pending.size()); },
+            [&](const Node<StringNodeData>* node) {
+                size_t start = starts.back();
+                starts.pop_back();
+                const std::string &label = node->getData()->getLabel();
+                DagId id = intern(dictionary.intern(label), hashLabel(label),
+                                  pending.data() + start, (uint32_t)(pending.size() - start));
+                pending.resize(start);
+                pending.push_back(id);
+            });
+
+        roots.push_back(pending.back());
+        return roots.size() - 1;
+    }
+
+    /**
+     * @brief Acrescenta uma árvore em notação de chaves sem criar nós intermediários
+     * @param s Árvore em notação de chaves
+     * @return true Se a string contém uma árvore completa
+     */
+    bool addBracketString(const std::string &s) {
+        size_t i = s.find('{');
+        if (i == std::string::npos) {
+            return false;
+        }
+
+        std::vector<DagId> pending;
+        std::vector<size_t> starts;
+        std::vector<std::pair<uint32_t, uint64_t>> openLabels;
+        std::string label;
+        while (i < s.size()) {
+            if (s[i] == '{') {
+                size_t end = s.find_first_of("{}", i + 1);
+                if (end == std::string::npos) {
+                    return false;
+                }
+                label.assign(s, i + 1, end - i - 1);
+                openLabels.emplace_back(dictionary.intern(label), hashLabel(label));
+                starts.push_back(pending.size());
+                i = end;
+            } else if (s[i] == '}') {
+                if (starts.empty()) {
+                    return false;
+                }
+                size_t start = starts.back();
+                starts.pop_back();
+                DagId id = intern(openLabels.back().first, openLabels.back().second,
+                                  pending.data() + start, (uint32_t)(pending.size() - start));
+                openLabels.pop_back();
+                pending.resize(start);
+                pending.push_back(id);
+                if (starts.empty()) {
+                    roots.push_back(id);
+                    return true;
+                }
+                i++;
+            } else {
+                i++;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Obtém a quantidade de árvores da coleção
+     */
+    size_t numTrees() const {
+        return roots.size();
+    }
+
+    /**
+     * @brief Obtém a quantidade de subárvores distintas armazenadas
+     */
+    size_t numUniqueNodes() const {
+        return nodes.size();
+    }
+
+    /**
+     * @brief Obtém a quantidade de nós que a coleção teria se cada árvore fosse expandida
+     */
+    uint64_t numExpandedNodes() const {
+        uint64_t total = 0;
+        for (DagId root : roots) {
+            total += nodes[root].size;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Obtém a raiz no DAG de uma árvore da coleção
+     * @param tree Índice da árvore
+     */
+    DagId treeRoot(size_t tree) const {
+        return roots[tree];
+    }
+
+    /**
+     * @brief Obtém o hash estrutural de uma subárvore
+     * @param id Identificador da subárvore
+     */
+    uint64_t subtreeHash(DagId id) const {
+        return nodes[id].hash;
+    }
+
+    /**
+     * @brief Obtém a quantidade de nós de uma subárvore expandida
+     * @param id Identificador da subárvore
+     */
+    uint64_t subtreeSize(DagId id) const {
+        return nodes[id].size;
+    }
+
+    /**
+     * @brief Obtém o rótulo da raiz de uma subárvore
+     * @param id Identificador da subárvore
+     */
+    const std::string &label(DagId id) const {
+        return dictionary.label(nodes[id].label);
+    }
+
+    /**
+     * @brief Obtém a quantidade de filhos da raiz de uma subárvore
+     * @param id Identificador da subárvore
+     */
+    uint32_t numChildren(DagId id) const {
+        return nodes[id].numChildren;
+    }
+
+    /**
+     * @brief Obtém o i-ésimo filho da raiz de uma subárvore
+     * @param id Identificador da subárvore
+     * @param i Posição do filho
+     */
+    DagId child(DagId id, uint32_t i) const {
+        return childIds[nodes[id].firstChild + i];
+    }
+
+    const LabelDictionary &getDictionary() const {
+        return dictionary;
+    }
+
+    /**
+     * @brief Expande uma subárvore em uma árvore de Node independente, pronta para
+     *        ser indexada pelo Apted. O chamador é dono da árvore retornada.
+     * @param id Identificador da subárvore
+     * @return Node<StringNodeData>* Raiz da árvore expandida
+     */
+    Node<StringNodeData>* expand(DagId id) const {
+        struct Frame {
+            Node<StringNodeData>* node;
+            DagId id;
+            uint32_t next;
+        };
+        Node<StringNodeData>* root = new Node<StringNodeData>(new StringNodeData(label(id)));
+        std::vector<Frame> stack;
+        stack.push_back({root, id, 0});
+
+        while (!stack.empty()) {
+            Frame &top = stack.back();
+            if (top.next == nodes[top.id].numChildren) {
+                stack.pop_back();
+                continue;
+            }
+            DagId c = child(top.id, top.next++);
+            Node<StringNodeData>* node = new Node<StringNodeData>(new StringNodeData(label(c)));
+            top.node->addChild(node);
+            stack.push_back({node, c, 0});
+        }
+
+        return root;
+    }
+
+    /**
+     * @brief Expande uma árvore da coleção
+     * @param tree Índice da árvore
+     */
+    Node<StringNodeData>* expandTree(size_t tree) const {
+        return expand(roots[tree]);
+    }
+
+    /**
+     * @brief Calcula a distância de edição entre duas árvores da coleção,
+     *        expandindo-as apenas durante o cálculo. Árvores com a mesma raiz
+     *        no DAG são idênticas e têm distância 0 sem expansão (assume um
+     *        modelo de custo em que renomear para o mesmo rótulo custa 0).
+     *
+     * @tparam Ted Algoritmo de distância (ex.: Apted<StringNodeData>)
+     * @param ted Instância do algoritmo
+     * @param tree1 Índice da primeira árvore
+     * @param tree2 Índice da segunda árvore
+     * @return float Distância de edição entre as árvores
+     */
+    template<class Ted>
+    float computeEditDistance(Ted &ted, size_t tree1, size_t tree2) const {
+        if (roots[tree1] == roots[tree2]) {
+            return 0;
+        }
+        Node<StringNodeData>* t1 = expandTree(tree1);
+        Node<StringNodeData>* t2 = expandTree(tree2);
+        float distance = ted.computeEditDistance(t1, t2);
+        delete t1;
+        delete t2;
+        return distance;
+    }
+
+    /**
+     * @brief Obtém a memória usada pelo DAG (sem o dicionário de rótulos)
+     */
+    size_t sizeInBytes() const {
+        return nodes.capacity() * sizeof(DagNode) + childIds.capacity() * sizeof(DagId) +
+               roots.capacity() * sizeof(DagId) +
+               byHash.size() * (sizeof(uint64_t) + sizeof(DagId) + 2 * sizeof(void*)) +
+               byHash.bucket_count() * sizeof(void*);
+    }
+};
+
+} // namespace capted
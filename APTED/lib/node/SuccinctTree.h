@@ -0,0 +1,699 @@
+#pragma once
+
+/**
+ * @file SuccinctTree.h
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Representação sucinta de coleções de árvores: a estrutura é guardada
+ *        como uma sequência de parênteses balanceados (2 bits por nó) com
+ *        estruturas auxiliares de rank/select e de excesso mínimo, e os rótulos
+ *        como identificadores de um LabelDictionary, em pré-ordem.
+ * @date 2024-06-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code for more algorithm-related comments.
+ *
+ * <p>References:
+ * <ul>
+ * <li>[1] M. Pawlik and N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik and N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou tradizido para melhor compreenção do grupo.
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Node.h"
+#include "../StringNodeData.h"
+#include "../util/LabelDictionary.h"
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Balanced Parentheses
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Sequência de parênteses balanceados em um vetor de bits ('(' = 1, ')' = 0).
+ *
+ * O excesso E(i) é o número de '(' menos o número de ')' nas posições [0, i).
+ * As buscas de parênteses correspondentes usam uma tabela por byte e uma árvore
+ * de mínimos sobre blocos de 512 bits, de modo que cada busca custa O(log n)
+ * blocos mais a varredura de no máximo dois blocos.
+ */
+class BalancedParentheses {
+private:
+    static const uint64_t BLOCK_BITS = 512;
+    static const uint64_t SUPERBLOCK_BITS = 4096;
+
+    std::vector<uint64_t> words;
+    uint64_t length = 0;
+
+    std::vector<uint64_t> superRanks;  /**< Quantidade de '(' antes de cada superbloco */
+    std::vector<uint16_t> blockRanks;  /**< Quantidade de '(' antes de cada bloco, relativa ao superbloco */
+    std::vector<int32_t> minTree;      /**< Árvore de mínimos do excesso nas posições de cada bloco */
+    uint64_t leaves = 0;
+
+    /**
+     * @brief Tabelas de excesso por byte
+     */
+    struct ByteTables {
+        int8_t total[256];   /**< Excesso ao final do byte */
+        int8_t fwdMin[256];  /**< Mínimo do excesso após cada um dos 8 bits */
+        int8_t bwdMin[256];  /**< Mínimo do excesso antes de cada um dos 8 bits */
+
+        ByteTables() {
+            for (int b = 0; b < 256; b++) {
+                int e = 0;
+                int fwd = 8;
+                int bwd = 0;
+                for (int k = 0; k < 8; k++) {
+                    bwd = std::min(bwd, e);
+                    e += ((b >> k) & 1) ? 1 : -1;
+                    fwd = std::min(fwd, e);
+                }
+                total[b] = (int8_t)e;
+                fwdMin[b] = (int8_t)fwd;
+                bwdMin[b] = (int8_t)bwd;
+            }
+        }
+    };
+
+    static const ByteTables &tables() {
+        static const ByteTables instance;
+        return instance;
+    }
+
+    uint8_t byteAt(uint64_t bytePosition) const {
+        return (uint8_t)(words[bytePosition >> 3] >> ((bytePosition & 7) * 8));
+    }
+
+    /**
+     * @brief Encontra o primeiro bloco >= first cujo excesso mínimo é <= target
+     */
+    int64_t nextBlock(uint64_t node, uint64_t lo, uint64_t hi, uint64_t first, int64_t target) const {
+        if (hi <= first || minTree[node] > target) {
+            return -1;
+        }
+        if (hi - lo == 1) {
+            return lo;
+        }
+        uint64_t mid = (lo + hi) / 2;
+        int64_t found = nextBlock(2 * node, lo, mid, first, target);
+        return found >= 0 ? found : nextBlock(2 * node + 1, mid, hi, first, target);
+    }
+
+    /**
+     * @brief Encontra o último bloco <= last cujo excesso mínimo é <= target
+     */
+    int64_t prevBlock(uint64_t node, uint64_t lo, uint64_t hi, int64_t last, int64_t target) const {
+        if ((int64_t)lo > last || minTree[node] > target) {
+            return -1;
+        }
+        if (hi - lo == 1) {
+            return lo;
+        }
+        uint64_t mid = (lo + hi) / 2;
+        int64_t found = prevBlock(2 * node + 1, mid, hi, last, target);
+        return found >= 0 ? found : prevBlock(2 * node, lo, mid, last, target);
+    }
+
+    /**
+     * @brief Menor j > from com E(j) <= target, ou -1
+     */
+    int64_t fwdSearch(uint64_t from, int64_t target) const {
+        const ByteTables &t = tables();
+        uint64_t j = from;
+        int64_t e = excess(from);
+
+        while (true) {
+            uint64_t blockEnd = std::min(length, (j / BLOCK_BITS + 1) * BLOCK_BITS);
+            while (j < blockEnd) {
+                if ((j & 7) == 0 && j + 8 <= blockEnd) {
+                    uint8_t b = byteAt(j >> 3);
+                    if (e + t.fwdMin[b] > target) {
+                        e += t.total[b];
+                        j += 8;
+                        continue;
+                    }
+                }
+                e += isOpen(j) ? 1 : -1;
+                j++;
+                if (e <= target) {
+                    return j;
+                }
+            }
+            if (j >= length) {
+                return -1;
+            }
+
+            int64_t block = nextBlock(1, 0, leaves, j / BLOCK_BITS, target);
+            if (block < 0) {
+                return -1;
+            }
+            j = std::max(j, (uint64_t)block * BLOCK_BITS);
+            e = excess(j);
+        }
+    }
+
+    /**
+     * @brief Maior j < from com E(j) <= target, ou -1
+     */
+    int64_t bwdSearch(uint64_t from, int64_t target) const {
+        const ByteTables &t = tables();
+        uint64_t j = from;
+        int64_t e = excess(from);
+
+        while (true) {
+            uint64_t blockStart = j == 0 ? 0 : ((j - 1) / BLOCK_BITS) * BLOCK_BITS;
+            while (j > blockStart) {
+                if ((j & 7) == 0 && j - 8 >= blockStart) {
+                    uint8_t b = byteAt((j - 8) >> 3);
+                    int64_t startExcess = e - t.total[b];
+                    if (startExcess + t.bwdMin[b] > target) {
+                        e = startExcess;
+                        j -= 8;
+                        continue;
+                    }
+                }
+                j--;
+                e -= isOpen(j) ? 1 : -1;
+                if (e <= target) {
+                    return j;
+                }
+            }
+            if (j == 0) {
+                return -1;
+            }
+
+            int64_t block = prevBlock(1, 0, leaves, (int64_t)(j / BLOCK_BITS) - 1, target);
+            if (block < 0) {
+                return -1;
+            }
+            j = std::min(j, (uint64_t)(block + 1) * BLOCK_BITS);
+            e = excess(j);
+        }
+    }
+
+public:
+    /**
+     * @brief Acrescenta um parêntese ao final da sequência
+     * @param open true para '(' e false para ')'
+     */
+    void push(bool open) {
+        if ((length & 63) == 0) {
+            words.push_back(0);
+        }
+        if (open) {
+            words.back() |= (uint64_t)1 << (length & 63);
+        }
+        length++;
+    }
+
+    /**
+     * @brief Descarta os parênteses a partir da posição dada. Como push, só pode
+     *        ser chamado antes de build.
+     * @param newLength Quantidade de parênteses mantidos
+     */
+    void truncate(uint64_t newLength) {
+        if (newLength >= length) {
+            return;
+        }
+        words.resize((newLength + 63) / 64);
+        if ((newLength & 63) != 0) {
+            words.back() &= ((uint64_t)1 << (newLength & 63)) - 1;
+        }
+        length = newLength;
+    }
+
+    /**
+     * @brief Constrói as estruturas de rank e de excesso mínimo. Deve ser chamado
+     *        depois do último push e antes de qualquer consulta.
+     */
+    void build() {
+        // Completa o último superbloco para que todas as fronteiras tenham rank definido.
+        words.resize(((words.size() + 63) / 64) * 64, 0);
+        superRanks.assign(words.size() / 64 + 1, 0);
+        blockRanks.assign(words.size() / 8 + 1, 0);
+
+        uint64_t ones = 0;
+        for (uint64_t w = 0; w <= words.size(); w++) {
+            if (w % 64 == 0) {
+                superRanks[w / 64] = ones;
+            }
+            if (w % 8 == 0) {
+                blockRanks[w / 8] = (uint16_t)(ones - superRanks[w / 64]);
+            }
+            if (w < words.size()) {
+                ones += __builtin_popcountll(words[w]);
+            }
+        }
+
+        uint64_t numBlocks = (length + BLOCK_BITS - 1) / BLOCK_BITS;
+        leaves = 1;
+        while (leaves < numBlocks) {
+            leaves *= 2;
+        }
+        minTree.assign(2 * leaves, INT32_MAX);
+
+        int64_t e = 0;
+        for (uint64_t block = 0; block < numBlocks; block++) {
+            int64_t minExcess = e;
+            uint64_t end = std::min(length, (block + 1) * BLOCK_BITS);
+            for (uint64_t i = block * BLOCK_BITS; i < end; i++) {
+                e += isOpen(i) ? 1 : -1;
+                minExcess = std::min(minExcess, e);
+            }
+            minTree[leaves + block] = (int32_t)minExcess;
+        }
+        for (uint64_t node = leaves - 1; node >= 1; node--) {
+            minTree[node] = std::min(minTree[2 * node], minTree[2 * node + 1]);
+        }
+    }
+
+    /**
+     * @brief Obtém o tamanho da sequência em bits
+     */
+    uint64_t size() const {
+        return length;
+    }
+
+    /**
+     * @brief Verifica se a posição i contém '('
+     */
+    bool isOpen(uint64_t i) const {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    /**
+     * @brief Quantidade de '(' nas posições [0, i)
+     */
+    uint64_t rank1(uint64_t i) const {
+        uint64_t rank = superRanks[i / SUPERBLOCK_BITS] + blockRanks[i / BLOCK_BITS];
+        for (uint64_t w = (i / BLOCK_BITS) * (BLOCK_BITS / 64); w < (i >> 6); w++) {
+            rank += __builtin_popcountll(words[w]);
+        }
+        if (i & 63) {
+            rank += __builtin_popcountll(words[i >> 6] & (((uint64_t)1 << (i & 63)) - 1));
+        }
+        return rank;
+    }
+
+    /**
+     * @brief Posição do k-ésimo '(' (k >= 1)
+     */
+    uint64_t select1(uint64_t k) const {
+        // Último superbloco com menos de k '(' antes dele.
+        uint64_t super = std::lower_bound(superRanks.begin(), superRanks.end(), k) - superRanks.begin() - 1;
+        uint64_t block = super * (SUPERBLOCK_BITS / BLOCK_BITS);
+        uint64_t lastBlock = block + SUPERBLOCK_BITS / BLOCK_BITS;
+        while (block + 1 < lastBlock && superRanks[super] + blockRanks[block + 1] < k) {
+            block++;
+        }
+
+        uint64_t remaining = k - superRanks[super] - blockRanks[block];
+        uint64_t w = block * (BLOCK_BITS / 64);
+        uint64_t count;
+        while ((count = __builtin_popcountll(words[w])) < remaining) {
+            remaining -= count;
+            w++;
+        }
+
+        uint64_t word = words[w];
+        for (uint64_t r = 1; r < remaining; r++) {
+            word &= word - 1;
+        }
+        return w * 64 + __builtin_ctzll(word);
+    }
+
+    /**
+     * @brief Excesso E(i) = '(' - ')' nas posições [0, i)
+     */
+    int64_t excess(uint64_t i) const {
+        return 2 * (int64_t)rank1(i) - (int64_t)i;
+    }
+
+    /**
+     * @brief Posição do ')' correspondente ao '(' em p
+     */
+    int64_t findClose(uint64_t p) const {
+        int64_t j = fwdSearch(p, excess(p));
+        return j < 0 ? -1 : j - 1;
+    }
+
+    /**
+     * @brief Posição do '(' correspondente ao ')' em q
+     */
+    int64_t findOpen(uint64_t q) const {
+        return bwdSearch(q, excess(q + 1));
+    }
+
+    /**
+     * @brief Posição do '(' que envolve diretamente o '(' em p, ou -1 se p é uma raiz
+     */
+    int64_t enclose(uint64_t p) const {
+        int64_t e = excess(p);
+        return e == 0 ? -1 : bwdSearch(p, e - 1);
+    }
+
+    /**
+     * @brief Memória ocupada pela sequência e pelas estruturas auxiliares
+     */
+    size_t sizeInBytes() const {
+        return words.size() * sizeof(uint64_t)
+             + superRanks.size() * sizeof(uint64_t)
+             + blockRanks.size() * sizeof(uint16_t)
+             + minTree.size() * sizeof(int32_t);
+    }
+};
+
+//------------------------------------------------------------------------------
+// Succinct Forest
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Coleção de árvores rotuladas em representação sucinta. Cada árvore
+ *        adicionada é uma raiz da floresta; os nós são identificados pela sua
+ *        posição em pré-ordem na floresta inteira.
+ *
+ *        Uso: addTree/addBracketString para cada árvore, build() uma vez, e então
+ *        navegação (parent, firstChild, nextSibling, subtreeSize) ou toNode()
+ *        para obter a árvore de uma comparação.
+ */
+class SuccinctForest {
+private:
+    BalancedParentheses bp;
+    std::vector<uint32_t> labels;   /**< Identificador do rótulo de cada nó, em pré-ordem */
+    std::vector<uint64_t> roots;    /**< Identificador (pré-ordem) da raiz de cada árvore */
+    LabelDictionary dictionary;
+    uint64_t openNodes = 0;         /**< Nós abertos por openNode e ainda não fechados */
+
+public:
+    typedef int64_t NodeId;
+
+    /**
+     * @brief Estado da floresta antes de uma árvore, para desfazer uma leitura
+     *        que falhou no meio (veja checkpoint e rollback)
+     */
+    struct Checkpoint {
+        uint64_t parentheses;
+        uint64_t nodes;
+        uint64_t trees;
+        uint64_t openNodes;
+    };
+
+    /**
+     * @brief Adiciona uma árvore da estrutura Node
+     * @param root Raiz da árvore
+     * @return uint64_t Índice da árvore na floresta
+     */
+    uint64_t addTree(const Node<StringNodeData>* root) {
+        roots.push_back(labels.size());
+
+        std::vector<std::pair<const Node<StringNodeData>*, std::list<Node<StringNodeData>*>::const_iterator>> stack;
+        bp.push(true);
+        labels.push_back(dictionary.intern(root->getData()->getLabel()));
+        stack.emplace_back(root, root->getChildren().begin());
+
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            if (top.second == top.first->getChildren().end()) {
+                bp.push(false);
+                stack.pop_back();
+                continue;
+            }
+            const Node<StringNodeData>* child = *top.second++;
+            bp.push(true);
+            labels.push_back(dictionary.intern(child->getData()->getLabel()));
+            stack.emplace_back(child, child->getChildren().begin());
+        }
+
+        return roots.size() - 1;
+    }
+
+    /**
+     * @brief Confere, sem alterar a floresta, se a string tem uma árvore
+     *        completa a partir da primeira chave, com a mesma leitura de
+     *        addBracketString
+     * @param s Árvore em notação de chaves
+     * @return true Se as chaves da primeira árvore fecham
+     */
+    static bool isBalancedBracketTree(const std::string &s) {
+        size_t i = s.find('{');
+        if (i == std::string::npos) {
+            return false;
+        }
+
+        uint64_t depth = 0;
+        while (i < s.size()) {
+            if (s[i] == '{') {
+                size_t end = s.find_first_of("{}", i + 1);
+                if (end == std::string::npos) {
+                    return false;
+                }
+                depth++;
+                i = end;
+            } else if (s[i] == '}') {
+                if (--depth == 0) {
+                    return true;
+                }
+                i++;
+            } else {
+                i++;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Adiciona uma árvore em notação de chaves sem construir a estrutura
+     *        Node. A string é validada antes, então uma árvore inválida não
+     *        deixa nós abertos nem parênteses parciais na floresta.
+     * @param s Árvore em notação de chaves
+     * @return true Se a string é uma árvore balanceada (e foi adicionada)
+     */
+    bool addBracketString(const std::string &s) {
+        if (!isBalancedBracketTree(s)) {
+            return false;
+        }
+
+        size_t i = s.find('{');
+        std::string label;
+        while (i < s.size()) {
+            if (s[i] == '{') {
+                size_t end = s.find_first_of("{}", i + 1);
+                if (end == std::string::npos) {
+                    return false;
+                }
+                label.assign(s, i + 1, end - i - 1);
+                openNode(label);
+                i = end;
+            } else if (s[i] == '}') {
+                closeNode();
+                if (openNodes == 0) {
+                    return true;
+                }
+                i++;
+            } else {
+                i++;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Abre um nó com o rótulo dado, como filho do último nó aberto, ou
+     *        como raiz de uma nova árvore se nenhum nó está aberto. Permite que
+     *        leitores de documentos emitam a árvore sem passar por Node.
+     * @param label Rótulo do nó
+     */
+    void openNode(const std::string &label) {
+        if (openNodes++ == 0) {
+            roots.push_back(labels.size());
+        }
+        bp.push(true);
+        labels.push_back(dictionary.intern(label));
+    }
+
+    /**
+     * @brief Fecha o último nó aberto por openNode
+     */
+    void closeNode() {
+        bp.push(false);
+        openNodes--;
+    }
+
+    /**
+     * @brief Obtém o estado atual da floresta
+     * @return Checkpoint Estado para rollback
+     */
+    Checkpoint checkpoint() const {
+        return Checkpoint{bp.size(), labels.size(), roots.size(), openNodes};
+    }
+
+    /**
+     * @brief Volta ao estado de um checkpoint, descartando os nós abertos ou
+     *        adicionados depois dele (os rótulos continuam no dicionário). Só
+     *        pode ser chamado antes de build.
+     * @param mark Estado obtido por checkpoint
+     */
+    void rollback(const Checkpoint &mark) {
+        bp.truncate(mark.parentheses);
+        labels.resize(mark.nodes);
+        roots.resize(mark.trees);
+        openNodes = mark.openNodes;
+    }
+
+    /**
+     * @brief Constrói as estruturas auxiliares de navegação
+     */
+    void build() {
+        bp.build();
+    }
+
+    /**
+     * @brief Quantidade de árvores na floresta
+     */
+    uint64_t numTrees() const {
+        return roots.size();
+    }
+
+    /**
+     * @brief Quantidade total de nós
+     */
+    uint64_t numNodes() const {
+        return labels.size();
+    }
+
+    /**
+     * @brief Nó raiz de uma árvore
+     */
+    NodeId treeRoot(uint64_t tree) const {
+        return roots[tree];
+    }
+
+    /**
+     * @brief Pai do nó, ou -1 se o nó é uma raiz
+     */
+    NodeId parent(NodeId v) const {
+        int64_t p = bp.enclose(bp.select1(v + 1));
+        return p < 0 ? -1 : (NodeId)bp.rank1(p);
+    }
+
+    /**
+     * @brief Primeiro filho do nó, ou -1 se o nó é folha
+     */
+    NodeId firstChild(NodeId v) const {
+        uint64_t p = bp.select1(v + 1);
+        return bp.isOpen(p + 1) ? v + 1 : -1;
+    }
+
+    /**
+     * @brief Próximo irmão do nó, ou -1 se o nó é o último filho (ou a raiz de uma árvore)
+     */
+    NodeId nextSibling(NodeId v) const {
+        uint64_t close = bp.findClose(bp.select1(v + 1));
+        if (close + 1 >= bp.size() || !bp.isOpen(close + 1) || bp.excess(close + 1) == 0) {
+            return -1;
+        }
+        return v + subtreeSize(v);
+    }
+
+    /**
+     * @brief Tamanho da subárvore enraizada no nó
+     */
+    int64_t subtreeSize(NodeId v) const {
+        uint64_t p = bp.select1(v + 1);
+        return (bp.findClose(p) - p + 1) / 2;
+    }
+
+    /**
+     * @brief Verifica se o nó é folha
+     */
+    bool isLeaf(NodeId v) const {
+        return !bp.isOpen(bp.select1(v + 1) + 1);
+    }
+
+    /**
+     * @brief Identificador do rótulo do nó
+     */
+    uint32_t labelId(NodeId v) const {
+        return labels[v];
+    }
+
+    /**
+     * @brief Rótulo do nó
+     */
+    const std::string &label(NodeId v) const {
+        return dictionary.label(labels[v]);
+    }
+
+    /**
+     * @brief Dicionário de rótulos compartilhado pelas árvores da floresta
+     */
+    const LabelDictionary &getDictionary() const {
+        return dictionary;
+    }
+
+    /**
+     * @brief Converte uma árvore para a estrutura Node, a partir da qual o
+     *        NodeIndexer de uma comparação é construído. Percorre os parênteses
+     *        sequencialmente, sem buscas.
+     * @param tree Índice da árvore
+     * @return Node<StringNodeData>* Raiz da árvore convertida
+     */
+    Node<StringNodeData>* toNode(uint64_t tree) const {
+        NodeId v = roots[tree];
+        uint64_t p = bp.select1(v + 1);
+        std::vector<Node<StringNodeData>*> stack;
+        Node<StringNodeData>* root = nullptr;
+
+        do {
+            if (bp.isOpen(p)) {
+                Node<StringNodeData>* node = new Node<StringNodeData>(new StringNodeData(label(v++)));
+                if (stack.empty()) {
+                    root = node;
+                } else {
+                    stack.back()->addChild(node);
+                }
+                stack.push_back(node);
+            } else {
+                stack.pop_back();
+            }
+            p++;
+        } while (!stack.empty());
+
+        return root;
+    }
+
+    /**
+     * @brief Memória ocupada pela estrutura (parênteses e auxiliares) e pelos rótulos,
+     *        sem contar o dicionário de rótulos
+     */
+    size_t sizeInBytes() const {
+        return bp.sizeInBytes() + labels.size() * sizeof(uint32_t) + roots.size() * sizeof(uint64_t);
+    }
+
+    /**
+     * @brief Memória ocupada apenas pela estrutura (parênteses e auxiliares)
+     */
+    size_t structureSizeInBytes() const {
+        return bp.sizeInBytes();
+    }
+};
+
+} // namespace capted
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Matrix Options
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Configuração das matrizes mapeadas em arquivo. Ignorada por DenseFloatMatrix.
+ */
+struct MatrixOptions {
+    size_t residentBytes = (size_t)1 << 30; /**< Memória residente máxima das matrizes de um cálculo */
+    std::string directory = "/tmp";         /**< Diretório dos arquivos temporários */
+};
+
+//------------------------------------------------------------------------------
+// Dense Float Matrix
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Matriz de floats em um único bloco contíguo, linha a linha
+ */
+class DenseFloatMatrix {
+private:
+    std::vector<float> data;
+    size_t numRows = 0;
+    size_t numCols = 0;
+
+public:
+    /**
+     * @brief Construtor da classe DenseFloatMatrix
+     * @param options Ignorado; existe para ter a mesma interface de MappedFloatMatrix
+     * @param rowShift Ignorado
+     * @param colShift Ignorado
+     */
+    explicit DenseFloatMatrix(const MatrixOptions &options = MatrixOptions(), unsigned rowShift = 0, unsigned colShift = 0) {
+        (void)options;
+        (void)rowShift;
+        (void)colShift;
+    }
+
+    /**
+     * @brief Estima a memória de uma matriz com as dimensões dadas, sem criá-la
+     * @param rows Quantidade de linhas
+     * @param cols Quantidade de colunas
+     * @return size_t Quantidade de bytes
+     */
+    static size_t estimateBytes(size_t rows, size_t cols, const MatrixOptions &options = MatrixOptions(), unsigned rowShift = 0, unsigned colShift = 0) {
+        (void)options;
+        (void)rowShift;
+        (void)colShift;
+        return rows * cols * sizeof(float);
+    }
+
+    /**
+     * @brief Redimensiona a matriz, descartando o conteúdo; todas as posições ficam zeradas
+     * @param rows Quantidade de linhas
+     * @param cols Quantidade de colunas
+     */
+    void resize(size_t rows, size_t cols) {
+        numRows = rows;
+        numCols = cols;
+        data.assign(rows * cols, 0.0f);
+    }
+
+    size_t rows() const {
+        return numRows;
+    }
+
+    size_t cols() const {
+        return numCols;
+    }
+
+    float get(size_t i, size_t j) const {
+        return data[i * numCols + j];
+    }
+
+    void set(size_t i, size_t j, float value) {
+        data[i * numCols + j] = value;
+    }
+
+    /**
+     * @brief Zera uma linha
+     * @param i Linha
+     */
+    void clearRow(size_t i) {
+        std::fill(data.begin() + i * numCols, data.begin() + (i + 1) * numCols, 0.0f);
+    }
+
+    /**
+     * @brief Obtém a memória ocupada pela matriz
+     * @return size_t Quantidade de bytes
+     */
+    size_t residentBytes() const {
+        return data.size() * sizeof(float);
+    }
+};
+
+//------------------------------------------------------------------------------
+// Mapped Float Matrix
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Matriz de floats gravada em um arquivo temporário e mapeada em memória,
+ *        para matrizes maiores que a RAM. O arquivo é dividido em blocos de
+ *        2^rowShift x 2^colShift posições, cada bloco contíguo no arquivo, de modo
+ *        que acessos a retângulos de linhas e colunas próximas (como os pares de
+ *        subárvores em pré-ordem de gted) tocam poucos blocos. No máximo
+ *        residentBytes de blocos ficam mapeados; ao passar do limite, um bloco é
+ *        escolhido pelo algoritmo do relógio e devolvido ao kernel com
+ *        madvise(MADV_DONTNEED), e o conteúdo volta do arquivo no próximo acesso.
+ */
+class MappedFloatMatrix {
+private:
+    static constexpr uint32_t NOT_RESIDENT = UINT32_MAX;
+
+    MatrixOptions options;
+    unsigned rowShift;
+    unsigned colShift;
+    size_t rowMask;
+    size_t colMask;
+    size_t tileFloats;
+
+    size_t numRows = 0;
+    size_t numCols = 0;
+    size_t tilesPerRow = 0;
+
+    int fd = -1;
+    float* base = nullptr;
+    size_t mappedBytes = 0;
+
+    // Estado do relógio: blocos residentes, bit de referência e posição de cada bloco.
+    mutable std::vector<size_t> residentTiles;
+    mutable std::vector<uint8_t> referenced;
+    mutable std::vector<uint32_t> slotOfTile;
+    mutable size_t hand = 0;
+    mutable size_t numResident = 0;
+    mutable size_t lastTile = SIZE_MAX;
+
+    void release() {
+        if (base != nullptr) {
+            munmap(base, mappedBytes);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    /**
+     * @brief Garante que o bloco está entre os residentes, liberando outro se necessário
+     * @param tile Índice do bloco
+     */
+    void touch(size_t tile) const {
+        lastTile = tile;
+        uint32_t slot = slotOfTile[tile];
+        if (slot != NOT_RESIDENT) {
+            referenced[slot] = 1;
+            return;
+        }
+
+        if (numResident < residentTiles.size()) {
+            slot = numResident++;
+        } else {
+            while (referenced[hand]) {
+                referenced[hand] = 0;
+                hand = (hand + 1) % residentTiles.size();
+            }
+            slot = hand;
+            hand = (hand + 1) % residentTiles.size();
+
+            size_t evicted = residentTiles[slot];
+            slotOfTile[evicted] = NOT_RESIDENT;
+            madvise(base + evicted * tileFloats, tileFloats * sizeof(float), MADV_DONTNEED);
+        }
+
+        residentTiles[slot] = tile;
+        referenced[slot] = 1;
+        slotOfTile[tile] = slot;
+    }
+
+    /**
+     * @brief Calcula a posição de (i, j) no arquivo, tornando o bloco residente
+     */
+    float* locate(size_t i, size_t j) const {
+        size_t tile = (i >> rowShift) * tilesPerRow + (j >> colShift);
+        if (tile != lastTile) {
+            touch(tile);
+        }
+        return base + tile * tileFloats + ((i & rowMask) << colShift) + (j & colMask);
+    }
+
+public:
+    /**
+     * @brief Construtor da classe MappedFloatMatrix
+     * @param options Limite de memória residente e diretório do arquivo temporário
+     * @param rowShift Log2 da quantidade de linhas de cada bloco
+     * @param colShift Log2 da quantidade de colunas de cada bloco
+     */
+    explicit MappedFloatMatrix(const MatrixOptions &options = MatrixOptions(), unsigned rowShift = 8, unsigned colShift = 8)
+        : options(options), rowShift(rowShift), colShift(colShift),
+          rowMask(((size_t)1 << rowShift) - 1), colMask(((size_t)1 << colShift) - 1),
+          tileFloats((size_t)1 << (rowShift + colShift)) {
+        // nop
+    }
+
+    ~MappedFloatMatrix() {
+        release();
+    }
+
+    MappedFloatMatrix(const MappedFloatMatrix&) = delete;
+    MappedFloatMatrix& operator=(const MappedFloatMatrix&) = delete;
+
+    /**
+     * @brief Estima a memória residente de uma matriz com as dimensões dadas, sem
+     *        criá-la: os blocos mapeados, limitados por options.residentBytes, e
+     *        o estado do relógio
+     * @param rows Quantidade de linhas
+     * @param cols Quantidade de colunas
+     * @param options Limite de memória residente
+     * @param rowShift Log2 da quantidade de linhas de cada bloco
+     * @param colShift Log2 da quantidade de colunas de cada bloco
+     * @return size_t Quantidade de bytes
+     */
+    static size_t estimateBytes(size_t rows, size_t cols, const MatrixOptions &options = MatrixOptions(), unsigned rowShift = 8, unsigned colShift = 8) {
+        size_t tileBytes = ((size_t)1 << (rowShift + colShift)) * sizeof(float);
+        size_t numTiles = ((rows + ((size_t)1 << rowShift) - 1) >> rowShift) * ((cols + ((size_t)1 << colShift) - 1) >> colShift);
+        size_t capacity = std::max<size_t>(2, options.residentBytes / tileBytes);
+        return std::min(numTiles, capacity) * tileBytes
+             + numTiles * sizeof(uint32_t)
+             + capacity * (sizeof(size_t) + sizeof(uint8_t));
+    }
+
+    /**
+     * @brief Redimensiona a matriz, descartando o conteúdo anterior; todas as
+     *        posições ficam zeradas (o arquivo é esparso até ser escrito). O
+     *        arquivo temporário é criado na primeira chamada e reaproveitado nas
+     *        seguintes, já que as matrizes de spf são redimensionadas a cada chamada.
+     * @param rows Quantidade de linhas
+     * @param cols Quantidade de colunas
+     * @throw std::runtime_error Se o arquivo não pode ser criado ou mapeado
+     */
+    void resize(size_t rows, size_t cols) {
+        if (base != nullptr) {
+            munmap(base, mappedBytes);
+            base = nullptr;
+        }
+        numRows = rows;
+        numCols = cols;
+        tilesPerRow = (cols + colMask) >> colShift;
+        size_t numTiles = ((rows + rowMask) >> rowShift) * tilesPerRow;
+        mappedBytes = numTiles * tileFloats * sizeof(float);
+
+        size_t capacity = options.residentBytes / (tileFloats * sizeof(float));
+        residentTiles.assign(capacity < 2 ? 2 : capacity, 0);
+        referenced.assign(residentTiles.size(), 0);
+        slotOfTile.assign(numTiles, NOT_RESIDENT);
+        hand = 0;
+        numResident = 0;
+        lastTile = SIZE_MAX;
+
+        if (mappedBytes == 0) {
+            return;
+        }
+
+        if (fd < 0) {
+            std::string path = options.directory + "/capted-matrix-XXXXXX";
+            fd = mkstemp(&path[0]);
+            if (fd < 0) {
+                throw std::runtime_error("MappedFloatMatrix: não foi possível criar " + path + ": " + std::strerror(errno));
+            }
+            // O arquivo some do diretório imediatamente e é apagado ao ser fechado.
+            unlink(path.c_str());
+        }
+
+        // Truncar para zero descarta o conteúdo anterior e devolve os blocos ao disco.
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, mappedBytes) != 0) {
+            int error = errno;
+            release();
+            throw std::runtime_error("MappedFloatMatrix: não foi possível alocar " + std::to_string(mappedBytes) + " bytes: " + std::strerror(error));
+        }
+
+        void* mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            int error = errno;
+            release();
+            throw std::runtime_error("MappedFloatMatrix: mmap falhou: " + std::string(std::strerror(error)));
+        }
+        base = static_cast<float*>(mapped);
+    }
+
+    size_t rows() const {
+        return numRows;
+    }
+
+    size_t cols() const {
+        return numCols;
+    }
+
+    float get(size_t i, size_t j) const {
+        return *locate(i, j);
+    }
+
+    void set(size_t i, size_t j, float value) {
+        *locate(i, j) = value;
+    }
+
+    /**
+     * @brief Zera uma linha, um bloco por vez
+     * @param i Linha
+     */
+    void clearRow(size_t i) {
+        for (size_t j = 0; j < numCols; j += colMask + 1) {
+            size_t count = std::min(colMask + 1, numCols - j);
+            std::memset(locate(i, j), 0, count * sizeof(float));
+        }
+    }
+
+    /**
+     * @brief Obtém o limite de memória dos blocos mapeados
+     * @return size_t Quantidade de bytes
+     */
+    size_t residentBytes() const {
+        return std::min(mappedBytes, residentTiles.size() * tileFloats * sizeof(float));
+    }
+};
+
+} // namespace capted
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Index Array
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Visão de um array dentro de um buffer alocado por outra classe (não
+ *        é dona da memória). Com Stride > 1 os elementos ficam intercalados com
+ *        outros campos do mesmo nó, a cada Stride posições.
+ *
+ * @tparam T Tipo dos elementos
+ * @tparam Stride Distância, em elementos, entre posições consecutivas
+ */
+template<class T, size_t Stride = 1>
+class IndexArray {
+private:
+    T* first;
+    size_t length;
+
+public:
+    IndexArray() : first(nullptr), length(0) { }
+
+    IndexArray(T* first, size_t length) : first(first), length(length) { }
+
+    T &operator[](size_t i) const {
+        return first[i * Stride];
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    /**
+     * @brief Copia os elementos para um vetor contíguo
+     */
+    std::vector<T> toVector() const {
+        std::vector<T> values(length);
+        for (size_t i = 0; i < length; i++) {
+            values[i] = (*this)[i];
+        }
+        return values;
+    }
+};
+
+//------------------------------------------------------------------------------
+// Child Lists (CSR)
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Filhos de um nó: intervalo contíguo dentro do array de alvos do CSR
+ */
+template<class T>
+class ChildRange {
+private:
+    const T* first;
+    const T* last;
+
+public:
+    ChildRange(const T* first, const T* last) : first(first), last(last) { }
+
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const T &operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * @brief Listas de filhos em formato CSR: os filhos do nó i estão em
+ *        targets[offsets[i]] até targets[offsets[i + 1] - 1]
+ */
+template<class T>
+class ChildLists {
+private:
+    const T* offsets;
+    const T* targets;
+    size_t length;
+
+public:
+    ChildLists() : offsets(nullptr), targets(nullptr), length(0) { }
+
+    ChildLists(const T* offsets, const T* targets, size_t length)
+        : offsets(offsets), targets(targets), length(length) { }
+
+    ChildRange<T> operator[](size_t i) const {
+        return ChildRange<T>(targets + offsets[i], targets + offsets[i + 1]);
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
+
+//------------------------------------------------------------------------------
+// arrayToString
+//------------------------------------------------------------------------------
+
+template<class T, size_t Stride>
+std::string arrayToString(const IndexArray<T, Stride> &array) {
+    std::stringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < array.size(); i++) {
+        if (i > 0) {
+            ss << ", ";
+        }
+        // + imprime uint8_t como número.
+        ss << +array[i];
+    }
+    ss << "]";
+    return ss.str();
+}
+
+template<class T>
+std::string arrayToString(const ChildLists<T> &lists) {
+    std::stringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (i > 0) {
+            ss << ", ";
+        }
+        ss << "[";
+        for (size_t j = 0; j < lists[i].size(); j++) {
+            ss << (j > 0 ? ", " : "") << lists[i][j];
+        }
+        ss << "]";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+} // namespace capted
@@ -0,0 +1,92 @@
+#pragma once
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Instrumentação
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Eventos contados por CountingInstrumentation em um cálculo
+ */
+struct InstrumentationCounts {
+    long cells = 0;        /**< Subproblemas (posições de forestdist, s ou t) calculados */
+    long deltaReads = 0;   /**< Leituras de delta (treedist no Zhang-Shasha) */
+    long deltaWrites = 0;  /**< Escritas em delta (treedist no Zhang-Shasha) */
+    long spfCalls = 0;     /**< Chamadas de spf (pares de keyroots no Zhang-Shasha) */
+
+    /**
+     * @brief Obtém os acessos à matriz de distâncias entre subárvores
+     * @return long Leituras mais escritas
+     */
+    long memoryAccesses() const {
+        return deltaReads + deltaWrites;
+    }
+
+    InstrumentationCounts& operator+=(const InstrumentationCounts& other) {
+        cells += other.cells;
+        deltaReads += other.deltaReads;
+        deltaWrites += other.deltaWrites;
+        spfCalls += other.spfCalls;
+        return *this;
+    }
+};
+
+/**
+ * @brief Política de instrumentação sem efeito, usada por padrão por Apted e
+ *        ForestDist: os métodos são vazios e somem na compilação otimizada.
+ */
+class NoInstrumentation {
+public:
+    void cells(long) {}
+    void deltaRead() {}
+    void deltaWrite() {}
+    void spfCall() {}
+    void reset() {}
+    void merge(const NoInstrumentation &) {}
+
+    InstrumentationCounts counts() const {
+        return InstrumentationCounts();
+    }
+};
+
+/**
+ * @brief Política de instrumentação que conta os eventos. Cada instância de
+ *        Apted ou ForestDist tem a sua (e cada thread do ForestDist também,
+ *        somadas com merge ao final), então não há contadores compartilhados.
+ */
+class CountingInstrumentation {
+private:
+    InstrumentationCounts total;
+
+public:
+    void cells(long count) {
+        total.cells += count;
+    }
+
+    void deltaRead() {
+        total.deltaReads++;
+    }
+
+    void deltaWrite() {
+        total.deltaWrites++;
+    }
+
+    void spfCall() {
+        total.spfCalls++;
+    }
+
+    void reset() {
+        total = InstrumentationCounts();
+    }
+
+    void merge(const CountingInstrumentation &other) {
+        total += other.total;
+    }
+
+    const InstrumentationCounts& counts() const {
+        return total;
+    }
+};
+
+} // namespace capted
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Label Dictionary
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Internaliza rótulos, associando cada rótulo distinto a um identificador
+ *        inteiro denso (0, 1, 2, ...), na ordem em que aparecem pela primeira vez.
+ */
+class LabelDictionary {
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<const std::string*> labels;
+
+public:
+    LabelDictionary() { }
+
+    LabelDictionary(const LabelDictionary&) = delete;
+    LabelDictionary& operator=(const LabelDictionary&) = delete;
+
+    /**
+     * @brief Obtém o identificador de um rótulo, criando-o se ainda não existe
+     * @param label Rótulo
+     * @return uint32_t Identificador do rótulo
+     */
+    uint32_t intern(const std::string &label) {
+        auto inserted = ids.emplace(label, (uint32_t)labels.size());
+        if (inserted.second) {
+            labels.push_back(&inserted.first->first);
+        }
+        return inserted.first->second;
+    }
+
+    /**
+     * @brief Procura o identificador de um rótulo sem inseri-lo
+     * @param label Rótulo
+     * @param id Recebe o identificador, se encontrado
+     * @return true Se o rótulo já foi internalizado
+     */
+    bool find(const std::string &label, uint32_t &id) const {
+        auto it = ids.find(label);
+        if (it == ids.end()) {
+            return false;
+        }
+        id = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Obtém o rótulo de um identificador
+     * @param id Identificador do rótulo
+     * @return const std::string& Rótulo
+     */
+    const std::string &label(uint32_t id) const {
+        return *labels[id];
+    }
+
+    /**
+     * @brief Obtém a quantidade de rótulos distintos
+     * @return size_t Quantidade de rótulos
+     */
+    size_t size() const {
+        return labels.size();
+    }
+};
+
+} // namespace capted
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Sequence Edit Distance
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Distância de edição (Levenshtein, custos unitários) entre sequências de
+ *        identificadores inteiros, pelo algoritmo paralelo em bits de Myers com
+ *        a divisão em blocos de Hyyrö: cada coluna da matriz de programação
+ *        dinâmica é guardada como diferenças verticais (+1/-1) em palavras de 64
+ *        bits, e um símbolo do texto atualiza 64 linhas por operação. O custo é
+ *        O(n * ceil(m / 64)), com m o tamanho da menor sequência.
+ *
+ *        Os identificadores devem ser densos (ex.: obtidos de LabelDictionary),
+ *        pois indexam diretamente a tabela de ocorrências.
+ *
+ *        Referências:
+ *        - G. Myers. A fast bit-vector algorithm for approximate string matching
+ *          based on dynamic programming. Journal of the ACM 46(3). 1999.
+ *        - H. Hyyrö. A bit-vector algorithm for computing Levenshtein and
+ *          Damerau edit distances. Nordic Journal of Computing 10. 2003.
+ */
+class SequenceEditDistance {
+private:
+    static constexpr unsigned WORD_BITS = 64;
+
+    // Reaproveitados entre chamadas.
+    std::vector<int32_t> slotOfSymbol;  /**< Linha de peq de cada símbolo do padrão, -1 se ausente */
+    std::vector<uint64_t> peq;          /**< Bits das posições de cada símbolo no padrão, por bloco */
+    std::vector<uint64_t> positive;     /**< Diferenças verticais +1 de cada bloco */
+    std::vector<uint64_t> negative;     /**< Diferenças verticais -1 de cada bloco */
+
+    /**
+     * @brief Avança um bloco de 64 linhas por uma coluna
+     *
+     * @param block Índice do bloco
+     * @param eq Bits das linhas cujo símbolo é igual ao da coluna
+     * @param hin Diferença horizontal que entra pela linha acima do bloco (-1, 0 ou +1)
+     * @param high Bit da linha cuja diferença horizontal é devolvida
+     * @return int Diferença horizontal na linha high
+     */
+    int advanceBlock(size_t block, uint64_t eq, int hin, uint64_t high) {
+        uint64_t pv = positive[block];
+        uint64_t mv = negative[block];
+        uint64_t hinIsNegative = hin < 0 ? 1 : 0;
+
+        uint64_t xv = eq | mv;
+        eq |= hinIsNegative;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        int hout = 0;
+        if (ph & high) {
+            hout = 1;
+        } else if (mh & high) {
+            hout = -1;
+        }
+
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0) {
+            mh |= 1;
+        } else if (hin > 0) {
+            ph |= 1;
+        }
+
+        positive[block] = mh | ~(xv | ph);
+        negative[block] = ph & xv;
+        return hout;
+    }
+
+public:
+    /**
+     * @brief Calcula a distância de edição entre duas sequências
+     *
+     * @param a Primeira sequência
+     * @param b Segunda sequência
+     * @return size_t Quantidade mínima de inserções, remoções e substituições
+     */
+    size_t compute(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) {
+        // O padrão (linhas) é a menor sequência, para usar menos blocos.
+        const std::vector<uint32_t> &pattern = a.size() <= b.size() ? a : b;
+        const std::vector<uint32_t> &text = a.size() <= b.size() ? b : a;
+        const size_t m = pattern.size();
+        const size_t n = text.size();
+        if (m == 0) {
+            return n;
+        }
+
+        const size_t numBlocks = (m + WORD_BITS - 1) / WORD_BITS;
+
+        // Uma linha de peq por símbolo distinto do padrão, mais a linha 0, vazia,
+        // usada pelos símbolos do texto que não aparecem no padrão.
+        uint32_t maxSymbol = 0;
+        for (uint32_t symbol : pattern) {
+            maxSymbol = std::max(maxSymbol, symbol);
+        }
+        slotOfSymbol.assign((size_t)maxSymbol + 1, -1);
+        size_t numSlots = 1;
+        for (uint32_t symbol : pattern) {
+            if (slotOfSymbol[symbol] < 0) {
+                slotOfSymbol[symbol] = numSlots++;
+            }
+        }
+        peq.assign(numSlots * numBlocks, 0);
+        for (size_t i = 0; i < m; i++) {
+            peq[slotOfSymbol[pattern[i]] * numBlocks + i / WORD_BITS] |= (uint64_t)1 << (i % WORD_BITS);
+        }
+
+        // Coluna 0: D[i][0] = i, todas as diferenças verticais são +1.
+        positive.assign(numBlocks, ~(uint64_t)0);
+        negative.assign(numBlocks, 0);
+
+        const uint64_t blockHigh = (uint64_t)1 << (WORD_BITS - 1);
+        const uint64_t lastHigh = (uint64_t)1 << ((m - 1) % WORD_BITS);
+        size_t score = m;
+
+        for (size_t j = 0; j < n; j++) {
+            size_t slot = text[j] < slotOfSymbol.size() && slotOfSymbol[text[j]] >= 0 ? slotOfSymbol[text[j]] : 0;
+            const uint64_t* eq = &peq[slot * numBlocks];
+
+            // Linha 0: D[0][j] = j, a diferença horizontal é sempre +1.
+            int carry = 1;
+            for (size_t block = 0; block + 1 < numBlocks; block++) {
+                carry = advanceBlock(block, eq[block], carry, blockHigh);
+            }
+            score += advanceBlock(numBlocks - 1, eq[numBlocks - 1], carry, lastHigh);
+        }
+
+        return score;
+    }
+};
+
+} // namespace capted
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace capted {
+
+//------------------------------------------------------------------------------
+// Thread Pool
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Conjunto fixo de threads que executa tarefas de uma fila FIFO.
+ *        As tarefas não devem lançar exceções; quem precisa reportar erros
+ *        deve capturá-los dentro da própria tarefa.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable hasTask;
+    std::condition_variable idle;
+    size_t running = 0;
+    bool stopping = false;
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                hasTask.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                running++;
+            }
+
+            task();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (running == 0 && tasks.empty()) {
+                idle.notify_all();
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Construtor da classe ThreadPool
+     * @param threads Quantidade de threads; 0 usa std::thread::hardware_concurrency()
+     */
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back(&ThreadPool::work, this);
+        }
+    }
+
+    /**
+     * @brief Termina as tarefas pendentes e encerra as threads
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        hasTask.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Obtém a quantidade de threads
+     */
+    size_t size() const {
+        return workers.size();
+    }
+
+    /**
+     * @brief Enfileira uma tarefa
+     * @param task Tarefa a ser executada por alguma thread
+     */
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        hasTask.notify_one();
+    }
+
+    /**
+     * @brief Bloqueia até que a fila esteja vazia e nenhuma tarefa esteja em execução
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return running == 0 && tasks.empty(); });
+    }
+
+    /**
+     * @brief Executa body(i) para i em [0, count), distribuindo os índices entre
+     *        as threads sob demanda, e espera o término
+     * @param count Quantidade de índices
+     * @param body Função chamada para cada índice
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)> &body) {
+        std::atomic<size_t> next(0);
+        size_t chunks = std::min(count, workers.size());
+        for (size_t c = 0; c < chunks; c++) {
+            submit([&next, count, &body] {
+                for (size_t i = next++; i < count; i = next++) {
+                    body(i);
+                }
+            });
+        }
+        wait();
+    }
+};
+
+} // namespace capted
@@ -1,41 +1,123 @@
-// NodeZHSH.cpp
-#include "NodeZHSH.hpp"
-
-/**
- * @file Node_ZHSH.cpp
- * @author Bernardo Marques
- * @author Bruno Santiago
- * @author Fabio Freire
- * @author Marcos Antônio Lommez
- * @author Saulo de Moura
- * @brief Classe para representar um nó da árvore para o algoritmo Zhang-Shasha
- * @date 2024-06-22
- * 
- * Algoritmo original retirado de:
- * <p>See the source code para mais comentários relacionados ao algoritmo.
- *
- * <p>Referências:
- * <ul>
- * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
- *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
- * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
- *      efficient. Information Systems 56. 2016.
- * </ul>
- * 
- * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
- * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
- * 
- * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
- */
-
-/**
- * @brief Construtor padrão da classe NodeZHSH.
- */
-NodeZHSH::NodeZHSH() : index(0), leftmost(nullptr) {}
-
-/**
- * @brief Construtor que inicializa o rótulo do nó.
- * 
- * @param label Rótulo do nó.
- */
-NodeZHSH::NodeZHSH(const std::string& label) : label(label), index(0), leftmost(nullptr) {}
+// NodeZHSH.cpp
+#include "NodeZHSH.hpp"
+
+/**
+ * @file Node_ZHSH.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Classe para representar um nó da árvore para o algoritmo Zhang-Shasha
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+/**
+ * @brief Construtor padrão da classe NodeZHSH.
+ */
+NodeZHSH::NodeZHSH() : index(0), leftmost(nullptr) {}
+
+/**
+ * @brief Construtor que inicializa o rótulo do nó.
+ * 
+ * @param label Rótulo do nó.
+ */
+NodeZHSH::NodeZHSH(const std::string& label) : label(label), index(0), leftmost(nullptr) {}
+
+
+/**
+ * @brief Construtor da classe TreeZHSH, com a árvore vazia.
+ */
+TreeZHSH::TreeZHSH() {}
+
+/**
+ * @brief Cria um nó na arena da árvore.
+ * 
+ * @param label Rótulo do nó.
+ * @return Ponteiro para o nó, válido até clear() ou a destruição da árvore.
+ */
+NodeZHSH* TreeZHSH::createNode(const std::string& label) {
+    nodes.emplace_back(label);
+    return &nodes.back();
+}
+
+/**
+ * @brief Descarta os nós atuais e lê uma árvore em notação de chaves, sem
+ *        recursão, para aceitar árvores profundas.
+ * 
+ * @param str Árvore em notação de chaves.
+ * @return Raiz da árvore, ou nullptr se str não tem nós.
+ */
+NodeZHSH* TreeZHSH::parse(const std::string& str) {
+    clear();
+    std::vector<NodeZHSH*> stack; // Caminho da raiz até o nó aberto atual
+    size_t pos = 0;
+    while (pos < str.size()) {
+        if (str[pos] == '}') {
+            ++pos;
+            if (!stack.empty()) {
+                stack.pop_back();
+                if (stack.empty()) {
+                    break; // Fim da raiz
+                }
+            }
+            continue;
+        }
+        if (str[pos] == '{') {
+            ++pos;
+        }
+
+        size_t start = pos;
+        while (pos < str.size() && str[pos] != '{' && str[pos] != '}') {
+            ++pos;
+        }
+
+        NodeZHSH* node = createNode(str.substr(start, pos - start));
+        if (!stack.empty()) {
+            stack.back()->children.push_back(node);
+        }
+        stack.push_back(node);
+    }
+    return getRoot();
+}
+
+/**
+ * @brief Obtém a raiz da árvore.
+ * 
+ * @return Ponteiro para a raiz, ou nullptr se a árvore está vazia.
+ */
+NodeZHSH* TreeZHSH::getRoot() {
+    return nodes.empty() ? nullptr : &nodes.front();
+}
+
+/**
+ * @brief Obtém a quantidade de nós da árvore.
+ * 
+ * @return Quantidade de nós.
+ */
+size_t TreeZHSH::size() const {
+    return nodes.size();
+}
+
+/**
+ * @brief Libera todos os nós da árvore.
+ */
+void TreeZHSH::clear() {
+    nodes.clear();
+}
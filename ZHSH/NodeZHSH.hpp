@@ -1,48 +1,84 @@
-#ifndef NodeZHSH_HPP
-#define NodeZHSH_HPP
-
-/**
- * @file forest_dist.hpp
- * @author Bernardo Marques
- * @author Bruno Santiago
- * @author Fabio Freire
- * @author Marcos Antônio Lommez
- * @author Saulo de Moura
- * @brief Classe modelo para representar um nó da árvore para o algoritmo Zhang-Shasha
- * @date 2024-06-22
- * 
- * Algoritmo original retirado de:
- * <p>See the source code para mais comentários relacionados ao algoritmo.
- *
- * <p>Referências:
- * <ul>
- * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
- *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
- * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
- *      efficient. Information Systems 56. 2016.
- * </ul>
- * 
- * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
- * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
- * 
- * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
- */
-
-#include <string>
-#include <vector>
-
-class NodeZHSH {
-public:
-    std::string label; // Rótulo do nó, representado por uma string
-    int index; // Índice do nó, representado por um inteiro
-    std::vector<NodeZHSH*> children; // Vetor de ponteiros para os nós filhos
-    NodeZHSH* leftmost; // Ponteiro para o nó filho mais à esquerda
-
-    // Construtor padrão
-    NodeZHSH();
-    
-    // Construtor que inicializa o rótulo do nó
-    NodeZHSH(const std::string& label);
-};
-
-#endif 
+#ifndef NodeZHSH_HPP
+#define NodeZHSH_HPP
+
+/**
+ * @file forest_dist.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Classe modelo para representar um nó da árvore para o algoritmo Zhang-Shasha
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * Nó da árvore do Zhang-Shasha. O nó não libera os filhos: use TreeZHSH para
+ * criar os nós de uma árvore e liberá-los todos de uma vez.
+ */
+class NodeZHSH {
+public:
+    std::string label; // Rótulo do nó, representado por uma string
+    int index; // Índice do nó, representado por um inteiro
+    std::vector<NodeZHSH*> children; // Vetor de ponteiros para os nós filhos
+    NodeZHSH* leftmost; // Ponteiro para o nó filho mais à esquerda
+
+    // Construtor padrão
+    NodeZHSH();
+    
+    // Construtor que inicializa o rótulo do nó
+    NodeZHSH(const std::string& label);
+};
+
+/**
+ * Árvore de NodeZHSH dona dos próprios nós, guardados em blocos contíguos
+ * (arena). Os ponteiros continuam válidos até clear() ou a destruição da árvore,
+ * que liberam todos os nós, sem percorrer a árvore.
+ */
+class TreeZHSH {
+public:
+    TreeZHSH();
+
+    TreeZHSH(const TreeZHSH&) = delete;
+    TreeZHSH& operator=(const TreeZHSH&) = delete;
+
+    // Cria um nó sem pai; o primeiro nó criado é a raiz
+    NodeZHSH* createNode(const std::string& label);
+
+    // Descarta todos os nós e lê uma árvore em notação de chaves, ex.: {a{b}{c}}
+    NodeZHSH* parse(const std::string& str);
+
+    // Raiz da árvore, ou nullptr se vazia
+    NodeZHSH* getRoot();
+
+    // Quantidade de nós
+    size_t size() const;
+
+    // Descarta todos os nós
+    void clear();
+
+private:
+    std::deque<NodeZHSH> nodes; // Endereços estáveis ao crescer
+};
+
+#endif 
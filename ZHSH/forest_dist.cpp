@@ -1,115 +1,280 @@
-/**
- * @file forest_dist.cpp
- * @author Bernardo Marques
- * @author Bruno Santiago
- * @author Fabio Freire
- * @author Marcos Antônio Lommez
- * @author Saulo de Moura
- * @brief Classe para calcular a distância entre duas árvores utilizando o algoritmo Zhang-Shasha
- * @date 2024-06-22
- * 
- * Algoritmo original retirado de:
- * <p>See the source code para mais comentários relacionados ao algoritmo.
- *
- * <p>Referências:
- * <ul>
- * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
- *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
- * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
- *      efficient. Information Systems 56. 2016.
- * </ul>
- * 
- * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
- * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
- * 
- * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
- */
-
-#include "../includes/MemoryAccessTracker.hpp"
-#include "forest_dist.hpp"
-#include "NodeZHSH.hpp"
-#include <vector>
-#include <algorithm>
-
-
-/**
- * @brief Função para calcular os índices dos nós mais à esquerda.
- * 
- * @param nodes Vetor de nós.
- * @return Vetor de inteiros representando os índices dos nós mais à esquerda.
- */
-std::vector<int> ForestDist::computeLeftmost(const std::vector<NodeZHSH*>& nodes) {
-    std::vector<int> leftmost(nodes.size());
-    for (int i = nodes.size() - 1; i >= 0; --i) {
-        if (nodes[i]->children.empty()) {
-            leftmost[i] = i; // Se o nó não tiver filhos, ele é o mais à esquerda
-        } else {
-            leftmost[i] = leftmost[nodes[i]->children.front()->index]; // Caso contrário, é o índice do filho mais à esquerda
-        }
-    }
-    return leftmost;
-}
-
-/**
- * @brief Função para pré-processar os nós da árvore.
- * 
- * @param root Raiz da árvore.
- * @param nodes Vetor para armazenar os nós na ordem de travessia pós-ordem.
- */
-void ForestDist::preprocessNodes(NodeZHSH* root, std::vector<NodeZHSH*>& nodes) {
-    if (root == nullptr) return; // Se a raiz for nula, não faz nada
-    for (NodeZHSH* child : root->children) {
-        preprocessNodes(child, nodes); // Chama recursivamente para cada filho
-    }
-    root->index = nodes.size(); // Define o índice do nó como o tamanho atual do vetor
-    nodes.push_back(root); // Adiciona o nó ao vetor
-}
-
-/**
- * @brief Função para calcular a distância entre duas árvores utilizando programação dinâmica.
- * 
- * @param root1 Raiz da primeira árvore.
- * @param root2 Raiz da segunda árvore.
- * @return Distância de edição entre as duas árvores.
- */
-int ForestDist::treeDist(NodeZHSH* root1, NodeZHSH* root2) {
-    if (root1 == nullptr || root2 == nullptr) return 0; // Se alguma das raízes for nula, a distância é 0
-    std::vector<NodeZHSH*> nodes1, nodes2;
-    preprocessNodes(root1, nodes1); // Pré-processa os nós da primeira árvore
-    preprocessNodes(root2, nodes2); // Pré-processa os nós da segunda árvore
-
-    std::vector<int> leftmost1 = computeLeftmost(nodes1); // Calcula os nós mais à esquerda para a primeira árvore
-    std::vector<int> leftmost2 = computeLeftmost(nodes2); // Calcula os nós mais à esquerda para a segunda árvore
-
-    return forestDist(nodes1, nodes2); // Calcula e retorna a distância entre as duas árvores
-}
-
-/**
- * @brief Função para calcular a distância entre duas florestas utilizando programação dinâmica.
- * 
- * @param forest1 Vetor de nós representando a primeira floresta.
- * @param forest2 Vetor de nós representando a segunda floresta.
- * @return Distância de edição entre as duas florestas.
- */
-int ForestDist::forestDist(const std::vector<NodeZHSH*>& forest1, const std::vector<NodeZHSH*>& forest2) {
-    MAT.reset(); // Reseta o contador de acessos à memória
-    int m = forest1.size();
-    int n = forest2.size();
-    std::vector<std::vector<int>> dist(m + 1, std::vector<int>(n + 1)); // Matriz para armazenar as distâncias
-    for (int i = 1; i <= m; ++i) {
-        MAT.increment();
-        dist[i][0] = dist[i-1][0] + 1; // Custo de deletar nó
-    }
-    for (int j = 1; j <= n; ++j) {
-        MAT.increment();
-        dist[0][j] = dist[0][j-1] + 1; // Custo de inserir nó
-    }
-    for (int i = 1; i <= m; ++i) {
-        for (int j = 1; j <= n; ++j) {
-            int cost = (forest1[i-1]->label == forest2[j-1]->label) ? 0 : 1; // Custo de substituição (0 se os rótulos forem iguais, 1 se forem diferentes)
-            dist[i][j] = std::min({dist[i-1][j] + 1, dist[i][j-1] + 1, dist[i-1][j-1] + cost}); // Mínimo entre deletar, inserir ou substituir
-            MAT.increment();
-        }
-    }
-    return dist[m][n]; // Retorna a distância entre as duas florestas
-}
\ No newline at end of file
+/**
+ * @file forest_dist.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Classe para calcular a distância entre duas árvores utilizando o algoritmo Zhang-Shasha
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include "forest_dist.hpp"
+#include "NodeZHSH.hpp"
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+
+/**
+ * @brief Função para calcular os índices dos nós mais à esquerda.
+ * 
+ * @param nodes Vetor de nós.
+ * @return Vetor de inteiros representando os índices dos nós mais à esquerda.
+ */
+template<class Instrumentation>
+std::vector<int> BasicForestDist<Instrumentation>::computeLeftmost(const std::vector<NodeZHSH*>& nodes) {
+    std::vector<int> leftmost(nodes.size());
+    // Em pós-ordem os filhos vêm antes do pai, então leftmost dos filhos já está calculado.
+    for (int i = 0; i < (int)nodes.size(); ++i) {
+        if (nodes[i]->children.empty()) {
+            leftmost[i] = i; // Se o nó não tiver filhos, ele é o mais à esquerda
+        } else {
+            leftmost[i] = leftmost[nodes[i]->children.front()->index]; // Caso contrário, é o índice do filho mais à esquerda
+        }
+    }
+    return leftmost;
+}
+
+/**
+ * @brief Função para pré-processar os nós da árvore.
+ * 
+ * @param root Raiz da árvore.
+ * @param nodes Vetor para armazenar os nós na ordem de travessia pós-ordem.
+ */
+template<class Instrumentation>
+void BasicForestDist<Instrumentation>::preprocessNodes(NodeZHSH* root, std::vector<NodeZHSH*>& nodes) {
+    if (root == nullptr) return; // Se a raiz for nula, não faz nada
+    // Pilha explícita de (nó, próximo filho), para não estourar a pilha de chamadas em árvores profundas.
+    std::vector<std::pair<NodeZHSH*, size_t>> stack;
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+        NodeZHSH* node = stack.back().first;
+        size_t next = stack.back().second;
+        if (next < node->children.size()) {
+            stack.back().second++;
+            stack.push_back({node->children[next], 0}); // Visita os filhos antes do nó
+            continue;
+        }
+        node->index = nodes.size(); // Define o índice do nó como o tamanho atual do vetor
+        nodes.push_back(node); // Adiciona o nó ao vetor
+        stack.pop_back();
+    }
+}
+
+/**
+ * @brief Função para calcular as keyroots de uma árvore: a raiz e todo nó que
+ *        tem um irmão à esquerda, ou seja, o maior nó de cada valor de leftmost.
+ * 
+ * @param leftmost Índices dos nós mais à esquerda, em pós-ordem.
+ * @return Vetor com as keyroots em ordem crescente de pós-ordem.
+ */
+template<class Instrumentation>
+std::vector<int> BasicForestDist<Instrumentation>::computeKeyroots(const std::vector<int>& leftmost) {
+    std::vector<bool> seen(leftmost.size(), false);
+    std::vector<int> keyroots;
+    for (int i = leftmost.size() - 1; i >= 0; --i) {
+        if (!seen[leftmost[i]]) {
+            seen[leftmost[i]] = true; // O primeiro nó visto de cada folha mais à esquerda é a keyroot
+            keyroots.push_back(i);
+        }
+    }
+    std::reverse(keyroots.begin(), keyroots.end()); // Subárvores menores primeiro
+    return keyroots;
+}
+
+/**
+ * @brief Função para calcular a keyroot pai de cada keyroot: a menor keyroot
+ *        cuja subárvore contém a dela. As subárvores [leftmost[k], k] são
+ *        intervalos aninhados, então uma pilha em ordem crescente basta.
+ * 
+ * @param keyroots Keyroots em ordem crescente de pós-ordem.
+ * @param leftmost Índices dos nós mais à esquerda, em pós-ordem.
+ * @return Posição em keyroots da keyroot pai de cada keyroot, -1 para a raiz.
+ */
+template<class Instrumentation>
+std::vector<int> BasicForestDist<Instrumentation>::computeKeyrootParents(const std::vector<int>& keyroots, const std::vector<int>& leftmost) {
+    std::vector<int> parents(keyroots.size(), -1);
+    std::vector<int> open; // Keyroots ainda sem pai, das mais internas para as mais externas
+    for (int a = 0; a < (int)keyroots.size(); ++a) {
+        while (!open.empty() && leftmost[keyroots[open.back()]] >= leftmost[keyroots[a]]) {
+            parents[open.back()] = a; // A subárvore de keyroots[a] contém a da keyroot aberta
+            open.pop_back();
+        }
+        open.push_back(a);
+    }
+    return parents;
+}
+
+/**
+ * @brief Função para escolher em qual linha do buffer forestdist fica cada linha
+ *        da keyroot k1. A linha r (floresta l1..l1 + r - 1) é lida pela linha
+ *        r + 1 e pelas linhas dos nós i com leftmost1[i] = l1 + r; depois da
+ *        última leitura, a linha do buffer volta a ficar livre. Assim ficam em
+ *        uso linhas proporcionais à altura da subárvore de k1, e não k1 - l1 + 2.
+ * 
+ * @param k1 Keyroot da primeira árvore.
+ * @param ws Buffers que recebem a escolha, com forestdist aumentado se preciso.
+ */
+template<class Instrumentation>
+void BasicForestDist<Instrumentation>::computeRowSlots(int k1, Workspace& ws) {
+    const int l1 = leftmost1[k1];
+    const int rows = k1 - l1 + 2;
+
+    // lastRead[r] guardado temporariamente em ws.rowSlot.
+    ws.rowSlot.resize(rows);
+    for (int r = 0; r < rows; ++r) {
+        ws.rowSlot[r] = std::min(r + 1, rows - 1);
+    }
+    for (int i = l1; i <= k1; ++i) {
+        int r = leftmost1[i] - l1;
+        ws.rowSlot[r] = std::max(ws.rowSlot[r], i - l1 + 1);
+    }
+
+    ws.releaseHead.assign(rows, -1);
+    ws.releaseNext.resize(rows);
+    for (int r = 0; r < rows; ++r) {
+        ws.releaseNext[r] = ws.releaseHead[ws.rowSlot[r]];
+        ws.releaseHead[ws.rowSlot[r]] = r;
+    }
+
+    ws.freeSlots.clear();
+    int numSlots = 0;
+    for (int r = 0; r < rows; ++r) {
+        if (ws.freeSlots.empty()) {
+            ws.rowSlot[r] = numSlots++;
+        } else {
+            ws.rowSlot[r] = ws.freeSlots.back();
+            ws.freeSlots.pop_back();
+        }
+        // Linhas cuja última leitura é a linha r: livres depois dela.
+        for (int released = ws.releaseHead[r]; released != -1; released = ws.releaseNext[released]) {
+            ws.freeSlots.push_back(ws.rowSlot[released]);
+        }
+    }
+    ws.keyroot = k1;
+    size_t floats = (size_t)numSlots * (leftmost2.size() + 1);
+    if (ws.forestdist.size() < floats) {
+        ws.forestdist.resize(floats);
+    }
+}
+
+/**
+ * @brief Função para calcular a distância entre duas árvores com custos unitários.
+ * 
+ * @param root1 Raiz da primeira árvore.
+ * @param root2 Raiz da segunda árvore.
+ * @return Distância de edição entre as duas árvores.
+ */
+template<class Instrumentation>
+float BasicForestDist<Instrumentation>::treeDist(NodeZHSH* root1, NodeZHSH* root2) {
+    UnitCostModelZHSH costModel;
+    return treeDist(root1, root2, costModel);
+}
+
+/**
+ * @brief Função para calcular a distância entre duas árvores NodeZHSH com o
+ *        modelo de custo dado.
+ * 
+ * @param root1 Raiz da primeira árvore.
+ * @param root2 Raiz da segunda árvore.
+ * @param costModel Custos das operações de edição.
+ * @return Distância de edição entre as duas árvores.
+ */
+template<class Instrumentation>
+float BasicForestDist<Instrumentation>::treeDist(NodeZHSH* root1, NodeZHSH* root2, const CostModelZHSH& costModel) {
+    nodes1.clear();
+    nodes2.clear();
+    preprocessNodes(root1, nodes1); // Pré-processa os nós da primeira árvore
+    preprocessNodes(root2, nodes2); // Pré-processa os nós da segunda árvore
+
+    leftmost1 = computeLeftmost(nodes1); // Calcula os nós mais à esquerda para a primeira árvore
+    leftmost2 = computeLeftmost(nodes2); // Calcula os nós mais à esquerda para a segunda árvore
+
+    deleteCosts.resize(nodes1.size());
+    insertCosts.resize(nodes2.size());
+    for (size_t i = 0; i < nodes1.size(); ++i) {
+        deleteCosts[i] = costModel.deleteCost(nodes1[i]);
+    }
+    for (size_t j = 0; j < nodes2.size(); ++j) {
+        insertCosts[j] = costModel.insertCost(nodes2[j]);
+    }
+
+    return zhangShasha([&](int i, int j) {
+        return costModel.renameCost(nodes1[i], nodes2[j]);
+    });
+}
+
+/**
+ * @brief Função para definir as threads usadas no cálculo dos pares de keyroots.
+ * 
+ * @param pool Threads, ou nullptr para calcular só na thread atual.
+ */
+template<class Instrumentation>
+void BasicForestDist<Instrumentation>::setThreadPool(capted::ThreadPool* pool) {
+    this->pool = pool;
+}
+
+/**
+ * @brief Função para obter a memória ocupada pelos buffers de um Workspace.
+ * 
+ * @return Quantidade de bytes.
+ */
+template<class Instrumentation>
+size_t BasicForestDist<Instrumentation>::Workspace::sizeInBytes() const {
+    return forestdist.capacity() * sizeof(float)
+         + (rowSlot.capacity() + releaseHead.capacity() + releaseNext.capacity() + freeSlots.capacity()) * sizeof(int);
+}
+
+/**
+ * @brief Função para obter a memória ocupada pelos buffers reaproveitados.
+ * 
+ * @return Quantidade de bytes.
+ */
+template<class Instrumentation>
+size_t BasicForestDist<Instrumentation>::sizeInBytes() const {
+    size_t bytes = (nodes1.capacity() + nodes2.capacity()) * sizeof(NodeZHSH*)
+                 + (leftmost1.capacity() + leftmost2.capacity()) * sizeof(int)
+                 + (deleteCosts.capacity() + insertCosts.capacity() + treedist.capacity()) * sizeof(float)
+                 + workspace.sizeInBytes();
+    for (const std::unique_ptr<Workspace>& spare : spareWorkspaces) {
+        bytes += spare->sizeInBytes();
+    }
+    return bytes;
+}
+
+/**
+ * @brief Função para liberar os buffers reaproveitados entre chamadas.
+ */
+template<class Instrumentation>
+void BasicForestDist<Instrumentation>::releaseBuffers() {
+    std::vector<NodeZHSH*>().swap(nodes1);
+    std::vector<NodeZHSH*>().swap(nodes2);
+    std::vector<int>().swap(leftmost1);
+    std::vector<int>().swap(leftmost2);
+    std::vector<float>().swap(deleteCosts);
+    std::vector<float>().swap(insertCosts);
+    std::vector<float>().swap(treedist);
+    workspace = Workspace();
+    spareWorkspaces.clear();
+}
+
+// Políticas de instrumentação disponíveis para ForestDist.
+template class BasicForestDist<capted::NoInstrumentation>;
+template class BasicForestDist<capted::CountingInstrumentation>;
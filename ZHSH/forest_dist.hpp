@@ -1,54 +1,493 @@
-#ifndef FOREST_DIST_HPP
-#define FOREST_DIST_HPP
-
-/**
- * @file forest_dist.hpp
- * @author Bernardo Marques
- * @author Bruno Santiago
- * @author Fabio Freire
- * @author Marcos Antônio Lommez
- * @author Saulo de Moura
- * @brief Classe modelo para calcular a distância entre duas árvores utilizando o algoritmo Zhang-Shasha
- * @date 2024-06-22
- * 
- * Algoritmo original retirado de:
- * <p>See the source code para mais comentários relacionados ao algoritmo.
- *
- * <p>Referências:
- * <ul>
- * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
- *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
- * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
- *      efficient. Information Systems 56. 2016.
- * </ul>
- * 
- * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
- * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
- * 
- * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
- */
-
-#include <vector>
-#include "NodeZHSH.hpp"
-#include "../includes/MemoryAccessTracker.hpp"
-
-
-class ForestDist {
-public:
-
-    static MemoryAccessTracker MAT;
-
-    // Função que computa o nó mais à esquerda para um vetor de nós
-    static std::vector<int> computeLeftmost(const std::vector<NodeZHSH*>& nodes);
-    
-    //Essa função percorre a árvore a partir da raiz, armazenando os nós em um vetor na ordem de travessia pós-ordem.
-    static void preprocessNodes(NodeZHSH* root, std::vector<NodeZHSH*>& nodes);
-    
-    // Essa função calcula a distância de edição entre duas árvores, representadas por suas raízes.
-    static int treeDist(NodeZHSH* root1, NodeZHSH* root2);
-    
-    // Essa função calcula a distância de edição entre duas florestas, representadas por vetores de nós.
-    static int forestDist(const std::vector<NodeZHSH*>& forest1, const std::vector<NodeZHSH*>& forest2);
-};
-
-#endif // FOREST_DIST_HPP
+#ifndef FOREST_DIST_HPP
+#define FOREST_DIST_HPP
+
+/**
+ * @file forest_dist.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Classe modelo para calcular a distância entre duas árvores utilizando o algoritmo Zhang-Shasha
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "NodeZHSH.hpp"
+#include "../APTED/lib/CostModel.h"
+#include "../APTED/lib/node/NodeIndexer.h"
+#include "../APTED/lib/util/Instrumentation.h"
+#include "../APTED/lib/util/ThreadPool.h"
+
+/**
+ * @brief Custos das operações de edição para o algoritmo Zhang-Shasha, com a
+ *        mesma interface de capted::CostModel (deleteCost, insertCost, renameCost)
+ */
+class CostModelZHSH {
+public:
+    virtual ~CostModelZHSH() { }
+
+    // Custo de deletar o nó n
+    virtual float deleteCost(const NodeZHSH* n) const = 0;
+
+    // Custo de inserir o nó n
+    virtual float insertCost(const NodeZHSH* n) const = 0;
+
+    // Custo de renomear o nó n1 para n2
+    virtual float renameCost(const NodeZHSH* n1, const NodeZHSH* n2) const = 0;
+};
+
+/**
+ * @brief Custos unitários, iguais aos de capted::StringCostModel: inserir e
+ *        deletar custam 1 e renomear custa 0 se os rótulos são iguais, 1 caso contrário
+ */
+class UnitCostModelZHSH : public CostModelZHSH {
+public:
+    float deleteCost(const NodeZHSH*) const override {
+        return 1.0f;
+    }
+
+    float insertCost(const NodeZHSH*) const override {
+        return 1.0f;
+    }
+
+    float renameCost(const NodeZHSH* n1, const NodeZHSH* n2) const override {
+        return (n1->label == n2->label) ? 0.0f : 1.0f;
+    }
+};
+
+/**
+ * @brief Distância de edição de árvores pelo algoritmo Zhang-Shasha. A matriz
+ *        treedist é plana e a matriz forestdist guarda só as linhas que ainda
+ *        serão lidas (veja computeRowSlots). Os buffers ficam na instância e são
+ *        reaproveitados pelas chamadas seguintes, então uma instância por thread
+ *        evita realocações em lotes longos.
+ *
+ *        Com setThreadPool, os pares de keyroots independentes de uma mesma
+ *        comparação são calculados em paralelo (veja scheduleKeyrootPairs).
+ *
+ *        Instrumentation é a política de instrumentação (veja
+ *        capted::NoInstrumentation): em treedist, que faz o papel de delta do
+ *        APTED, conta leituras e escritas; cada par de keyroots conta como uma
+ *        chamada de spf. As políticas usadas precisam ser instanciadas em
+ *        forest_dist.cpp.
+ */
+template<class Instrumentation = capted::NoInstrumentation>
+class BasicForestDist {
+public:
+
+    // Comparações com menos posições em treedist que isso são calculadas em uma só thread.
+    static const size_t PARALLEL_MIN_CELLS = 1 << 14;
+
+    // Função que computa o nó mais à esquerda para um vetor de nós
+    static std::vector<int> computeLeftmost(const std::vector<NodeZHSH*>& nodes);
+
+    // Função que computa as keyroots (nós sem irmão à esquerda e a raiz) em ordem crescente de pós-ordem
+    static std::vector<int> computeKeyroots(const std::vector<int>& leftmost);
+
+    // Função que computa, para cada keyroot, a posição da menor keyroot que a contém (-1 para a raiz)
+    static std::vector<int> computeKeyrootParents(const std::vector<int>& keyroots, const std::vector<int>& leftmost);
+    
+    //Essa função percorre a árvore a partir da raiz, armazenando os nós em um vetor na ordem de travessia pós-ordem.
+    static void preprocessNodes(NodeZHSH* root, std::vector<NodeZHSH*>& nodes);
+    
+    // Essa função calcula a distância de edição entre duas árvores, representadas por suas raízes, com custos unitários.
+    float treeDist(NodeZHSH* root1, NodeZHSH* root2);
+
+    // Essa função calcula a distância de edição entre duas árvores com o modelo de custo dado.
+    float treeDist(NodeZHSH* root1, NodeZHSH* root2, const CostModelZHSH& costModel);
+
+    // Essa função calcula a distância entre árvores já indexadas por capted::NodeIndexer, as mesmas usadas por capted::Apted.
+    template<class Data, class Index>
+    float treeDist(const capted::NodeIndexer<Data, Index>* it1, const capted::NodeIndexer<Data, Index>* it2, const capted::CostModel<Data>& costModel);
+
+    // Essa função indexa duas árvores capted::Node e calcula a distância entre elas.
+    template<class Data>
+    float treeDist(capted::Node<Data>* root1, capted::Node<Data>* root2, const capted::CostModel<Data>& costModel);
+
+    // Essa função define as threads usadas nas próximas chamadas (nullptr volta a usar só a thread atual).
+    // As chamadas não devem ser feitas de dentro de uma tarefa do próprio pool.
+    void setThreadPool(capted::ThreadPool* pool);
+
+    // Essa função devolve a memória ocupada pelos buffers reaproveitados, em bytes.
+    size_t sizeInBytes() const;
+
+    // Essa função libera os buffers reaproveitados.
+    void releaseBuffers();
+
+    // Essa função devolve a instrumentação da última chamada de treeDist.
+    const Instrumentation& getInstrumentation() const { return instrumentation; }
+
+private:
+    /**
+     * @brief Buffers de quem calcula um par de keyroots: as linhas de forestdist
+     *        e a escolha das linhas para a keyroot da primeira árvore
+     */
+    struct Workspace {
+        std::vector<float> forestdist; // Linhas de forestdist em uso, cada uma com n + 1 posições
+        std::vector<int> rowSlot;      // Linha do buffer usada por cada linha de forestdist de keyroot
+        std::vector<int> releaseHead;  // Linhas de forestdist lidas pela última vez em cada linha (lista ligada)
+        std::vector<int> releaseNext;
+        std::vector<int> freeSlots;
+        int keyroot = -1;              // Keyroot para a qual rowSlot foi calculado
+        Instrumentation instrumentation; // Eventos de quem usa o Workspace, somados à instância ao final
+
+        size_t sizeInBytes() const;
+    };
+
+    // Entrada da chamada atual, em pós-ordem.
+    std::vector<NodeZHSH*> nodes1, nodes2;
+    std::vector<int> leftmost1, leftmost2;
+    std::vector<float> deleteCosts, insertCosts;
+
+    std::vector<float> treedist;   // m x n distâncias entre subárvores, permanente durante a chamada
+    Instrumentation instrumentation;
+    Workspace workspace;           // Usado sem threads
+
+    capted::ThreadPool* pool = nullptr;
+    std::mutex spareMutex;
+    std::vector<std::unique_ptr<Workspace>> spareWorkspaces; // Usados pelas tarefas paralelas
+
+    // Essa função escolhe, para a keyroot k1, em qual linha do buffer fica cada linha de forestdist.
+    void computeRowSlots(int k1, Workspace& ws);
+
+    // Essa função executa o algoritmo sobre leftmost1/2 e os custos das duas árvores em pós-ordem.
+    template<class Rename>
+    float zhangShasha(Rename renameCost);
+
+    // Essa função calcula os pares de keyroots em paralelo, na ordem das dependências entre eles.
+    template<class Rename>
+    void scheduleKeyrootPairs(Rename& renameCost, const std::vector<int>& keyroots1, const std::vector<int>& keyroots2);
+
+    // Essa função calcula as distâncias entre as florestas das subárvores das keyroots k1 e k2, preenchendo treedist.
+    template<class Rename>
+    void forestDist(Rename& renameCost, int k1, int k2, Workspace& ws);
+};
+
+/**
+ * @brief Função para calcular a distância entre duas árvores indexadas com o
+ *        algoritmo Zhang-Shasha. A mesma entrada pode ser usada por capted::Apted,
+ *        sem ler ou indexar as árvores de novo.
+ * 
+ * @param it1 Indexador da primeira árvore.
+ * @param it2 Indexador da segunda árvore.
+ * @param costModel Custos das operações de edição.
+ * @return Distância de edição entre as duas árvores.
+ */
+template<class Instrumentation>
+template<class Data, class Index>
+float BasicForestDist<Instrumentation>::treeDist(const capted::NodeIndexer<Data, Index>* it1, const capted::NodeIndexer<Data, Index>* it2, const capted::CostModel<Data>& costModel) {
+    int m = it1->getSize();
+    int n = it2->getSize();
+    leftmost1.resize(m);
+    leftmost2.resize(n);
+    deleteCosts.resize(m);
+    insertCosts.resize(n);
+    for (int i = 0; i < m; ++i) {
+        leftmost1[i] = it1->leftmostLeaf(i);
+        deleteCosts[i] = costModel.deleteCost(it1->postL_to_node(i));
+    }
+    for (int j = 0; j < n; ++j) {
+        leftmost2[j] = it2->leftmostLeaf(j);
+        insertCosts[j] = costModel.insertCost(it2->postL_to_node(j));
+    }
+
+    return zhangShasha([&](int i, int j) {
+        return costModel.renameCost(it1->postL_to_node(i), it2->postL_to_node(j));
+    });
+}
+
+/**
+ * @brief Função para calcular a distância entre duas árvores capted::Node,
+ *        indexando-as antes.
+ * 
+ * @param root1 Raiz da primeira árvore.
+ * @param root2 Raiz da segunda árvore.
+ * @param costModel Custos das operações de edição.
+ * @return Distância de edição entre as duas árvores.
+ */
+template<class Instrumentation>
+template<class Data>
+float BasicForestDist<Instrumentation>::treeDist(capted::Node<Data>* root1, capted::Node<Data>* root2, const capted::CostModel<Data>& costModel) {
+    capted::NodeIndexer<Data> it1(root1, &costModel);
+    capted::NodeIndexer<Data> it2(root2, &costModel);
+    return treeDist(&it1, &it2, costModel);
+}
+
+/**
+ * @brief Função para calcular a distância entre duas árvores com o algoritmo
+ *        Zhang-Shasha: para cada par de keyroots, em ordem crescente, calcula as
+ *        distâncias entre florestas e guarda em treedist as distâncias entre
+ *        subárvores, que são reaproveitadas pelos pares de keyroots maiores.
+ *        Lê leftmost1, leftmost2, deleteCosts e insertCosts, já preenchidos.
+ * 
+ * @param renameCost Função que recebe os índices em pós-ordem de dois nós e devolve o custo de renomear.
+ * @return Distância de edição entre as duas árvores.
+ */
+template<class Instrumentation>
+template<class Rename>
+float BasicForestDist<Instrumentation>::zhangShasha(Rename renameCost) {
+    instrumentation.reset();
+    int m = leftmost1.size();
+    int n = leftmost2.size();
+
+    // Uma árvore vazia: a distância é o custo de deletar ou inserir todos os nós da outra.
+    if (m == 0 || n == 0) {
+        float cost = 0;
+        for (float c : deleteCosts) {
+            cost += c;
+        }
+        for (float c : insertCosts) {
+            cost += c;
+        }
+        return cost;
+    }
+
+    std::vector<int> keyroots1 = computeKeyroots(leftmost1);
+    std::vector<int> keyroots2 = computeKeyroots(leftmost2);
+
+    // Toda posição de treedist e de forestdist é escrita antes de ser lida, então
+    // os buffers não precisam ser zerados entre chamadas; só a escolha das linhas
+    // de forestdist, que depende da árvore, é descartada.
+    treedist.resize((size_t)m * n);
+    workspace.keyroot = -1;
+    for (std::unique_ptr<Workspace>& spare : spareWorkspaces) {
+        spare->keyroot = -1;
+    }
+
+    if (pool != nullptr && pool->size() > 1 && (size_t)m * n >= PARALLEL_MIN_CELLS) {
+        scheduleKeyrootPairs(renameCost, keyroots1, keyroots2);
+    } else {
+        for (int k1 : keyroots1) {
+            for (int k2 : keyroots2) {
+                forestDist(renameCost, k1, k2, workspace);
+            }
+        }
+        instrumentation.merge(workspace.instrumentation);
+        workspace.instrumentation.reset();
+    }
+
+    return treedist[(size_t)m * n - 1]; // Retorna a distância entre as raízes
+}
+
+/**
+ * @brief Função para calcular as distâncias entre as florestas formadas pelos
+ *        nós leftmost1[k1]..k1 e leftmost2[k2]..k2, guardando em treedist as
+ *        distâncias entre as subárvores que começam na mesma folha que k1 e k2.
+ *        A linha r de forestdist fica em ws.rowSlot[r], calculado para k1.
+ *        Pares diferentes escrevem posições diferentes de treedist.
+ * 
+ * @param renameCost Custo de renomear, pelos índices em pós-ordem.
+ * @param k1 Keyroot da primeira árvore.
+ * @param k2 Keyroot da segunda árvore.
+ * @param ws Buffers de quem calcula o par.
+ */
+template<class Instrumentation>
+template<class Rename>
+void BasicForestDist<Instrumentation>::forestDist(Rename& renameCost, int k1, int k2, Workspace& ws) {
+    if (ws.keyroot != k1) {
+        computeRowSlots(k1, ws);
+    }
+
+    const int l1 = leftmost1[k1];
+    const int l2 = leftmost2[k2];
+    const size_t width = leftmost2.size() + 1;
+    const size_t n = leftmost2.size();
+    auto row = [&](int r) {
+        return &ws.forestdist[ws.rowSlot[r] * width];
+    };
+    ws.instrumentation.spfCall();
+
+    // Linha e coluna 0 representam a floresta vazia, relativa a l1 e l2.
+    float* first = row(0);
+    first[0] = 0;
+    for (int j = l2; j <= k2; ++j) {
+        first[j - l2 + 1] = first[j - l2] + insertCosts[j]; // Custo de inserir nó
+    }
+
+    for (int i = l1; i <= k1; ++i) {
+        const int di = i - l1 + 1;
+        float* previous = row(di - 1);
+        float* current = row(di);
+        const float deleteCost = deleteCosts[i];
+        const bool iIsOnPath = leftmost1[i] == l1;
+        const float* before = row(leftmost1[i] - l1); // Floresta à esquerda da subárvore de i
+        float* subtrees = &treedist[i * n];
+
+        current[0] = previous[0] + deleteCost; // Custo de deletar nó
+        ws.instrumentation.cells(k2 - l2 + 1);
+
+        for (int j = l2; j <= k2; ++j) {
+            const int dj = j - l2 + 1;
+            float deleteOrInsert = std::min(previous[dj] + deleteCost, current[dj - 1] + insertCosts[j]);
+
+            if (iIsOnPath && leftmost2[j] == l2) {
+                // As duas florestas são árvores: a raiz de uma pode ser renomeada para a da outra.
+                current[dj] = std::min(deleteOrInsert, previous[dj - 1] + renameCost(i, j));
+                subtrees[j] = current[dj];
+                ws.instrumentation.deltaWrite();
+            } else {
+                // Caso contrário, a subárvore de i é mapeada na de j, com distância já calculada.
+                current[dj] = std::min(deleteOrInsert, before[leftmost2[j] - l2] + subtrees[j]);
+                ws.instrumentation.deltaRead();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Função para calcular os pares de keyroots em paralelo. O par (k1, k2)
+ *        lê de treedist as distâncias escritas pelos pares de keyroots contidas
+ *        nas subárvores de k1 e de k2. Basta esperar os pares (c1, k2) e (k1, c2),
+ *        com c1 e c2 as keyroots imediatamente contidas em k1 e k2, pois eles
+ *        já esperaram os demais. Cada par guarda quantas dependências faltam, e
+ *        quem termina a última libera o par.
+ *
+ *        Uma tarefa por thread do pool retira pares prontos de uma pilha
+ *        compartilhada, com um Workspace próprio. Um par liberado é calculado
+ *        em seguida pela mesma tarefa, de preferência o de mesma keyroot k1, que
+ *        reaproveita as linhas de forestdist já escolhidas; só o segundo par
+ *        liberado volta para a pilha.
+ * 
+ * @param renameCost Custo de renomear, pelos índices em pós-ordem.
+ * @param keyroots1 Keyroots da primeira árvore, em ordem crescente.
+ * @param keyroots2 Keyroots da segunda árvore, em ordem crescente.
+ */
+template<class Instrumentation>
+template<class Rename>
+void BasicForestDist<Instrumentation>::scheduleKeyrootPairs(Rename& renameCost, const std::vector<int>& keyroots1, const std::vector<int>& keyroots2) {
+    typedef std::pair<size_t, size_t> Pair;
+    const size_t count1 = keyroots1.size();
+    const size_t count2 = keyroots2.size();
+    std::vector<int> parents1 = computeKeyrootParents(keyroots1, leftmost1);
+    std::vector<int> parents2 = computeKeyrootParents(keyroots2, leftmost2);
+
+    std::vector<int> children1(count1, 0), children2(count2, 0);
+    for (size_t a = 0; a < count1; ++a) {
+        if (parents1[a] != -1) {
+            children1[parents1[a]]++;
+        }
+    }
+    for (size_t b = 0; b < count2; ++b) {
+        if (parents2[b] != -1) {
+            children2[parents2[b]]++;
+        }
+    }
+
+    std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[count1 * count2]);
+    std::vector<Pair> ready;
+    for (size_t a = 0; a < count1; ++a) {
+        for (size_t b = 0; b < count2; ++b) {
+            int dependencies = children1[a] + children2[b];
+            pending[a * count2 + b].store(dependencies, std::memory_order_relaxed);
+            if (dependencies == 0) {
+                ready.push_back(Pair(a, b));
+            }
+        }
+    }
+
+    std::mutex readyMutex;
+    std::condition_variable hasReady;
+    const size_t total = count1 * count2;
+    size_t finished = 0;
+
+    auto worker = [&] {
+        std::unique_ptr<Workspace> ws;
+        {
+            std::lock_guard<std::mutex> lock(spareMutex);
+            if (!spareWorkspaces.empty()) {
+                ws = std::move(spareWorkspaces.back());
+                spareWorkspaces.pop_back();
+            }
+        }
+        if (ws == nullptr) {
+            ws.reset(new Workspace());
+        }
+
+        std::unique_lock<std::mutex> lock(readyMutex);
+        while (true) {
+            hasReady.wait(lock, [&] { return !ready.empty() || finished == total; });
+            if (ready.empty()) {
+                break;
+            }
+            Pair current = ready.back();
+            ready.pop_back();
+            lock.unlock();
+
+            size_t completed = 0;
+            while (true) {
+                size_t a = current.first;
+                size_t b = current.second;
+                forestDist(renameCost, keyroots1[a], keyroots2[b], *ws);
+                completed++;
+
+                // Libera os pares que dependem deste.
+                bool hasNext = false;
+                Pair next;
+                if (parents2[b] != -1 && pending[a * count2 + parents2[b]].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    next = Pair(a, parents2[b]);
+                    hasNext = true;
+                }
+                if (parents1[a] != -1 && pending[parents1[a] * count2 + b].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    if (!hasNext) {
+                        next = Pair(parents1[a], b);
+                        hasNext = true;
+                    } else {
+                        std::lock_guard<std::mutex> readyLock(readyMutex);
+                        ready.push_back(Pair(parents1[a], b));
+                        hasReady.notify_one();
+                    }
+                }
+                if (!hasNext) {
+                    break;
+                }
+                current = next;
+            }
+
+            lock.lock();
+            finished += completed;
+            if (finished == total) {
+                hasReady.notify_all();
+            }
+        }
+        lock.unlock();
+
+        std::lock_guard<std::mutex> spareLock(spareMutex);
+        instrumentation.merge(ws->instrumentation);
+        ws->instrumentation.reset();
+        spareWorkspaces.push_back(std::move(ws));
+    };
+
+    for (size_t t = 0; t < pool->size(); ++t) {
+        pool->submit(worker);
+    }
+    pool->wait();
+}
+
+typedef BasicForestDist<> ForestDist;
+typedef BasicForestDist<capted::CountingInstrumentation> CountingForestDist;
+
+#endif // FOREST_DIST_HPP
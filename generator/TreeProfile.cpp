@@ -0,0 +1,359 @@
+/**
+ * @file TreeProfile.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Distribuições de rótulos, de filhos e de tamanhos usadas pelo gerador,
+ *        e o ajuste delas a partir de uma amostra
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include "TreeProfile.hpp"
+#include "../input/PairStream.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+//--------------------------------------------------------------------------------
+// Tree Profile
+//--------------------------------------------------------------------------------
+
+/**
+ * @brief Pesos de uma distribuição de Zipf: o item de posição r (a partir de 1)
+ *        tem peso r^-exponent
+ *
+ * @param count - quantidade de itens
+ * @param exponent - expoente (0 = uniforme)
+ * @return vector<double> - peso de cada item, do mais frequente ao menos frequente
+ */
+vector<double> TreeProfile::zipfWeights(size_t count, double exponent) {
+    vector<double> weights(count);
+    for (size_t r = 0; r < count; ++r) {
+        weights[r] = pow((double)(r + 1), -exponent);
+    }
+    return weights;
+}
+
+/**
+ * @brief Distribuição de cauda pesada para a quantidade de filhos: k filhos
+ *        têm peso (k + 1)^-exponent, para k de 0 a maxFanout
+ *
+ * @param maxFanout - maior quantidade de filhos
+ * @param exponent - expoente da cauda
+ * @return vector<double> - peso de cada quantidade de filhos
+ */
+vector<double> TreeProfile::powerLawFanout(size_t maxFanout, double exponent) {
+    return zipfWeights(maxFanout + 1, exponent);
+}
+
+/**
+ * @brief Converte o perfil para JSON, para ser gravado e reaproveitado
+ *
+ * @return json - objeto com os campos do perfil
+ */
+json TreeProfile::toJson() const {
+    json object;
+    object["alphabetSize"] = alphabetSize;
+    object["zipfExponent"] = zipfExponent;
+    object["fanout"] = fanout;
+    object["maxDepth"] = maxDepth;
+    object["sizes"] = sizes;
+    return object;
+}
+
+/**
+ * @brief Lê um perfil gravado por toJson; campos ausentes ficam com o valor padrão
+ *
+ * @param object - objeto JSON
+ * @return TreeProfile - perfil lido
+ */
+TreeProfile TreeProfile::fromJson(const json& object) {
+    TreeProfile profile;
+    profile.alphabetSize = object.value("alphabetSize", profile.alphabetSize);
+    profile.zipfExponent = object.value("zipfExponent", profile.zipfExponent);
+    profile.fanout = object.value("fanout", profile.fanout);
+    profile.maxDepth = object.value("maxDepth", profile.maxDepth);
+    profile.sizes = object.value("sizes", profile.sizes);
+    return profile;
+}
+
+//--------------------------------------------------------------------------------
+// Samplers
+//--------------------------------------------------------------------------------
+
+/**
+ * @brief Construtor que acumula os pesos
+ *
+ * @param weights - peso de cada índice (negativos contam como zero)
+ */
+DiscreteSampler::DiscreteSampler(const vector<double>& weights) : cumulative(weights.size()) {
+    double total = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        total += max(weights[i], 0.0);
+        cumulative[i] = total;
+    }
+}
+
+/**
+ * @brief Sorteia um índice, em O(log n)
+ *
+ * @param rng - fluxo de números aleatórios
+ * @return size_t - índice sorteado (0 se não há pesos)
+ */
+size_t DiscreteSampler::sample(TreeRng& rng) const {
+    if (empty()) {
+        return 0;
+    }
+    double target = rng.uniform() * cumulative.back();
+    size_t index = upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+    return min(index, cumulative.size() - 1);
+}
+
+/**
+ * @brief Construtor que monta as distribuições do perfil. Sem linhas de filhos,
+ *        usa de 0 a 3 filhos com a mesma probabilidade.
+ *
+ * @param profile - perfil das árvores
+ */
+ProfileSampler::ProfileSampler(const TreeProfile& profile)
+    : labels(TreeProfile::zipfWeights(max(profile.alphabetSize, (size_t)1), profile.zipfExponent)),
+      sizes(profile.sizes),
+      depthLimit(profile.maxDepth) {
+    for (const vector<double>& row : profile.fanout) {
+        fanout.emplace_back(row);
+    }
+    if (fanout.empty()) {
+        fanout.emplace_back(vector<double>(4, 1.0));
+    }
+}
+
+/**
+ * @brief Sorteia um rótulo, pela posição na distribuição de Zipf
+ *
+ * @param rng - fluxo de números aleatórios
+ * @return int - rótulo (0 é o mais frequente)
+ */
+int ProfileSampler::label(TreeRng& rng) const {
+    return labels.sample(rng);
+}
+
+/**
+ * @brief Sorteia a quantidade de filhos de um nó
+ *
+ * @param rng - fluxo de números aleatórios
+ * @param depth - profundidade do nó
+ * @return int - quantidade de filhos (0 na profundidade máxima)
+ */
+int ProfileSampler::children(TreeRng& rng, int depth) const {
+    if (depthLimit >= 0 && depth >= depthLimit) {
+        return 0;
+    }
+    return fanout[min((size_t)depth, fanout.size() - 1)].sample(rng);
+}
+
+/**
+ * @brief Sorteia o tamanho de uma árvore entre os tamanhos do perfil
+ *
+ * @param rng - fluxo de números aleatórios
+ * @return int - quantidade de nós (1 se o perfil não tem tamanhos)
+ */
+int ProfileSampler::size(TreeRng& rng) const {
+    return sizes.empty() ? 1 : sizes[rng.below(sizes.size())];
+}
+
+//--------------------------------------------------------------------------------
+// Profile Sink
+//--------------------------------------------------------------------------------
+
+/**
+ * @brief Conta um nó aberto: o rótulo e mais um filho para o nó pai
+ *
+ * @param label - rótulo do nó
+ */
+void ProfileSink::open(const string& label) {
+    labelCounts[label]++;
+    if (!openChildren.empty()) {
+        openChildren.back()++;
+    }
+    maxDepth = max(maxDepth, (int)openChildren.size());
+    openChildren.push_back(0);
+    nodes++;
+}
+
+/**
+ * @brief Conta a quantidade de filhos do nó fechado na linha da sua profundidade;
+ *        ao fechar a raiz, guarda o tamanho da árvore
+ */
+void ProfileSink::close() {
+    size_t children = openChildren.back();
+    openChildren.pop_back();
+
+    size_t row = min(openChildren.size(), MAX_DEPTH_ROWS - 1);
+    if (fanoutCounts.size() <= row) {
+        fanoutCounts.resize(row + 1);
+    }
+    if (fanoutCounts[row].size() <= children) {
+        fanoutCounts[row].resize(children + 1, 0);
+    }
+    fanoutCounts[row][children]++;
+
+    if (openChildren.empty()) {
+        sizes.push_back(nodes);
+        nodes = 0;
+    }
+}
+
+/**
+ * @brief Ajusta um perfil às árvores vistas. O expoente de Zipf é a inclinação
+ *        (com sinal trocado) da reta de mínimos quadrados de log(frequência)
+ *        por log(posição); as distribuições de filhos e de tamanhos são as
+ *        observadas, e a profundidade máxima é a maior vista.
+ *
+ * @return TreeProfile - perfil ajustado
+ */
+TreeProfile ProfileSink::fit() const {
+    TreeProfile profile;
+    profile.alphabetSize = max(labelCounts.size(), (size_t)1);
+
+    vector<size_t> frequencies;
+    frequencies.reserve(labelCounts.size());
+    for (const auto& entry : labelCounts) {
+        frequencies.push_back(entry.second);
+    }
+    sort(frequencies.rbegin(), frequencies.rend());
+    if (frequencies.size() >= 2) {
+        double n = frequencies.size(), sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+        for (size_t r = 0; r < frequencies.size(); ++r) {
+            double x = log((double)(r + 1));
+            double y = log((double)frequencies[r]);
+            sumX += x;
+            sumY += y;
+            sumXX += x * x;
+            sumXY += x * y;
+        }
+        double slope = (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+        profile.zipfExponent = max(-slope, 0.0);
+    }
+
+    for (const vector<size_t>& row : fanoutCounts) {
+        profile.fanout.emplace_back(row.begin(), row.end());
+    }
+    profile.maxDepth = trees() > 0 ? maxDepth : -1;
+    profile.sizes = sizes;
+    return profile;
+}
+
+//--------------------------------------------------------------------------------
+// Fitting
+//--------------------------------------------------------------------------------
+
+/**
+ * @brief Emite no sink os nós de uma árvore em notação de chaves, sem montar a
+ *        árvore: o rótulo de um nó é o texto entre sua chave de abertura e a
+ *        próxima chave
+ *
+ * @param tree - árvore em notação de chaves
+ * @param sink - destino dos nós
+ * @return true - se as chaves estão balanceadas
+ */
+static bool readBracketTree(const string& tree, TreeSink& sink) {
+    long open = 0;
+    for (size_t i = 0; i < tree.size(); ++i) {
+        if (tree[i] == '{') {
+            size_t end = tree.find_first_of("{}", i + 1);
+            if (end == string::npos) {
+                return false;
+            }
+            sink.open(tree.substr(i + 1, end - i - 1));
+            open++;
+            i = end - 1;
+        } else if (tree[i] == '}') {
+            if (open-- == 0) {
+                return false;
+            }
+            sink.close();
+        }
+    }
+    return open == 0;
+}
+
+/**
+ * @brief Ajusta um perfil às árvores de um arquivo de amostra
+ *
+ * @param path - arquivo de amostra
+ * @param format - formato do arquivo
+ * @param profile - recebe o perfil ajustado
+ * @param error - recebe a mensagem de erro, se houver
+ * @return true - se o arquivo foi lido e tem pelo menos uma árvore
+ */
+bool fitProfile(const string& path, SampleFormat format, TreeProfile& profile, string* error) {
+    ProfileSink sink;
+    string message;
+
+    if (format == SampleFormat::Pairs) {
+        PairStream stream(path);
+        TreePair pair;
+        while (message.empty() && stream.next(pair)) {
+            if (!readBracketTree(pair.t1, sink) || !readBracketTree(pair.t2, sink)) {
+                message = path + ": par " + to_string(pair.id) + " com chaves desbalanceadas";
+            }
+        }
+        if (message.empty() && stream.failed()) {
+            message = stream.error();
+        }
+    } else {
+        ifstream in(path, ios::binary);
+        if (!in) {
+            message = "não foi possível abrir " + path;
+        } else if (format == SampleFormat::Trees) {
+            string line;
+            for (long lineNumber = 1; message.empty() && getline(in, line); ++lineNumber) {
+                if (line.find_first_not_of(" \t\r") == string::npos) {
+                    continue;
+                }
+                json object = json::parse(line, nullptr, false);
+                auto tree = object.is_object() ? object.find("tree") : object.end();
+                if (tree == object.end() || !tree->is_string() || !readBracketTree(tree->get_ref<const string&>(), sink)) {
+                    message = path + ":" + to_string(lineNumber) + ": objeto sem tree válido";
+                }
+            }
+        } else {
+            bool read = format == SampleFormat::Json ? readJsonTree(in, sink, DocumentLabeling(), &message)
+                                                     : readXmlTree(in, sink, DocumentLabeling(), &message);
+            if (!read && message.empty()) {
+                message = path + ": documento inválido";
+            }
+        }
+    }
+
+    if (message.empty() && sink.trees() == 0) {
+        message = path + ": nenhuma árvore na amostra";
+    }
+    if (!message.empty()) {
+        if (error != nullptr) {
+            *error = message;
+        }
+        return false;
+    }
+
+    profile = sink.fit();
+    return true;
+}
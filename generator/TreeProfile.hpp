@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ * @file TreeProfile.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Distribuições de rótulos, de filhos e de tamanhos usadas pelo gerador,
+ *        e o ajuste delas a partir de uma amostra
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "../includes/json.hpp"
+#include "../input/DocumentTree.hpp"
+#include "TreeRng.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief Parâmetros das árvores geradas por Tree_generator::createFromProfile
+ */
+struct TreeProfile {
+    size_t alphabetSize = 26;          /**< Quantidade de rótulos distintos */
+    double zipfExponent = 0.0;         /**< Expoente de Zipf dos rótulos: o rótulo de posição r tem peso r^-s (0 = uniforme) */
+    vector<vector<double>> fanout;     /**< fanout[d][k]: peso de um nó de profundidade d ter k filhos; a última linha vale para as profundidades maiores */
+    int maxDepth = -1;                 /**< Nós nessa profundidade não têm filhos; -1 sem limite */
+    vector<int> sizes;                 /**< Tamanhos sorteados quando o tamanho não é dado; vazio gera árvores de 1 nó */
+
+    static vector<double> zipfWeights(size_t count, double exponent);
+    static vector<double> powerLawFanout(size_t maxFanout, double exponent);
+
+    json toJson() const;
+    static TreeProfile fromJson(const json& object);
+};
+
+/**
+ * @brief Sorteio de um índice com probabilidade proporcional ao seu peso, por
+ *        busca binária nos pesos acumulados
+ */
+class DiscreteSampler {
+private:
+    vector<double> cumulative;
+
+public:
+    DiscreteSampler() {}
+    explicit DiscreteSampler(const vector<double>& weights);
+
+    size_t sample(TreeRng& rng) const;
+    bool empty() const { return cumulative.empty() || cumulative.back() <= 0; }
+};
+
+/**
+ * @brief Distribuições de um TreeProfile prontas para sorteio. Montado uma vez e
+ *        compartilhado (só leitura) pelas threads do gerador.
+ */
+class ProfileSampler {
+private:
+    DiscreteSampler labels;
+    vector<DiscreteSampler> fanout;
+    vector<int> sizes;
+    int depthLimit;
+
+public:
+    explicit ProfileSampler(const TreeProfile& profile);
+
+    int label(TreeRng& rng) const;
+    int children(TreeRng& rng, int depth) const;
+    int size(TreeRng& rng) const;
+    int maxDepth() const { return depthLimit; }
+};
+
+/**
+ * @brief Recebe os nós de uma amostra (documentos JSON/XML ou árvores em
+ *        notação de chaves) e conta rótulos, filhos por profundidade e tamanhos,
+ *        sem guardar as árvores.
+ */
+class ProfileSink : public TreeSink {
+private:
+    static constexpr size_t MAX_DEPTH_ROWS = 64; // Profundidades maiores usam a última linha
+
+    unordered_map<string, size_t> labelCounts;
+    vector<vector<size_t>> fanoutCounts;
+    vector<int> sizes;
+    vector<size_t> openChildren;  // Filhos já vistos de cada nó aberto
+    int nodes = 0;
+    int maxDepth = 0;
+
+public:
+    void open(const string& label) override;
+    void close() override;
+
+    size_t trees() const { return sizes.size(); }
+    TreeProfile fit() const;
+};
+
+/**
+ * @brief Formatos de arquivo aceitos por fitProfile
+ */
+enum class SampleFormat {
+    Pairs, /**< Arquivo de pares lido por PairStream (as duas árvores de cada par) */
+    Trees, /**< Um objeto {"ID", "tree"} por linha, como gravado por generateCorpus */
+    Json,  /**< Um documento JSON */
+    Xml    /**< Um documento XML */
+};
+
+bool fitProfile(const string& path, SampleFormat format, TreeProfile& profile, string* error = nullptr);
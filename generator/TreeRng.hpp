@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @file TreeRng.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Gerador de números aleatórios baseado em contador, para gerar árvores
+ *        de forma reprodutível e em paralelo
+ * @date 2024-06-22
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] G. L. Steele, D. Lea e C. H. Flood. Fast splittable pseudorandom
+ *      number generators. OOPSLA 2014.
+ * <li>[2] D. Lemire. Fast random integer generation in an interval. ACM
+ *      Transactions on Modeling and Computer Simulation 29(1). 2019.
+ * </ul>
+ */
+
+#include <cstdint>
+
+/**
+ * @brief Gerador baseado em contador: o k-ésimo número do fluxo é
+ *        mix(chave + k * GAMMA), com a função de mistura do SplitMix64 [1]. A
+ *        chave depende só da semente e do número do fluxo, então cada árvore
+ *        (um fluxo por índice) é reproduzida sozinha, em qualquer thread e em
+ *        qualquer ordem. Não usa estado global.
+ */
+class TreeRng {
+private:
+    static const uint64_t GAMMA = 0x9e3779b97f4a7c15ULL;
+
+    uint64_t key;
+    uint64_t counter = 0;
+
+public:
+    /**
+     * @brief Mistura os bits de um valor de 64 bits (finalizador do SplitMix64)
+     *
+     * @param value - valor a ser misturado
+     * @return uint64_t - valor misturado
+     */
+    static uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    /**
+     * @brief Construtor do fluxo stream da semente seed
+     *
+     * @param seed - semente da execução
+     * @param stream - número do fluxo (por exemplo, o índice da árvore)
+     */
+    TreeRng(uint64_t seed, uint64_t stream) : key(mix(seed + mix(stream + GAMMA))) {}
+
+    /**
+     * @brief Obtém o próximo número de 64 bits do fluxo
+     *
+     * @return uint64_t - número aleatório
+     */
+    uint64_t next() {
+        return mix(key + (++counter) * GAMMA);
+    }
+
+    /**
+     * @brief Sorteia um inteiro uniforme em [0, bound), pela multiplicação de
+     *        Lemire [2] (sem divisão; o viés é desprezível para bound pequeno)
+     *
+     * @param bound - limite superior exclusivo, maior que zero
+     * @return uint64_t - número sorteado
+     */
+    uint64_t below(uint64_t bound) {
+        return (uint64_t)(((unsigned __int128)next() * bound) >> 64);
+    }
+
+    /**
+     * @brief Sorteia um real uniforme em [0, 1)
+     *
+     * @return double - número sorteado
+     */
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
@@ -26,99 +26,780 @@
  */
 
 #include "Tree_generator.hpp"
+#include "../APTED/lib/util/ThreadPool.h"
 
 /**
- * @brief Construtor da classe Tree_generator que inicializa o gerador de números aleatórios
+ * @brief Construtor da classe Tree_generator. A mesma semente gera sempre os
+ *        mesmos arquivos.
+ * 
+ * @param seed - semente dos fluxos de números aleatórios
+ * @param path - arquivo JSON gravado pelas funções generate*
  */
-Tree_generator::Tree_generator() {
-    srand(time(nullptr));
+Tree_generator::Tree_generator(uint64_t seed, const string& path) : seed(seed), path(path) {
 }
 
 /**
- * @brief Cria uma árvore com uma certa profundidade e um caractere inicial
+ * @brief Obtém o fluxo de números aleatórios de um índice. O fluxo depende só
+ *        da semente e do índice, então cada árvore pode ser gerada sozinha.
  * 
- * @param depth - profundidade da árvore a ser criada
- * @param startChar - caractere inicial para o nó raiz
- * @return string - representação da árvore gerada
+ * @param index - índice da árvore (ou da árvore de um par)
+ * @return TreeRng - fluxo do índice
+ */
+TreeRng Tree_generator::stream(uint64_t index) const {
+    return TreeRng(seed, index);
+}
+
+//--------------------------------------------------------------------------------
+// Flat Trees
+//--------------------------------------------------------------------------------
+
+/**
+ * @brief Acrescenta um nó ao final da árvore plana
+ * 
+ * @param tree - árvore que recebe o nó
+ * @param parent - índice do pai, -1 para a raiz
+ * @param label - rótulo do nó
+ */
+void Tree_generator::addNode(GeneratedTree& tree, int parent, int label) {
+    tree.parent.push_back(parent);
+    tree.label.push_back(label);
+}
+
+/**
+ * @brief Rotula cada nó pela sua profundidade: a raiz fica com o rótulo que já
+ *        tem e cada filho com o rótulo do pai mais um. Como parent[i] < i, uma
+ *        passada em ordem crescente basta.
+ * 
+ * @param tree - árvore a ser rotulada
+ */
+void Tree_generator::labelByDepth(GeneratedTree& tree) {
+    for (size_t i = 1; i < tree.size(); ++i) {
+        tree.label[i] = tree.label[tree.parent[i]] + 1;
+    }
+}
+
+/**
+ * @brief Nome de uma família de formatos, usado também por parseShape
+ * 
+ * @param shape - família
+ * @return const char* - nome da família
+ */
+const char* Tree_generator::shapeName(TreeShape shape) {
+    switch (shape) {
+        case TreeShape::Path:            return "path";
+        case TreeShape::Star:            return "star";
+        case TreeShape::FullKary:        return "full-kary";
+        case TreeShape::RandomRecursive: return "random-recursive";
+        case TreeShape::LeftBranch:      return "left-branch";
+        case TreeShape::RightBranch:     return "right-branch";
+        case TreeShape::ZigZag:          return "zig-zag";
+        case TreeShape::RandomFanout:    return "random-fanout";
+        case TreeShape::RandomSplit:     return "random-split";
+    }
+    return "";
+}
+
+/**
+ * @brief Obtém a família de formatos pelo nome
+ * 
+ * @param name - nome da família, como devolvido por shapeName
+ * @param shape - recebe a família encontrada
+ * @return true - se o nome corresponde a uma família
+ */
+bool Tree_generator::parseShape(const string& name, TreeShape& shape) {
+    const TreeShape shapes[] = {
+        TreeShape::Path, TreeShape::Star, TreeShape::FullKary, TreeShape::RandomRecursive,
+        TreeShape::LeftBranch, TreeShape::RightBranch, TreeShape::ZigZag,
+        TreeShape::RandomFanout, TreeShape::RandomSplit
+    };
+    for (TreeShape candidate : shapes) {
+        if (name == shapeName(candidate)) {
+            shape = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Converte um rótulo numérico em texto: 0 = A, ..., 25 = Z, 26 = AA, ...
+ *        (como as colunas de uma planilha), sem limite de tamanho
+ * 
+ * @param label - rótulo, -1 para rótulo vazio
+ * @return string - texto do rótulo
+ */
+string Tree_generator::labelName(int label) {
+    string name;
+    for (long n = label; n >= 0; n = n / 26 - 1) {
+        name += (char)('A' + n % 26);
+    }
+    return string(name.rbegin(), name.rend());
+}
+
+/**
+ * @brief Cria uma árvore de uma família de formatos, em O(n). Os nós são
+ *        rotulados pela profundidade (A na raiz).
+ * 
+ * @param rng - fluxo de números aleatórios
+ * @param shape - família do formato
+ * @param numNodes - número de nós da árvore (no mínimo 1)
+ * @param arity - quantidade de filhos em FullKary e média de filhos em RandomFanout
+ * @return GeneratedTree - árvore gerada
+ */
+GeneratedTree Tree_generator::createShape(TreeRng& rng, TreeShape shape, int numNodes, int arity) {
+    const int n = max(numNodes, 1);
+    arity = max(arity, 1);
+
+    GeneratedTree tree;
+    tree.parent.reserve(n);
+    tree.label.reserve(n);
+    addNode(tree, -1, 0);
+
+    switch (shape) {
+        case TreeShape::Path:
+            for (int i = 1; i < n; ++i) {
+                addNode(tree, i - 1, 0);
+            }
+            break;
+
+        case TreeShape::Star:
+            for (int i = 1; i < n; ++i) {
+                addNode(tree, 0, 0);
+            }
+            break;
+
+        case TreeShape::FullKary:
+            // Numeração por nível: os filhos de p são p * k + 1, ..., p * k + k.
+            for (int i = 1; i < n; ++i) {
+                addNode(tree, (i - 1) / arity, 0);
+            }
+            break;
+
+        case TreeShape::RandomRecursive:
+            for (int i = 1; i < n; ++i) {
+                addNode(tree, rng.below(i), 0);
+            }
+            break;
+
+        case TreeShape::LeftBranch:
+        case TreeShape::RightBranch:
+        case TreeShape::ZigZag: {
+            // Cada nó do caminho ganha o próximo nó do caminho e uma folha; o
+            // lado do caminho é o da esquerda, o da direita ou alterna.
+            int spine = 0;
+            for (int step = 0; (int)tree.size() < n; ++step) {
+                bool spineLeft = shape == TreeShape::LeftBranch
+                              || (shape == TreeShape::ZigZag && step % 2 == 0);
+                if (spineLeft || (int)tree.size() + 1 == n) {
+                    int next = tree.size();
+                    addNode(tree, spine, 0);
+                    if ((int)tree.size() < n) {
+                        addNode(tree, spine, 0);
+                    }
+                    spine = next;
+                } else {
+                    addNode(tree, spine, 0);
+                    spine = tree.size();
+                    addNode(tree, tree.parent.back(), 0);
+                }
+            }
+            break;
+        }
+
+        case TreeShape::RandomFanout:
+            // Em largura: os nós entram na fila na ordem dos índices. O último
+            // nó da fila nunca fica sem filhos enquanto faltarem nós.
+            for (int head = 0; (int)tree.size() < n; ++head) {
+                int fanout = rng.below(2 * arity);
+                if (fanout == 0 && head + 1 == (int)tree.size()) {
+                    fanout = 1;
+                }
+                for (int c = 0; c < fanout && (int)tree.size() < n; ++c) {
+                    addNode(tree, head, 0);
+                }
+            }
+            break;
+
+        case TreeShape::RandomSplit: {
+            // Fila de (nó, tamanho da subárvore): o primeiro filho recebe entre 1
+            // e todos os nós restantes, o próximo entre 1 e o que sobrou, ...
+            vector<int> subtreeSize(1, n);
+            for (size_t head = 0; head < tree.size(); ++head) {
+                int remaining = subtreeSize[head] - 1;
+                while (remaining > 0) {
+                    int children = rng.below(remaining) + 1;
+                    addNode(tree, head, 0);
+                    subtreeSize.push_back(children);
+                    remaining -= children;
+                }
+            }
+            break;
+        }
+    }
+
+    labelByDepth(tree);
+    return tree;
+}
+
+/**
+ * @brief Cria uma árvore com as distribuições de um perfil, em largura: cada nó
+ *        sorteia a quantidade de filhos pela sua profundidade, até a árvore
+ *        chegar a numNodes nós. Enquanto faltarem nós, o último nó da fila tem
+ *        pelo menos um filho, salvo na profundidade máxima (então a árvore pode
+ *        ficar menor). Os rótulos seguem a distribuição de Zipf do perfil.
+ * 
+ * @param rng - fluxo de números aleatórios
+ * @param sampler - distribuições do perfil
+ * @param numNodes - número de nós; 0 sorteia entre os tamanhos do perfil
+ * @return GeneratedTree - árvore gerada
+ */
+GeneratedTree Tree_generator::createFromProfile(TreeRng& rng, const ProfileSampler& sampler, int numNodes) {
+    const int n = max(numNodes > 0 ? numNodes : sampler.size(rng), 1);
+
+    GeneratedTree tree;
+    tree.parent.reserve(n);
+    tree.label.reserve(n);
+    vector<int> depth(1, 0);
+    addNode(tree, -1, sampler.label(rng));
+
+    for (int head = 0; head < (int)tree.size() && (int)tree.size() < n; ++head) {
+        int fanout = sampler.children(rng, depth[head]);
+        bool canGrow = sampler.maxDepth() < 0 || depth[head] < sampler.maxDepth();
+        if (fanout == 0 && canGrow && head + 1 == (int)tree.size()) {
+            fanout = 1;
+        }
+        for (int c = 0; c < fanout && (int)tree.size() < n; ++c) {
+            addNode(tree, head, sampler.label(rng));
+            depth.push_back(depth[head] + 1);
+        }
+    }
+    return tree;
+}
+
+/**
+ * @brief Agrupa os filhos por pai com uma ordenação por contagem, em O(n): os
+ *        filhos do nó v são children[first[v]], ..., children[first[v + 1] - 1],
+ *        na ordem dos índices.
+ * 
+ * @param tree - árvore gerada, com pelo menos um nó
+ * @param first - recebe o início dos filhos de cada nó (n + 1 posições)
+ * @param children - recebe os filhos agrupados por pai
+ */
+void Tree_generator::groupChildren(const GeneratedTree& tree, vector<size_t>& first, vector<int>& children) {
+    const size_t n = tree.size();
+    first.assign(n + 1, 0);
+    for (size_t i = 1; i < n; ++i) {
+        first[tree.parent[i] + 1]++;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        first[i + 1] += first[i];
+    }
+    children.resize(n - 1);
+    vector<size_t> fill(first.begin(), first.end() - 1);
+    for (size_t i = 1; i < n; ++i) {
+        children[fill[tree.parent[i]]++] = i;
+    }
+}
+
+/**
+ * @brief Converte a árvore plana para a notação de chaves, em O(n). A árvore
+ *        é percorrida com uma pilha explícita, então árvores profundas não
+ *        estouram a pilha.
+ * 
+ * @param tree - árvore gerada
+ * @return string - representação da árvore
  */
-string Tree_generator::createTree(int depth, char startChar) {
-    if (depth == 0) {
+string Tree_generator::toBracket(const GeneratedTree& tree) {
+    const size_t n = tree.size();
+    if (n == 0) {
         return "{}";
     }
 
-    string tree = "{" + string(1, startChar);
-    int numChildren = rand() % 3; // Número aleatório de filhos entre 0 e 2
-    for (int i = 0; i < numChildren; ++i) {
-        tree += createTree(depth - 1, startChar + 1);
+    vector<size_t> first;
+    vector<int> children;
+    groupChildren(tree, first, children);
+
+    string out;
+    out.reserve(4 * n);
+    vector<pair<int, size_t>> stack; // (nó, próximo filho)
+    stack.push_back({0, first[0]});
+    out += "{" + labelName(tree.label[0]);
+    while (!stack.empty()) {
+        int node = stack.back().first;
+        size_t next = stack.back().second;
+        if (next < first[node + 1]) {
+            stack.back().second++;
+            int child = children[next];
+            out += "{" + labelName(tree.label[child]);
+            stack.push_back({child, first[child]});
+        } else {
+            out += "}";
+            stack.pop_back();
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Acrescenta um varint LEB128 sem sinal ao fim de out
+ * 
+ * @param out - string de destino
+ * @param value - valor a ser codificado
+ */
+static void appendVarint(string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+/**
+ * @brief Acrescenta a árvore ao fim de out no formato de BinaryTreeSerializer:
+ *        em pré-ordem, varint(tamanho do rótulo), rótulo e varint(número de
+ *        filhos). Várias árvores seguidas são lidas com BinaryTreeInputParser.
+ * 
+ * @param tree - árvore gerada
+ * @param out - string de destino
+ */
+void Tree_generator::appendBinary(const GeneratedTree& tree, string& out) {
+    if (tree.size() == 0) {
+        return;
+    }
+
+    vector<size_t> first;
+    vector<int> children;
+    groupChildren(tree, first, children);
+
+    vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        string label = labelName(tree.label[node]);
+        appendVarint(out, label.size());
+        out += label;
+        appendVarint(out, first[node + 1] - first[node]);
+        for (size_t c = first[node + 1]; c > first[node]; --c) {
+            stack.push_back(children[c - 1]);
+        }
+    }
+}
+
+/**
+ * @brief Monta uma árvore plana a partir de listas de filhos, numerando os nós
+ *        alcançáveis a partir do nó 0 em pré-ordem, o que garante parent[i] < i
+ * 
+ * @param children - filhos de cada nó, em ordem
+ * @param label - rótulo de cada nó
+ * @return GeneratedTree - árvore numerada em pré-ordem
+ */
+GeneratedTree Tree_generator::fromChildLists(const vector<vector<int>>& children, const vector<int>& label) {
+    GeneratedTree tree;
+    vector<pair<int, int>> stack; // (nó, índice do pai no resultado)
+    stack.push_back({0, -1});
+    while (!stack.empty()) {
+        int node = stack.back().first;
+        int newParent = stack.back().second;
+        stack.pop_back();
+        int newIndex = tree.size();
+        addNode(tree, newParent, label[node]);
+        for (auto child = children[node].rbegin(); child != children[node].rend(); ++child) {
+            stack.push_back({*child, newIndex});
+        }
     }
-    tree += "}";
     return tree;
 }
 
+/**
+ * @brief Move uma subárvore sorteada (exceto a raiz) para baixo de outro nó
+ *        sorteado fora dela, numa posição sorteada entre os filhos. O tamanho e
+ *        os rótulos não mudam, só o formato; usado na busca de formatos.
+ * 
+ * @param rng - fluxo de números aleatórios
+ * @param tree - árvore original
+ * @return GeneratedTree - árvore com a subárvore movida, numerada em pré-ordem
+ */
+GeneratedTree Tree_generator::moveSubtree(TreeRng& rng, const GeneratedTree& tree) {
+    const int n = tree.size();
+    if (n <= 2) {
+        return tree;
+    }
+
+    vector<vector<int>> children(n);
+    for (int i = 1; i < n; ++i) {
+        children[tree.parent[i]].push_back(i);
+    }
+
+    // Com parent[i] < i, a subárvore de v são os nós cujo pai já está nela.
+    int v = 1 + rng.below(n - 1);
+    vector<char> inside(n, 0);
+    vector<int> outside;
+    inside[v] = 1;
+    for (int i = 0; i < n; ++i) {
+        if (i > v && inside[tree.parent[i]]) {
+            inside[i] = 1;
+        }
+        if (!inside[i]) {
+            outside.push_back(i);
+        }
+    }
+
+    vector<int>& oldSiblings = children[tree.parent[v]];
+    oldSiblings.erase(find(oldSiblings.begin(), oldSiblings.end(), v));
+    vector<int>& newSiblings = children[outside[rng.below(outside.size())]];
+    newSiblings.insert(newSiblings.begin() + rng.below(newSiblings.size() + 1), v);
+    return fromChildLists(children, tree.label);
+}
+
+/**
+ * @brief Aplica numEdits operações de edição aleatórias a uma cópia da árvore.
+ *        Cada operação custa 1 com custos unitários, então a distância entre a
+ *        base e o resultado é no máximo numEdits (pode ser menor, por exemplo
+ *        quando um nó inserido é removido depois).
+ * 
+ *        - inserção: um nó novo vira filho de um nó sorteado, adotando um
+ *          intervalo contíguo (possivelmente vazio) dos filhos dele;
+ *        - remoção: um nó sorteado, exceto a raiz, é trocado pelos seus filhos;
+ *        - troca de rótulo: um nó sorteado recebe um rótulo diferente.
+ *        Os rótulos novos são sorteados entre os já usados e um a mais.
+ * 
+ * @param rng - fluxo de números aleatórios
+ * @param base - árvore original
+ * @param numEdits - quantidade de operações aplicadas
+ * @param mix - pesos de cada operação
+ * @return GeneratedTree - árvore editada, numerada em pré-ordem
+ */
+GeneratedTree Tree_generator::plantEdits(TreeRng& rng, const GeneratedTree& base, int numEdits, const EditMix& mix) {
+    const int total = max(mix.insert, 0) + max(mix.remove, 0) + max(mix.rename, 0);
+    if (base.size() == 0 || numEdits <= 0 || total == 0) {
+        return base;
+    }
+
+    // Listas de filhos explícitas: remover e inserir só mexem na lista do pai.
+    vector<vector<int>> children(base.size());
+    vector<int> parent = base.parent;
+    vector<int> label = base.label;
+    int maxLabel = 0;
+    for (size_t i = 0; i < base.size(); ++i) {
+        if (base.parent[i] >= 0) {
+            children[base.parent[i]].push_back(i);
+        }
+        maxLabel = max(maxLabel, base.label[i]);
+    }
+
+    // Nós vivos, com a posição de cada um para remover em O(1).
+    vector<int> alive(base.size());
+    vector<int> position(base.size());
+    for (size_t i = 0; i < base.size(); ++i) {
+        alive[i] = i;
+        position[i] = i;
+    }
+
+    for (int edit = 0; edit < numEdits; ++edit) {
+        int choice = rng.below(total);
+        if (choice >= mix.insert && choice < mix.insert + mix.remove && alive.size() == 1) {
+            // Só resta a raiz: não há o que remover.
+            if (mix.insert > 0) {
+                choice = 0;
+            } else if (mix.rename > 0) {
+                choice = total - 1;
+            } else {
+                break;
+            }
+        }
+
+        if (choice < mix.insert) {
+            int p = alive[rng.below(alive.size())];
+            int node = parent.size();
+            children.emplace_back(); // Antes de obter a referência: pode realocar children
+            vector<int>& siblings = children[p];
+            int first = rng.below(siblings.size() + 1);
+            int last = first + rng.below(siblings.size() - first + 1);
+
+            parent.push_back(p);
+            label.push_back(rng.below(maxLabel + 2));
+            maxLabel = max(maxLabel, label.back());
+            children[node].assign(siblings.begin() + first, siblings.begin() + last);
+            for (int child : children[node]) {
+                parent[child] = node;
+            }
+            siblings.erase(siblings.begin() + first, siblings.begin() + last);
+            siblings.insert(siblings.begin() + first, node);
+            position.push_back(alive.size());
+            alive.push_back(node);
+        } else if (choice < mix.insert + mix.remove) {
+            // A raiz nunca sai de alive[0]: só o último elemento é movido na remoção.
+            int node = alive[1 + rng.below(alive.size() - 1)];
+            vector<int>& siblings = children[parent[node]];
+            auto at = find(siblings.begin(), siblings.end(), node);
+            for (int child : children[node]) {
+                parent[child] = parent[node];
+            }
+            at = siblings.erase(at);
+            siblings.insert(at, children[node].begin(), children[node].end());
+            vector<int>().swap(children[node]);
+
+            alive[position[node]] = alive.back();
+            position[alive.back()] = position[node];
+            alive.pop_back();
+        } else {
+            int node = alive[rng.below(alive.size())];
+            int renamed = rng.below(maxLabel + 1);
+            label[node] = renamed >= label[node] ? renamed + 1 : renamed; // Nunca o mesmo rótulo
+            maxLabel = max(maxLabel, label[node]);
+        }
+    }
+
+    return fromChildLists(children, label);
+}
+
+/**
+ * @brief Cria uma árvore com uma certa profundidade e um caractere inicial. Os
+ *        nós na profundidade máxima ficam com rótulo vazio.
+ * 
+ * @param rng - fluxo de números aleatórios
+ * @param depth - profundidade da árvore a ser criada
+ * @param startChar - caractere inicial para o nó raiz
+ * @return string - representação da árvore gerada
+ */
+string Tree_generator::createTree(TreeRng& rng, int depth, char startChar) {
+    GeneratedTree tree;
+    vector<int> remaining; // Profundidade que ainda falta abaixo de cada nó
+    addNode(tree, -1, depth == 0 ? -1 : startChar - 'A');
+    remaining.push_back(depth);
+
+    for (size_t head = 0; head < tree.size(); ++head) {
+        if (remaining[head] == 0) {
+            continue;
+        }
+        int numChildren = rng.below(3); // Número aleatório de filhos entre 0 e 2
+        for (int i = 0; i < numChildren; ++i) {
+            remaining.push_back(remaining[head] - 1);
+            addNode(tree, head, remaining.back() == 0 ? -1 : tree.label[head] + 1);
+        }
+    }
+    return toBracket(tree);
+}
+
 /**
  * @brief Cria uma árvore com um certo número de nós e um caractere inicial
  * 
+ * @param rng - fluxo de números aleatórios
  * @param numNodes - número de nós a serem gerados na árvore
  * @param startChar - caractere inicial para o nó raiz
  * @return string - representação da árvore gerada
  */
-string Tree_generator::createTreeWithNodes(int numNodes, char startChar) {
+string Tree_generator::createTreeWithNodes(TreeRng& rng, int numNodes, char startChar) {
     if (numNodes == 0) {
         return "{}";
     }
 
-    string tree = "{" + string(1, startChar);
-    --numNodes;
+    GeneratedTree tree = createShape(rng, TreeShape::RandomSplit, numNodes);
+    for (int& label : tree.label) {
+        label += startChar - 'A';
+    }
+    return toBracket(tree);
+}
 
-    while (numNodes > 0) {
-        int children = rand() % numNodes + 1;
-        tree += createTreeWithNodes(children, startChar + 1);
-        numNodes -= children;
+/**
+ * @brief Grava um par no arquivo JSON diretamente, sem montar o documento em memória
+ * 
+ * @param out - arquivo de saída, com o array já aberto
+ * @param id - identificador do par (0 para o primeiro elemento do array)
+ * @param t1 - primeira árvore
+ * @param t2 - segunda árvore
+ * @param bound - limite superior conhecido da distância, gravado como "bound" (-1 omite o campo)
+ */
+void Tree_generator::writePair(ofstream& out, int id, const string& t1, const string& t2, long bound) {
+    out << (id == 0 ? "\n" : ",\n");
+    out << "    {\n"
+        << "        \"ID\": " << id << ",\n";
+    if (bound >= 0) {
+        out << "        \"bound\": " << bound << ",\n";
     }
-    tree += "}";
-    return tree;
+    out << "        \"t1\": " << json(t1).dump() << ",\n"
+        << "        \"t2\": " << json(t2).dump() << "\n"
+        << "    }";
 }
 
 /**
- * @brief Gera várias árvores com uma certa profundidade e grava em um arquivo JSON
+ * @brief Gera várias árvores com uma certa profundidade e grava no arquivo JSON
  * 
  * @param depth - profundidade das árvores a serem geradas
  * @param numTests - quantidade de testes a serem criados
  */
 void Tree_generator::generateTree(int depth, int numTests) {
-    ofstream outFile("tests/trees.json");
-    json j;
+    ofstream outFile(path);
+    outFile << "[";
 
     for (int i = 0; i < numTests; ++i) {
-        j.push_back({
-            {"ID", i},
-            {"t1", createTree(depth, 'A')},
-            {"t2", createTree(depth, 'A')}
-        });
+        TreeRng rng1 = stream(2 * i), rng2 = stream(2 * i + 1);
+        writePair(outFile, i, createTree(rng1, depth, 'A'), createTree(rng2, depth, 'A'));
     }
 
-    outFile << j.dump(4);
+    outFile << "\n]";
     outFile.close();
 }
 
 /**
- * @brief Gera várias árvores com um certo número de nós e grava em um arquivo JSON
+ * @brief Gera várias árvores com um certo número de nós e grava no arquivo JSON
  * 
  * @param numNodes - número de nós a serem gerados nas árvores
  * @param numTests - quantidade de testes a serem criados
  */
 void Tree_generator::generateTreeWithNodes(int numNodes, int numTests) {
-    ofstream outFile("tests/trees.json");
-    json j;
+    ofstream outFile(path);
+    outFile << "[";
+
+    for (int i = 0; i < numTests; ++i) {
+        TreeRng rng1 = stream(2 * i), rng2 = stream(2 * i + 1);
+        writePair(outFile, i, createTreeWithNodes(rng1, numNodes, 'A'), createTreeWithNodes(rng2, numNodes, 'A'));
+    }
+
+    outFile << "\n]";
+    outFile.close();
+}
+
+/**
+ * @brief Gera várias árvores de uma família de formatos e grava no arquivo JSON
+ * 
+ * @param shape - família do formato
+ * @param numNodes - número de nós das árvores
+ * @param numTests - quantidade de testes a serem criados
+ * @param arity - quantidade (ou média) de filhos, ver createShape
+ */
+void Tree_generator::generateShape(TreeShape shape, int numNodes, int numTests, int arity) {
+    ofstream outFile(path);
+    outFile << "[";
+
+    for (int i = 0; i < numTests; ++i) {
+        TreeRng rng1 = stream(2 * i), rng2 = stream(2 * i + 1);
+        writePair(outFile, i, toBracket(createShape(rng1, shape, numNodes, arity)),
+                              toBracket(createShape(rng2, shape, numNodes, arity)));
+    }
+
+    outFile << "\n]";
+    outFile.close();
+}
+
+/**
+ * @brief Gera pares parecidos: t1 é uma árvore da família e t2 é t1 com
+ *        numEdits operações aplicadas por plantEdits. O limite superior
+ *        numEdits é gravado no campo "bound" de cada par.
+ * 
+ * @param shape - família do formato de t1
+ * @param numNodes - número de nós de t1
+ * @param numEdits - quantidade de operações de edição por par
+ * @param numTests - quantidade de testes a serem criados
+ * @param mix - pesos de cada operação
+ * @param arity - quantidade (ou média) de filhos, ver createShape
+ */
+void Tree_generator::generatePlantedPairs(TreeShape shape, int numNodes, int numEdits, int numTests,
+                                          const EditMix& mix, int arity) {
+    ofstream outFile(path);
+    outFile << "[";
 
     for (int i = 0; i < numTests; ++i) {
-        j.push_back({
-            {"ID", i},
-            {"t1", createTreeWithNodes(numNodes, 'A')},
-            {"t2", createTreeWithNodes(numNodes, 'A')}
+        TreeRng rng1 = stream(2 * i), rng2 = stream(2 * i + 1);
+        GeneratedTree base = createShape(rng1, shape, numNodes, arity);
+        writePair(outFile, i, toBracket(base), toBracket(plantEdits(rng2, base, numEdits, mix)), max(numEdits, 0));
+    }
+
+    outFile << "\n]";
+    outFile.close();
+}
+
+/**
+ * @brief Grava numTrees árvores em paralelo, direto no formato binário ou em
+ *        NDJSON. A árvore i é criada com o fluxo stream(i), então o arquivo é o
+ *        mesmo para qualquer quantidade de threads. Os blocos de árvores são
+ *        gerados em janelas de algumas vezes a quantidade de threads e gravados
+ *        em ordem, então a memória usada não depende de numTrees.
+ * 
+ * @param corpusPath - arquivo de saída
+ * @param format - formato do arquivo
+ * @param numTrees - quantidade de árvores
+ * @param threads - quantidade de threads; 0 usa todos os núcleos
+ * @param create - cria uma árvore a partir do seu fluxo (chamada por várias threads)
+ * @return true - se o arquivo foi gravado por completo
+ */
+bool Tree_generator::writeCorpus(const string& corpusPath, CorpusFormat format, size_t numTrees, size_t threads,
+                                 const function<GeneratedTree(TreeRng&)>& create) const {
+    static const size_t TREES_PER_CHUNK = 1024;
+
+    ofstream outFile(corpusPath, ios::binary);
+    if (!outFile) {
+        return false;
+    }
+
+    capted::ThreadPool pool(threads);
+    const size_t numChunks = (numTrees + TREES_PER_CHUNK - 1) / TREES_PER_CHUNK;
+    const size_t window = 4 * pool.size();
+    vector<string> chunks(window);
+
+    for (size_t firstChunk = 0; firstChunk < numChunks && outFile; firstChunk += window) {
+        size_t count = min(window, numChunks - firstChunk);
+        pool.parallelFor(count, [&](size_t c) {
+            string& buffer = chunks[c];
+            buffer.clear();
+            size_t begin = (firstChunk + c) * TREES_PER_CHUNK;
+            size_t end = min(begin + TREES_PER_CHUNK, numTrees);
+            for (size_t i = begin; i < end; ++i) {
+                TreeRng rng = stream(i);
+                GeneratedTree tree = create(rng);
+                if (format == CorpusFormat::Binary) {
+                    appendBinary(tree, buffer);
+                } else {
+                    buffer += "{\"ID\": " + to_string(i) + ", \"tree\": " + json(toBracket(tree)).dump() + "}\n";
+                }
+            }
         });
+        for (size_t c = 0; c < count; ++c) {
+            outFile.write(chunks[c].data(), chunks[c].size());
+        }
     }
 
-    outFile << j.dump(4);
     outFile.close();
+    return !outFile.fail();
+}
+
+/**
+ * @brief Gera um corpus de árvores de uma família de formatos em paralelo,
+ *        gravando direto no formato binário ou em NDJSON (ver writeCorpus)
+ * 
+ * @param corpusPath - arquivo de saída
+ * @param format - formato do arquivo
+ * @param shape - família do formato
+ * @param numNodes - número de nós das árvores
+ * @param numTrees - quantidade de árvores
+ * @param arity - quantidade (ou média) de filhos, ver createShape
+ * @param threads - quantidade de threads; 0 usa todos os núcleos
+ * @return true - se o arquivo foi gravado por completo
+ */
+bool Tree_generator::generateCorpus(const string& corpusPath, CorpusFormat format, TreeShape shape, int numNodes,
+                                    size_t numTrees, int arity, size_t threads) const {
+    return writeCorpus(corpusPath, format, numTrees, threads, [&](TreeRng& rng) {
+        return createShape(rng, shape, numNodes, arity);
+    });
+}
+
+/**
+ * @brief Gera um corpus de árvores parecidas com as de um perfil (por exemplo,
+ *        ajustado a uma amostra com fitProfile), gravando direto no formato
+ *        binário ou em NDJSON (ver writeCorpus)
+ * 
+ * @param corpusPath - arquivo de saída
+ * @param format - formato do arquivo
+ * @param profile - distribuições de rótulos, filhos e tamanhos
+ * @param numTrees - quantidade de árvores
+ * @param numNodes - número de nós das árvores; 0 sorteia entre os tamanhos do perfil
+ * @param threads - quantidade de threads; 0 usa todos os núcleos
+ * @return true - se o arquivo foi gravado por completo
+ */
+bool Tree_generator::generateCorpus(const string& corpusPath, CorpusFormat format, const TreeProfile& profile,
+                                    size_t numTrees, int numNodes, size_t threads) const {
+    ProfileSampler sampler(profile);
+    return writeCorpus(corpusPath, format, numTrees, threads, [&](TreeRng& rng) {
+        return createFromProfile(rng, sampler, numNodes);
+    });
 }
@@ -27,24 +27,104 @@
  * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <cstdlib>
-#include <ctime>
+#include <vector>
+#include <cstdint>
 #include "../includes/json.hpp"
+#include <functional>
+#include "TreeRng.hpp"
+#include "TreeProfile.hpp"
 
 using json = nlohmann::json;
 using namespace std;
 
+/**
+ * @brief Famílias de formatos de árvore
+ */
+enum class TreeShape {
+    Path,            /**< Cada nó tem um único filho */
+    Star,            /**< Todos os nós são filhos da raiz */
+    FullKary,        /**< Árvore k-ária completa, preenchida por nível */
+    RandomRecursive, /**< O pai de cada nó é sorteado entre os nós anteriores */
+    LeftBranch,      /**< Caminho que desce sempre pelo filho da esquerda, com uma folha à direita */
+    RightBranch,     /**< Caminho que desce sempre pelo filho da direita, com uma folha à esquerda */
+    ZigZag,          /**< Caminho que alterna o lado, pior caso de Demaine et al. */
+    RandomFanout,    /**< Quantidade de filhos sorteada entre 0 e 2 * arity - 1 */
+    RandomSplit      /**< Os nós restantes são divididos ao acaso entre os filhos (formato antigo) */
+};
+
+/**
+ * @brief Árvore gerada em arrays planos. Os nós são numerados de 0 (raiz) a
+ *        n - 1, com parent[i] < i; os filhos de um nó ficam na ordem dos índices.
+ */
+struct GeneratedTree {
+    vector<int> parent; /**< Pai de cada nó, -1 para a raiz */
+    vector<int> label;  /**< Rótulo de cada nó, -1 para rótulo vazio */
+
+    size_t size() const { return parent.size(); }
+};
+
+/**
+ * @brief Pesos relativos das operações de edição aplicadas por plantEdits
+ */
+struct EditMix {
+    int insert = 1; /**< Peso da inserção de um nó */
+    int remove = 1; /**< Peso da remoção de um nó */
+    int rename = 1; /**< Peso da troca de rótulo de um nó */
+};
+
+/**
+ * @brief Formatos de arquivo de generateCorpus
+ */
+enum class CorpusFormat {
+    Binary, /**< Árvores no formato de BinaryTreeSerializer, uma após a outra */
+    Ndjson  /**< Um objeto {"ID", "tree"} por linha, com a árvore em notação de chaves */
+};
+
 class Tree_generator
 {
 private:
-    string createTree(int depth, char startChar);
-    string createTreeWithNodes(int numNodes, char startChar);
+    uint64_t seed;
+    string path;
+
+    static string createTree(TreeRng& rng, int depth, char startChar);
+    static string createTreeWithNodes(TreeRng& rng, int numNodes, char startChar);
+    void writePair(ofstream& out, int id, const string& t1, const string& t2, long bound = -1);
+
+    static void addNode(GeneratedTree& tree, int parent, int label);
+    static void labelByDepth(GeneratedTree& tree);
+    static void groupChildren(const GeneratedTree& tree, vector<size_t>& first, vector<int>& children);
+    static GeneratedTree fromChildLists(const vector<vector<int>>& children, const vector<int>& label);
+    bool writeCorpus(const string& corpusPath, CorpusFormat format, size_t numTrees, size_t threads,
+                     const function<GeneratedTree(TreeRng&)>& create) const;
 
 public:
-    Tree_generator();
+    static const uint64_t DEFAULT_SEED = 0x5eed;
+
+    explicit Tree_generator(uint64_t seed = DEFAULT_SEED, const string& path = "tests/trees.json");
+    TreeRng stream(uint64_t index) const;
+
+    static const char* shapeName(TreeShape shape);
+    static bool parseShape(const string& name, TreeShape& shape);
+    static string labelName(int label);
+
+    static GeneratedTree createShape(TreeRng& rng, TreeShape shape, int numNodes, int arity = 2);
+    static GeneratedTree moveSubtree(TreeRng& rng, const GeneratedTree& tree);
+    static GeneratedTree plantEdits(TreeRng& rng, const GeneratedTree& base, int numEdits, const EditMix& mix = EditMix());
+    static GeneratedTree createFromProfile(TreeRng& rng, const ProfileSampler& sampler, int numNodes = 0);
+    static string toBracket(const GeneratedTree& tree);
+    static void appendBinary(const GeneratedTree& tree, string& out);
+
     void generateTree(int depth, int numTests);
     void generateTreeWithNodes(int numNodes, int numTests);
+    void generateShape(TreeShape shape, int numNodes, int numTests, int arity = 2);
+    void generatePlantedPairs(TreeShape shape, int numNodes, int numEdits, int numTests,
+                              const EditMix& mix = EditMix(), int arity = 2);
+    bool generateCorpus(const string& corpusPath, CorpusFormat format, TreeShape shape, int numNodes,
+                        size_t numTrees, int arity = 2, size_t threads = 0) const;
+    bool generateCorpus(const string& corpusPath, CorpusFormat format, const TreeProfile& profile,
+                        size_t numTrees, int numNodes = 0, size_t threads = 0) const;
 };
@@ -0,0 +1,543 @@
+/**
+ * @file DocumentTree.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Leitura de documentos JSON e XML diretamente como árvores, sem passar
+ *        por strings em notação de chaves
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include "DocumentTree.hpp"
+#include <cstdlib>
+#include "../includes/json.hpp"
+
+using json = nlohmann::json;
+using namespace capted;
+
+//------------------------------------------------------------------------------
+// Node Tree Sink
+//------------------------------------------------------------------------------
+
+void NodeTreeSink::open(const std::string& label) {
+    Node<StringNodeData>* node = new Node<StringNodeData>(new StringNodeData(label));
+    if (stack.empty()) {
+        // Um segundo nó raiz substitui a árvore anterior.
+        delete root;
+        root = node;
+    } else {
+        stack.back()->addChild(node);
+    }
+    stack.push_back(node);
+}
+
+void NodeTreeSink::close() {
+    stack.pop_back();
+}
+
+Node<StringNodeData>* NodeTreeSink::release() {
+    Node<StringNodeData>* tree = root;
+    root = nullptr;
+    stack.clear();
+    return tree;
+}
+
+//------------------------------------------------------------------------------
+// JSON
+//------------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Estado da leitura de um documento JSON: contêineres abertos e a última
+ *        chave lida em cada objeto
+ */
+class JsonTreeBuilder {
+private:
+    struct Container {
+        bool isObject;
+        std::string key;
+    };
+
+    TreeSink& sink;
+    const DocumentLabeling& labeling;
+    std::vector<Container> containers;
+
+    bool insideObject() const {
+        return !containers.empty() && containers.back().isObject;
+    }
+
+    void openValue(const std::string& label) {
+        if (insideObject() && labeling.keys == DocumentLabeling::KeyMode::Prefix) {
+            sink.open(containers.back().key + labeling.separator + label);
+        } else {
+            sink.open(label);
+        }
+    }
+
+    void closeValue() {
+        sink.close();
+        if (insideObject() && labeling.keys == DocumentLabeling::KeyMode::Node) {
+            sink.close();
+        }
+    }
+
+    std::string scalarLabel(const json& value) const {
+        std::string text = value.is_string() ? value.get_ref<const std::string&>() : value.dump();
+        switch (labeling.values) {
+            case DocumentLabeling::ValueMode::Type:
+                return value.type_name();
+            case DocumentLabeling::ValueMode::TypeAndValue:
+                return value.type_name() + labeling.separator + text;
+            default:
+                return text;
+        }
+    }
+
+public:
+    JsonTreeBuilder(TreeSink& sink, const DocumentLabeling& labeling) : sink(sink), labeling(labeling) { }
+
+    /**
+     * @brief Callback do parser. Os valores são descartados depois de emitidos,
+     *        então o parser nunca acumula o documento em memória.
+     */
+    bool onEvent(json::parse_event_t event, json& parsed) {
+        switch (event) {
+            case json::parse_event_t::key:
+                if (labeling.keys == DocumentLabeling::KeyMode::Node) {
+                    sink.open(parsed.get_ref<const std::string&>());
+                } else {
+                    containers.back().key = parsed.get_ref<const std::string&>();
+                }
+                return true;
+
+            case json::parse_event_t::object_start:
+            case json::parse_event_t::array_start: {
+                bool isObject = event == json::parse_event_t::object_start;
+                openValue(isObject ? labeling.objectLabel : labeling.arrayLabel);
+                containers.push_back({isObject, std::string()});
+                return true;
+            }
+
+            case json::parse_event_t::object_end:
+            case json::parse_event_t::array_end:
+                containers.pop_back();
+                closeValue();
+                return false;
+
+            case json::parse_event_t::value:
+                // Contêineres já foram emitidos e descartados em object_end/array_end.
+                if (parsed.is_discarded()) {
+                    return false;
+                }
+                openValue(scalarLabel(parsed));
+                closeValue();
+                // Libera o valor antes de descartá-lo (o parser não destrói valores descartados aqui).
+                parsed = nullptr;
+                return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool readJsonTree(std::istream& in, TreeSink& sink, const DocumentLabeling& labeling, std::string* error) {
+    JsonTreeBuilder builder(sink, labeling);
+    try {
+        json::parse(in, [&builder](int, json::parse_event_t event, json& parsed) {
+            return builder.onEvent(event, parsed);
+        });
+    } catch (const std::exception& e) {
+        if (error) {
+            *error = e.what();
+        }
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// XML
+//------------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Leitor de XML em fluxo, caractere a caractere sobre o streambuf.
+ *        Cobre o subconjunto usado em documentos: elementos, atributos, texto,
+ *        entidades, CDATA, comentários, instruções de processamento e DOCTYPE.
+ *        Não valida DTD nem resolve namespaces (o prefixo faz parte do nome).
+ */
+class XmlTreeReader {
+private:
+    std::streambuf* buffer;
+    TreeSink& sink;
+    const DocumentLabeling& labeling;
+    std::vector<std::string> elements;
+    std::string text;
+    std::string errorMessage;
+    bool hasRoot = false;
+
+    int get() { return buffer->sbumpc(); }
+    int peek() { return buffer->sgetc(); }
+
+    static bool isSpace(int c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static bool isNameChar(int c) {
+        return c != std::char_traits<char>::eof() && !isSpace(c) && c != '>' && c != '/' && c != '=' && c != '<';
+    }
+
+    bool fail(const std::string& message) {
+        errorMessage = message;
+        return false;
+    }
+
+    bool skipUntil(const char* terminator) {
+        size_t length = std::char_traits<char>::length(terminator);
+        size_t matched = 0;
+        int c;
+        while ((c = get()) != std::char_traits<char>::eof()) {
+            if (c == terminator[matched]) {
+                if (++matched == length) {
+                    return true;
+                }
+            } else {
+                matched = (c == terminator[0]) ? 1 : 0;
+            }
+        }
+        return false;
+    }
+
+    bool expect(const char* literal) {
+        for (const char* p = literal; *p; p++) {
+            if (get() != *p) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void skipSpaces() {
+        while (isSpace(peek())) {
+            get();
+        }
+    }
+
+    std::string readName() {
+        std::string name;
+        while (isNameChar(peek())) {
+            name += (char)get();
+        }
+        return name;
+    }
+
+    static void appendUtf8(std::string& out, unsigned long code) {
+        if (code < 0x80) {
+            out += (char)code;
+        } else if (code < 0x800) {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        } else {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+
+    /**
+     * @brief Decodifica uma referência de entidade logo após o '&'.
+     *        Entidades desconhecidas são mantidas literalmente.
+     */
+    void readEntity(std::string& out) {
+        std::string name;
+        while (name.size() < 12 && peek() != ';' && peek() != std::char_traits<char>::eof() &&
+               !isSpace(peek()) && peek() != '<' && peek() != '&') {
+            name += (char)get();
+        }
+        if (peek() != ';') {
+            out += '&';
+            out += name;
+            return;
+        }
+        get();
+
+        if (name == "lt") out += '<';
+        else if (name == "gt") out += '>';
+        else if (name == "amp") out += '&';
+        else if (name == "quot") out += '"';
+        else if (name == "apos") out += '\'';
+        else if (name.size() > 1 && name[0] == '#') {
+            bool hex = name[1] == 'x' || name[1] == 'X';
+            appendUtf8(out, std::strtoul(name.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10));
+        } else {
+            out += '&';
+            out += name;
+            out += ';';
+        }
+    }
+
+    void flushText() {
+        if (labeling.textNodes && !elements.empty()) {
+            size_t begin = 0;
+            size_t end = text.size();
+            if (labeling.trimText) {
+                while (begin < end && isSpace((unsigned char)text[begin])) begin++;
+                while (end > begin && isSpace((unsigned char)text[end - 1])) end--;
+            }
+            if (begin < end) {
+                sink.open(text.substr(begin, end - begin));
+                sink.close();
+            }
+        }
+        text.clear();
+    }
+
+    void emitAttribute(const std::string& name, const std::string& value) {
+        switch (labeling.attributes) {
+            case DocumentLabeling::AttributeMode::Node:
+                sink.open(labeling.attributePrefix + name);
+                sink.open(value);
+                sink.close();
+                sink.close();
+                break;
+            case DocumentLabeling::AttributeMode::Inline:
+                sink.open(labeling.attributePrefix + name + "=" + value);
+                sink.close();
+                break;
+            default:
+                break;
+        }
+    }
+
+    bool readStartTag() {
+        std::string name = readName();
+        if (name.empty()) {
+            return fail("nome de elemento vazio");
+        }
+        if (elements.empty() && hasRoot) {
+            return fail("mais de um elemento raiz");
+        }
+        hasRoot = true;
+        sink.open(name);
+        elements.push_back(name);
+
+        while (true) {
+            skipSpaces();
+            int c = peek();
+            if (c == '>') {
+                get();
+                return true;
+            }
+            if (c == '/') {
+                get();
+                if (get() != '>') {
+                    return fail("esperado '>' após '/' em <" + name + ">");
+                }
+                sink.close();
+                elements.pop_back();
+                return true;
+            }
+
+            std::string attribute = readName();
+            skipSpaces();
+            if (attribute.empty() || get() != '=') {
+                return fail("atributo inválido em <" + name + ">");
+            }
+            skipSpaces();
+            int quote = get();
+            if (quote != '"' && quote != '\'') {
+                return fail("valor de atributo sem aspas em <" + name + ">");
+            }
+            std::string value;
+            while ((c = get()) != quote) {
+                if (c == std::char_traits<char>::eof()) {
+                    return fail("valor de atributo não terminado em <" + name + ">");
+                }
+                if (c == '&') {
+                    readEntity(value);
+                } else {
+                    value += (char)c;
+                }
+            }
+            emitAttribute(attribute, value);
+        }
+    }
+
+    bool readEndTag() {
+        std::string name = readName();
+        skipSpaces();
+        if (get() != '>') {
+            return fail("esperado '>' em </" + name + ">");
+        }
+        if (elements.empty() || elements.back() != name) {
+            return fail("</" + name + "> não corresponde ao elemento aberto");
+        }
+        sink.close();
+        elements.pop_back();
+        return true;
+    }
+
+    /**
+     * @brief Trata "<!": comentário, CDATA ou DOCTYPE
+     */
+    bool readMarkupDeclaration() {
+        if (peek() == '-') {
+            if (!expect("--") || !skipUntil("-->")) {
+                return fail("comentário não terminado");
+            }
+            return true;
+        }
+        if (peek() == '[') {
+            if (!expect("[CDATA[")) {
+                return fail("seção CDATA inválida");
+            }
+            int c;
+            size_t end = text.size();
+            while ((c = get()) != std::char_traits<char>::eof()) {
+                text += (char)c;
+                if (text.size() - end >= 3 && text.compare(text.size() - 3, 3, "]]>") == 0) {
+                    text.resize(text.size() - 3);
+                    return true;
+                }
+            }
+            return fail("seção CDATA não terminada");
+        }
+
+        // DOCTYPE e outras declarações, possivelmente com subconjunto interno [...]
+        int depth = 0;
+        int c;
+        while ((c = get()) != std::char_traits<char>::eof()) {
+            if (c == '[') depth++;
+            else if (c == ']') depth--;
+            else if (c == '>' && depth <= 0) return true;
+        }
+        return fail("declaração não terminada");
+    }
+
+public:
+    XmlTreeReader(std::istream& in, TreeSink& sink, const DocumentLabeling& labeling)
+        : buffer(in.rdbuf()), sink(sink), labeling(labeling) { }
+
+    bool read() {
+        int c;
+        while ((c = get()) != std::char_traits<char>::eof()) {
+            if (c == '<') {
+                int next = peek();
+                bool ok;
+                if (next == '?') {
+                    ok = skipUntil("?>") || fail("instrução de processamento não terminada");
+                } else if (next == '!') {
+                    get();
+                    ok = readMarkupDeclaration();
+                } else if (next == '/') {
+                    get();
+                    flushText();
+                    ok = readEndTag();
+                } else {
+                    flushText();
+                    ok = readStartTag();
+                }
+                if (!ok) {
+                    return false;
+                }
+            } else if (elements.empty()) {
+                if (!isSpace(c)) {
+                    return fail("texto fora do elemento raiz");
+                }
+            } else if (c == '&') {
+                readEntity(text);
+            } else {
+                text += (char)c;
+            }
+        }
+
+        if (!elements.empty()) {
+            return fail("elemento <" + elements.back() + "> não fechado");
+        }
+        if (!hasRoot) {
+            return fail("documento sem elemento raiz");
+        }
+        return true;
+    }
+
+    const std::string& error() const {
+        return errorMessage;
+    }
+};
+
+} // namespace
+
+bool readXmlTree(std::istream& in, TreeSink& sink, const DocumentLabeling& labeling, std::string* error) {
+    XmlTreeReader reader(in, sink, labeling);
+    if (!reader.read()) {
+        if (error) {
+            *error = reader.error();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool addJsonDocument(std::istream& in, SuccinctForest& forest, const DocumentLabeling& labeling, std::string* error) {
+    ForestTreeSink sink(forest);
+    if (!readJsonTree(in, sink, labeling, error)) {
+        sink.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool addXmlDocument(std::istream& in, SuccinctForest& forest, const DocumentLabeling& labeling, std::string* error) {
+    ForestTreeSink sink(forest);
+    if (!readXmlTree(in, sink, labeling, error)) {
+        sink.rollback();
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Input Parsers
+//------------------------------------------------------------------------------
+
+Node<StringNodeData>* JsonInputParser::getRoot() {
+    NodeTreeSink sink;
+    if (!readJsonTree(in, sink, labeling, &errorMessage)) {
+        return nullptr;
+    }
+    return sink.release();
+}
+
+Node<StringNodeData>* XmlInputParser::getRoot() {
+    NodeTreeSink sink;
+    if (!readXmlTree(in, sink, labeling, &errorMessage)) {
+        return nullptr;
+    }
+    return sink.release();
+}
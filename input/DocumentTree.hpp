@@ -0,0 +1,212 @@
+#pragma once
+
+/**
+ * @file DocumentTree.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Leitura de documentos JSON e XML diretamente como árvores, sem passar
+ *        por strings em notação de chaves
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <string>
+#include <vector>
+#include <istream>
+#include "../APTED/lib/InputParser.h"
+#include "../APTED/lib/StringNodeData.h"
+#include "../APTED/lib/node/SuccinctTree.h"
+
+/**
+ * @brief Como os elementos de um documento viram rótulos de nós
+ */
+struct DocumentLabeling {
+    enum class KeyMode {
+        Node,    ///< Cada chave é um nó cujo filho é o valor
+        Prefix,  ///< A chave é prefixo do rótulo do valor ("chave:valor")
+        Ignore   ///< Chaves são descartadas
+    };
+
+    enum class ValueMode {
+        Value,       ///< O rótulo é o próprio valor ("3", "texto", "true")
+        Type,        ///< O rótulo é o tipo ("number", "string", "boolean", "null")
+        TypeAndValue ///< Tipo e valor ("number:3")
+    };
+
+    enum class AttributeMode {
+        Node,    ///< Cada atributo é um nó "@nome" com um filho para o valor
+        Inline,  ///< Cada atributo é uma folha "@nome=valor"
+        Ignore   ///< Atributos são descartados
+    };
+
+    // JSON
+    KeyMode keys = KeyMode::Node;
+    ValueMode values = ValueMode::Value;
+    // Sem chaves, para que a árvore sobreviva à notação de chaves (toBracket,
+    // BracketStringSerializer, PairStream).
+    std::string objectLabel = "object";
+    std::string arrayLabel = "array";
+    std::string separator = ":";
+
+    // XML
+    AttributeMode attributes = AttributeMode::Node;
+    std::string attributePrefix = "@";
+    bool textNodes = true;  ///< Inclui o texto dos elementos como folhas
+    bool trimText = true;   ///< Remove espaços nas bordas e ignora textos só de espaços
+};
+
+/**
+ * @brief Destino dos nós emitidos pelos leitores, em pré-ordem: open abre um
+ *        nó como filho do último nó aberto e close fecha o último nó aberto.
+ */
+class TreeSink {
+public:
+    virtual ~TreeSink() { }
+    virtual void open(const std::string& label) = 0;
+    virtual void close() = 0;
+};
+
+/**
+ * @brief Constrói uma árvore de Node para o Apted
+ */
+class NodeTreeSink : public TreeSink {
+private:
+    capted::Node<capted::StringNodeData>* root = nullptr;
+    std::vector<capted::Node<capted::StringNodeData>*> stack;
+
+public:
+    ~NodeTreeSink() override { delete root; }
+
+    void open(const std::string& label) override;
+    void close() override;
+
+    // Entrega a árvore construída ao chamador (nullptr se vazia)
+    capted::Node<capted::StringNodeData>* release();
+};
+
+/**
+ * @brief Emite os nós direto na representação sucinta, com rótulos
+ *        internalizados. Guarda o estado da floresta na construção: se a leitura
+ *        do documento falhar, rollback descarta os nós já emitidos.
+ */
+class ForestTreeSink : public TreeSink {
+private:
+    capted::SuccinctForest& forest;
+    capted::SuccinctForest::Checkpoint start;
+
+public:
+    explicit ForestTreeSink(capted::SuccinctForest& forest) : forest(forest), start(forest.checkpoint()) { }
+
+    void open(const std::string& label) override { forest.openNode(label); }
+    void close() override { forest.closeNode(); }
+
+    // Volta a floresta ao estado de antes do documento
+    void rollback() { forest.rollback(start); }
+};
+
+/**
+ * @brief Lê um documento JSON em fluxo, sem montar o DOM, emitindo os nós no sink.
+ *        Objetos e arrays viram nós rotulados com objectLabel/arrayLabel.
+ * 
+ * @param in Documento
+ * @param sink Destino dos nós
+ * @param labeling Configuração dos rótulos
+ * @param error Recebe a mensagem de erro, se houver
+ * @return true Se o documento foi lido por completo
+ */
+bool readJsonTree(std::istream& in, TreeSink& sink, const DocumentLabeling& labeling = DocumentLabeling(),
+                  std::string* error = nullptr);
+
+/**
+ * @brief Lê um documento XML em fluxo, emitindo os nós no sink. Elementos viram
+ *        nós rotulados pelo nome; comentários, instruções de processamento e
+ *        DOCTYPE são ignorados; CDATA e entidades são tratados como texto.
+ * 
+ * @param in Documento
+ * @param sink Destino dos nós
+ * @param labeling Configuração dos rótulos
+ * @param error Recebe a mensagem de erro, se houver
+ * @return true Se o documento foi lido por completo
+ */
+bool readXmlTree(std::istream& in, TreeSink& sink, const DocumentLabeling& labeling = DocumentLabeling(),
+                 std::string* error = nullptr);
+
+/**
+ * @brief Acrescenta um documento JSON à floresta como uma nova árvore. Se o
+ *        documento é inválido, a floresta fica como estava.
+ *
+ * @param in Documento
+ * @param forest Floresta, ainda não construída (build)
+ * @param labeling Configuração dos rótulos
+ * @param error Recebe a mensagem de erro, se houver
+ * @return true Se o documento foi lido e acrescentado
+ */
+bool addJsonDocument(std::istream& in, capted::SuccinctForest& forest,
+                     const DocumentLabeling& labeling = DocumentLabeling(), std::string* error = nullptr);
+
+/**
+ * @brief Acrescenta um documento XML à floresta como uma nova árvore. Se o
+ *        documento é inválido, a floresta fica como estava.
+ *
+ * @param in Documento
+ * @param forest Floresta, ainda não construída (build)
+ * @param labeling Configuração dos rótulos
+ * @param error Recebe a mensagem de erro, se houver
+ * @return true Se o documento foi lido e acrescentado
+ */
+bool addXmlDocument(std::istream& in, capted::SuccinctForest& forest,
+                    const DocumentLabeling& labeling = DocumentLabeling(), std::string* error = nullptr);
+
+/**
+ * @brief InputParser para documentos JSON
+ */
+class JsonInputParser : public capted::InputParser<capted::StringNodeData> {
+private:
+    std::istream& in;
+    DocumentLabeling labeling;
+    std::string errorMessage;
+
+public:
+    JsonInputParser(std::istream& in, const DocumentLabeling& labeling = DocumentLabeling())
+        : in(in), labeling(labeling) { }
+
+    // Retorna nullptr em caso de erro (ver error())
+    capted::Node<capted::StringNodeData>* getRoot() override;
+    const std::string& error() const { return errorMessage; }
+};
+
+/**
+ * @brief InputParser para documentos XML
+ */
+class XmlInputParser : public capted::InputParser<capted::StringNodeData> {
+private:
+    std::istream& in;
+    DocumentLabeling labeling;
+    std::string errorMessage;
+
+public:
+    XmlInputParser(std::istream& in, const DocumentLabeling& labeling = DocumentLabeling())
+        : in(in), labeling(labeling) { }
+
+    // Retorna nullptr em caso de erro (ver error())
+    capted::Node<capted::StringNodeData>* getRoot() override;
+    const std::string& error() const { return errorMessage; }
+};
@@ -0,0 +1,326 @@
+/**
+ * @file PairStream.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Classe para ler pares de árvores em fluxo, sem carregar o arquivo inteiro
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include "PairStream.hpp"
+#include <fstream>
+#include "../includes/json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+/**
+ * @brief Lançada dentro do callback do parser JSON para interromper a leitura
+ *        quando a fila é fechada pelo consumidor ou um elemento é inválido.
+ */
+struct StopReading {};
+
+/**
+ * @brief Converte um objeto {"ID", "t1", "t2", "bound"} em TreePair, movendo as strings
+ * 
+ * @param object Objeto JSON já lido
+ * @param fallbackId ID usado quando o objeto não tem o campo "ID"
+ * @param pair Recebe o par
+ * @return true Se o objeto tem os campos t1 e t2 como strings
+ */
+bool toTreePair(json& object, long fallbackId, TreePair& pair) {
+    if (!object.is_object()) {
+        return false;
+    }
+
+    auto t1 = object.find("t1");
+    auto t2 = object.find("t2");
+    if (t1 == object.end() || t2 == object.end() || !t1->is_string() || !t2->is_string()) {
+        return false;
+    }
+
+    auto id = object.find("ID");
+    pair.id = (id != object.end() && id->is_number_integer()) ? id->get<long>() : fallbackId;
+    auto bound = object.find("bound");
+    pair.bound = (bound != object.end() && bound->is_number_integer()) ? bound->get<long>() : -1;
+    pair.t1 = std::move(t1->get_ref<std::string&>());
+    pair.t2 = std::move(t2->get_ref<std::string&>());
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Construtor que abre o arquivo e inicia a thread produtora
+ * 
+ * @param path Caminho do arquivo de pares
+ * @param format Formato do arquivo (Auto deduz pela extensão)
+ * @param capacity Quantidade máxima de pares lidos e ainda não consumidos
+ */
+PairStream::PairStream(const std::string& path, PairFormat format, size_t capacity)
+    : path(path),
+      format(format == PairFormat::Auto ? detectFormat(path) : format),
+      queue(capacity) {
+    producer = std::thread(&PairStream::produce, this);
+}
+
+/**
+ * @brief Destrutor que interrompe a leitura caso o consumidor pare antes do fim
+ */
+PairStream::~PairStream() {
+    queue.close();
+    if (producer.joinable()) {
+        producer.join();
+    }
+}
+
+/**
+ * @brief Obtém o próximo par do arquivo
+ * 
+ * @param pair Recebe o par lido
+ * @return true Se um par foi lido, false ao fim do arquivo ou em caso de erro
+ */
+bool PairStream::next(TreePair& pair) {
+    return queue.pop(pair);
+}
+
+/**
+ * @brief Corpo da thread produtora: lê o arquivo no formato escolhido e fecha a fila ao final
+ */
+void PairStream::produce() {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        errorMessage = "não foi possível abrir " + path;
+        queue.close();
+        return;
+    }
+
+    try {
+        switch (format) {
+            case PairFormat::JsonArray: readJsonArray(in); break;
+            case PairFormat::Ndjson: readNdjson(in); break;
+            default: readBracket(in); break;
+        }
+    } catch (const StopReading&) {
+        // O consumidor fechou a fila; nada a fazer.
+    } catch (const std::exception& e) {
+        errorMessage = e.what();
+    }
+
+    queue.close();
+}
+
+/**
+ * @brief Lê um array JSON em uma única passagem. O callback do parser entrega cada
+ *        elemento do array assim que ele termina e o descarta em seguida, então
+ *        apenas um par fica em memória no parser, em vez do documento inteiro.
+ *        Um elemento que não é objeto (número, string, array) interrompe a
+ *        leitura com a mesma mensagem de um objeto sem t1/t2; um array aninhado
+ *        é recusado já no '[' para não ser acumulado pelo parser.
+ *
+ * @param in Fluxo de entrada
+ */
+void PairStream::readJsonArray(std::istream& in) {
+    long position = 0;
+    auto invalidElement = [this, &position]() {
+        // Para no primeiro elemento inválido, como nos outros formatos.
+        errorMessage = path + ": elemento " + std::to_string(position) + " do array sem t1/t2";
+        throw StopReading();
+    };
+
+    json::parse(in, [this, &position, &invalidElement](int depth, json::parse_event_t event, json& parsed) {
+        if (depth == 0) {
+            // O valor de topo deve ser um array: objetos e escalares não têm elementos.
+            if (event == json::parse_event_t::object_start
+                || (event == json::parse_event_t::value && !parsed.is_array())) {
+                errorMessage = path + ": o arquivo não contém um array JSON";
+                throw StopReading();
+            }
+            return true;
+        }
+        if (depth != 1) {
+            return true;
+        }
+
+        switch (event) {
+            case json::parse_event_t::object_end: {
+                TreePair pair;
+                if (!toTreePair(parsed, position, pair)) {
+                    invalidElement();
+                }
+                position++;
+                if (!queue.push(std::move(pair))) {
+                    throw StopReading();
+                }
+                return false; // Descarta o elemento, o array nunca cresce.
+            }
+            case json::parse_event_t::array_start:
+            case json::parse_event_t::array_end:
+                invalidElement();
+                return false;
+            case json::parse_event_t::value:
+                // Objetos já foram entregues e descartados em object_end; o resto é escalar.
+                if (!parsed.is_discarded()) {
+                    invalidElement();
+                }
+                return false;
+            default:
+                return true;
+        }
+    });
+}
+
+/**
+ * @brief Lê um objeto JSON por linha, ignorando linhas vazias
+ * 
+ * @param in Fluxo de entrada
+ */
+void PairStream::readNdjson(std::istream& in) {
+    std::string line;
+    long lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        json object = json::parse(line);
+        TreePair pair;
+        if (!toTreePair(object, lineNumber - 1, pair)) {
+            errorMessage = path + ":" + std::to_string(lineNumber) + ": objeto sem t1/t2";
+            return;
+        }
+        if (!queue.push(std::move(pair))) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Lê uma linha por par com as duas árvores em notação de chaves
+ * 
+ * @param in Fluxo de entrada
+ */
+void PairStream::readBracket(std::istream& in) {
+    std::string line;
+    long lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        TreePair pair;
+        pair.id = lineNumber - 1;
+        if (!splitBracketPair(line, pair.t1, pair.t2)) {
+            errorMessage = path + ":" + std::to_string(lineNumber) + ": linha não contém duas árvores";
+            return;
+        }
+        if (!queue.push(std::move(pair))) {
+            return;
+        }
+    }
+}
+
+namespace {
+
+/**
+ * @brief Encontra o fim da árvore que começa na chave em start
+ *
+ * @param line Linha de entrada
+ * @param start Posição do '{' que abre a árvore
+ * @return size_t Posição do '}' que fecha a árvore, ou npos se ela não fecha
+ */
+size_t matchingBrace(const std::string& line, size_t start) {
+    long depth = 0;
+    for (size_t i = start; i < line.size(); i++) {
+        if (line[i] == '{') {
+            depth++;
+        } else if (line[i] == '}' && --depth == 0) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+/**
+ * @brief Indica se há apenas espaços e tabulações a partir de from
+ */
+bool onlyBlanks(const std::string& line, size_t from) {
+    return line.find_first_not_of(" \t\r", from) == std::string::npos;
+}
+
+} // namespace
+
+/**
+ * @brief Separa uma linha com duas árvores. Cada árvore termina quando a
+ *        profundidade das chaves volta a zero; entre as árvores e depois da
+ *        segunda só são aceitos espaços e tabulações.
+ *
+ * @param line Linha de entrada
+ * @param t1 Recebe a primeira árvore
+ * @param t2 Recebe a segunda árvore
+ * @return true Se a linha contém exatamente duas árvores balanceadas
+ */
+bool PairStream::splitBracketPair(const std::string& line, std::string& t1, std::string& t2) {
+    size_t start = line.find('{');
+    if (start == std::string::npos) {
+        return false;
+    }
+    size_t end = matchingBrace(line, start);
+    if (end == std::string::npos) {
+        return false;
+    }
+
+    size_t second = line.find_first_not_of(" \t", end + 1);
+    if (second == std::string::npos || line[second] != '{') {
+        return false;
+    }
+    size_t last = matchingBrace(line, second);
+    if (last == std::string::npos || !onlyBlanks(line, last + 1)) {
+        return false;
+    }
+
+    t1.assign(line, start, end - start + 1);
+    t2.assign(line, second, last - second + 1);
+    return true;
+}
+
+/**
+ * @brief Deduz o formato a partir da extensão do arquivo
+ * 
+ * @param path Caminho do arquivo
+ * @return PairFormat JsonArray para .json, Ndjson para .ndjson/.jsonl, Bracket nos demais casos
+ */
+PairFormat PairStream::detectFormat(const std::string& path) {
+    auto endsWith = [&path](const std::string& suffix) {
+        return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    if (endsWith(".ndjson") || endsWith(".jsonl")) {
+        return PairFormat::Ndjson;
+    }
+    if (endsWith(".json")) {
+        return PairFormat::JsonArray;
+    }
+    return PairFormat::Bracket;
+}
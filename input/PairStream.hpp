@@ -0,0 +1,166 @@
+#pragma once
+
+/**
+ * @file PairStream.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Classe modelo para ler pares de árvores em fluxo, sem carregar o arquivo inteiro
+ * @date 2024-06-22
+ * 
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ * 
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ * 
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ */
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <istream>
+
+/**
+ * @brief Par de árvores em notação de chaves, como em tests/trees.json
+ */
+struct TreePair {
+    long id = 0;    ///< Identificador do par (campo "ID", ou número da linha)
+    std::string t1; ///< Primeira árvore
+    std::string t2; ///< Segunda árvore
+    long bound = -1; ///< Limite superior conhecido da distância (campo "bound"), -1 se ausente
+};
+
+/**
+ * @brief Fila limitada produtor/consumidor. push bloqueia quando a fila está
+ *        cheia e pop bloqueia quando está vazia, até que close seja chamado.
+ * 
+ * @tparam T Tipo dos elementos
+ */
+template<class T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+public:
+    /**
+     * @brief Construtor da fila
+     * 
+     * @param capacity Quantidade máxima de elementos armazenados
+     */
+    explicit BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief Insere um elemento, esperando enquanto a fila estiver cheia
+     * 
+     * @param item Elemento a ser inserido
+     * @return true Se o elemento foi inserido, false se a fila foi fechada
+     */
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Remove um elemento, esperando enquanto a fila estiver vazia
+     * 
+     * @param item Recebe o elemento removido
+     * @return true Se um elemento foi removido, false se a fila foi fechada e esvaziada
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Fecha a fila, acordando produtores e consumidores
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+/**
+ * @brief Formatos de arquivo aceitos pelo PairStream
+ */
+enum class PairFormat {
+    Auto,      ///< Escolhe pela extensão: .json, .ndjson/.jsonl, ou chaves
+    JsonArray, ///< Array JSON de objetos {"ID", "t1", "t2"} (formato de tests/trees.json)
+    Ndjson,    ///< Um objeto {"ID", "t1", "t2"} por linha
+    Bracket    ///< Uma linha por par: as duas árvores em notação de chaves
+};
+
+/**
+ * @brief Lê pares de árvores de um arquivo em uma thread produtora e os entrega
+ *        um a um por uma fila limitada, de modo que o consumo de memória não
+ *        depende do tamanho do arquivo.
+ */
+class PairStream {
+private:
+    std::string path;
+    PairFormat format;
+    BoundedQueue<TreePair> queue;
+    std::thread producer;
+    std::string errorMessage;
+
+    void produce();
+    void readJsonArray(std::istream& in);
+    void readNdjson(std::istream& in);
+    void readBracket(std::istream& in);
+
+public:
+    PairStream(const std::string& path, PairFormat format = PairFormat::Auto, size_t capacity = 1024);
+    ~PairStream();
+
+    PairStream(const PairStream&) = delete;
+    PairStream& operator=(const PairStream&) = delete;
+
+    // Obtém o próximo par; retorna false ao fim do arquivo ou em caso de erro
+    bool next(TreePair& pair);
+
+    // Indica se a leitura terminou por erro (válido depois que next retorna false)
+    bool failed() const { return !errorMessage.empty(); }
+
+    // Mensagem do erro de leitura, vazia se não houve erro
+    const std::string& error() const { return errorMessage; }
+
+    // Separa uma linha com duas árvores em notação de chaves
+    static bool splitBracketPair(const std::string& line, std::string& t1, std::string& t2);
+
+    // Deduz o formato a partir da extensão do arquivo
+    static PairFormat detectFormat(const std::string& path);
+};
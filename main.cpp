@@ -23,7 +23,6 @@
  * 
  * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
  */
-#include "MemoryAccessTracker.hpp"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -33,6 +32,7 @@
 #include "APTED/lib/Capted.h"
 #include "ZHSH/forest_dist.hpp"
 #include "generator/Tree_generator.hpp"
+#include "input/PairStream.hpp"
 #include <sys/resource.h>
 
 using namespace capted;
@@ -43,124 +43,59 @@ using json = nlohmann::json;
 
 
 
-NodeZHSH* buildTree(const std::string& str, size_t& pos) {
-    if (pos >= str.size()) return nullptr;
-
-    if (str[pos] == '{') {
-        ++pos;
-    }
-
-    std::string label;
-    while (pos < str.size() && str[pos] != '{' && str[pos] != '}') {
-        label += str[pos];
-        ++pos;
-    }
-
-    NodeZHSH* root = new NodeZHSH(label);
-
-    while (pos < str.size() && str[pos] != '}') {
-        root->children.push_back(buildTree(str, pos));
-    }
-
-    if (pos < str.size() && str[pos] == '}') {
-        ++pos;
-    }
-
-    return root;
-}
-
 /**
- * @brief cria e realiza os testes de TED para APTED
+ * @brief cria e realiza os testes de TED para APTED e Zhang-Shasha. Cada par é
+ *        lido e indexado uma única vez, e os dois algoritmos usam os mesmos índices.
+ *        Para percentis, repetições e pico de memória, use o binário benchmark.
  * 
  * @param numNodes - quantidade de nós a serem gerados nas árvores
  * @param numTests - quantidade de testes a serem criados
- * @return double  - tempo de médio de execução
  */
-double test_TreeEditDistance(int numNodes, int numTests) {
+void test_TreeEditDistance(int numNodes, int numTests) {
     Tree_generator gen;
     gen.generateTreeWithNodes(numNodes, numTests);
 
-    ifstream testFile("tests/trees.json");
-    json tests;
-    testFile >> tests;
+    PairStream tests("tests/trees.json");
+    TreePair test;
+    StringCostModel costModel;
+    CountingForestDist fd; // Reaproveita os buffers entre os pares
 
     double execTime = 0;
-    long memoryUsage = 0;
-
+    long memoryAccesses = 0;
+    double execTimeZHSH = 0;
+    long memoryAccessesZHSH = 0;
 
-    for (json test : tests) {
-        int id = test["ID"];
-        string t1 = test["t1"];
-        string t2 = test["t2"];
-
-        StringCostModel costModel;
-        Apted<StringNodeData> algorithm(&costModel);
-        BracketStringInputParser p1(t1);
-        BracketStringInputParser p2(t2);
+    while (tests.next(test)) {
+        BracketStringInputParser p1(test.t1);
+        BracketStringInputParser p2(test.t2);
         Node<StringNodeData>* n1 = p1.getRoot();
         Node<StringNodeData>* n2 = p2.getRoot();
+        NodeIndexer<StringNodeData> ni1(n1, &costModel);
+        NodeIndexer<StringNodeData> ni2(n2, &costModel);
 
+        Apted<StringNodeData, Integer, DenseFloatMatrix, CountingInstrumentation> algorithm(&costModel);
         auto startTime = std::chrono::high_resolution_clock::now();
-        float TED = algorithm.computeEditDistance(n1, n2);
+        float TED = algorithm.computeEditDistance(&ni1, &ni2);
         auto endTime = std::chrono::high_resolution_clock::now();
 
         execTime += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
-        memoryUsage += algorithm.MAT.getCount();
+        memoryAccesses += algorithm.getInstrumentation().counts().memoryAccesses();
+
+        startTime = std::chrono::high_resolution_clock::now();
+        float dist = fd.treeDist(&ni1, &ni2, costModel);
+        endTime = std::chrono::high_resolution_clock::now();
+
+        execTimeZHSH += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        memoryAccessesZHSH += fd.getInstrumentation().counts().memoryAccesses();
 
         delete n1;
         delete n2;
     }
 
     cout << "Número de nós: " << numNodes << " - APTED:: Média de tempo gasto em " << numTests << " testes realizados: " << execTime / numTests << "ns" << endl;
-    cout << "Número de nós: " << numNodes << " - APTED:: Uso de memória: " << memoryUsage << " KB" << endl;
-    return execTime / numTests;
-}
-
-/**
- * @brief cria e realiza os testes de TED para zhang-Sasha
- * 
- * @param numNodes - quantidade de nós a serem gerados nas árvores
- * @param numTests - quantidade de testes a serem criados
- * @return double  - tempo de médio de execução
- */
-double test_TreeEditDistanceZHSH(int numNodes, int numTests) {
-    Tree_generator gen;
-    gen.generateTreeWithNodes(numNodes, numTests);
-
-    ifstream testFile("tests/trees.json");
-    json tests;
-    testFile >> tests;
-
-    double execTime = 0;
-    long memoryUsage = 0;
-
-    for (json test : tests) {
-        int id = test["ID"];
-        string t1 = test["t1"];
-        string t2 = test["t2"];
-
-        size_t pos1 = 0;
-        size_t pos2 = 0;
-
-        NodeZHSH* tree1 = buildTree(t1, pos1);
-        NodeZHSH* tree2 = buildTree(t2, pos2);
-
-        ForestDist fd;
-
-        auto startTime = std::chrono::high_resolution_clock::now();
-        int dist = fd.treeDist(tree1, tree2);
-        auto endTime = std::chrono::high_resolution_clock::now();
-
-        execTime += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
-        memoryUsage += fd.MAT.getCount();
-
-        delete tree1;
-        delete tree2;
-    }
-
-    cout << "Número de nós: " << numNodes << " - ZHSH :: Média de tempo gasto em " << numTests << " testes realizados: " << execTime / numTests << "ns" << endl;
-    cout << "Número de nós: " << numNodes << " - ZHSH :: Uso de memória: " << memoryUsage << " KB" << endl;
-    return execTime / numTests;
+    cout << "Número de nós: " << numNodes << " - APTED:: Acessos à memória: " << memoryAccesses << endl;
+    cout << "Número de nós: " << numNodes << " - ZHSH :: Média de tempo gasto em " << numTests << " testes realizados: " << execTimeZHSH / numTests << "ns" << endl;
+    cout << "Número de nós: " << numNodes << " - ZHSH :: Acessos à memória: " << memoryAccessesZHSH << endl;
 }
 
 // --- main --- //
@@ -172,6 +107,5 @@ int main(int argc, char const *argv[]) {
         int numNodes = numNodesList[i];
         int tests = numTests[i];
         test_TreeEditDistance(numNodes, tests);
-        test_TreeEditDistanceZHSH(numNodes, tests);
     }
 }
@@ -0,0 +1,1000 @@
+/**
+ * @file Check.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Verificações de regressão executadas por make check
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ *
+ * Uso:
+ *   check_runner [diretório dos casos, padrão tests]
+ *
+ * Os pares de correctness_test_cases.json (com a distância esperada em "d") e
+ * de worst_cases.json (sem distância; a referência é o Zhang-Shasha sequencial,
+ * e o APTED deve repetir a contagem de subproblemas gravada) passam por cada
+ * grupo de verificações abaixo. O código de saída é 1 se alguma verificação falhar.
+ */
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../includes/json.hpp"
+#include "../APTED/lib/Capted.h"
+#include "../APTED/lib/StringNodeSerializer.h"
+#include "../ZHSH/forest_dist.hpp"
+#include "../input/DocumentTree.hpp"
+#include "../input/PairStream.hpp"
+#include "../generator/Tree_generator.hpp"
+
+using namespace capted;
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @brief Par de árvores de um arquivo de casos
+ */
+struct CheckCase {
+    long id = 0;
+    string t1;
+    string t2;
+    float distance = -1;   /**< Distância esperada; -1 usa o Zhang-Shasha sequencial como referência */
+    long subproblems = -1; /**< Subproblemas esperados do APTED; -1 se o arquivo não tem o campo */
+};
+
+/**
+ * @brief Contagem das verificações de uma execução
+ */
+struct CheckReport {
+    long checks = 0;
+    long failures = 0;
+
+    /**
+     * @brief Registra uma verificação, imprimindo a mensagem se ela falhou
+     *
+     * @param ok - resultado da verificação
+     * @param message - o que foi verificado
+     */
+    void expect(bool ok, const string& message) {
+        checks++;
+        if (!ok) {
+            failures++;
+            cerr << "FALHA: " << message << endl;
+        }
+    }
+};
+
+/**
+ * @brief Lê um arquivo de casos (array JSON de objetos com t1 e t2)
+ *
+ * @param path - arquivo
+ * @param cases - recebe os casos
+ * @return true - se o arquivo foi lido
+ */
+bool loadCases(const string& path, vector<CheckCase>& cases) {
+    ifstream in(path);
+    json array = json::parse(in, nullptr, false);
+    if (!in.is_open() || !array.is_array()) {
+        return false;
+    }
+    for (const json& object : array) {
+        CheckCase test;
+        test.id = object.value("testID", object.value("ID", (long)cases.size()));
+        test.t1 = object.at("t1").get<string>();
+        test.t2 = object.at("t2").get<string>();
+        test.distance = object.value("d", -1.0f);
+        test.subproblems = object.value("subproblems", -1L);
+        cases.push_back(test);
+    }
+    return true;
+}
+
+/**
+ * @brief Descrição curta de um caso para as mensagens de falha
+ */
+string describe(const string& file, const CheckCase& test) {
+    return file + " #" + to_string(test.id);
+}
+
+/**
+ * @brief Caminho de um arquivo temporário desta execução
+ */
+string tempPath(const string& name) {
+    return "/tmp/capted-check-" + to_string(getpid()) + "-" + name;
+}
+
+Node<StringNodeData>* parseBracket(const string& tree) {
+    BracketStringInputParser parser(tree);
+    return parser.getRoot();
+}
+
+//------------------------------------------------------------------------------
+// Distâncias
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Preenche as distâncias esperadas que faltam com o Zhang-Shasha sequencial
+ *
+ * @param cases - casos; os sem distância recebem a de referência
+ */
+void fillReference(vector<CheckCase>& cases) {
+    StringCostModel costModel;
+    ForestDist fd;
+    for (CheckCase& test : cases) {
+        if (test.distance >= 0) {
+            continue;
+        }
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        test.distance = fd.treeDist(n1.get(), n2.get(), costModel);
+    }
+}
+
+/**
+ * @brief Calcula cada caso com uma configuração do APTED
+ *
+ * @tparam Index - largura dos índices
+ * @tparam Matrix - armazenamento de delta, das linhas de custo e das matrizes de spf
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param configuration - nome da configuração, para as mensagens
+ * @param report - recebe as verificações
+ */
+template<class Index, class Matrix>
+void checkApted(const string& file, const vector<CheckCase>& cases, const string& configuration, CheckReport& report) {
+    StringCostModel costModel;
+    MatrixOptions options;
+    // Poucos blocos residentes, para que MappedFloatMatrix devolva blocos ao arquivo.
+    options.residentBytes = (size_t)1 << 20;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        Apted<StringNodeData, Index, Matrix> algorithm(&costModel, options);
+        float distance = algorithm.computeEditDistance(n1.get(), n2.get());
+        report.expect(distance == test.distance, describe(file, test) + ": APTED " + configuration + " calculou "
+                      + to_string(distance) + ", esperado " + to_string(test.distance));
+        if (test.subproblems >= 0) {
+            report.expect(algorithm.getSubproblemCount() == test.subproblems,
+                          describe(file, test) + ": APTED " + configuration + " com "
+                          + to_string(algorithm.getSubproblemCount()) + " subproblemas, esperado "
+                          + to_string(test.subproblems));
+        }
+    }
+}
+
+/**
+ * @brief Calcula cada caso com o Zhang-Shasha sequencial
+ *
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param report - recebe as verificações
+ */
+void checkZhangShasha(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    ForestDist fd;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        float distance = fd.treeDist(n1.get(), n2.get(), costModel);
+        report.expect(distance == test.distance, describe(file, test) + ": ZHSH calculou "
+                      + to_string(distance) + ", esperado " + to_string(test.distance));
+    }
+}
+
+/**
+ * @brief Calcula cada caso com o Zhang-Shasha e o APTED sobre os mesmos
+ *        indexadores, que não devem ser alterados por nenhum dos dois
+ *
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param report - recebe as verificações
+ */
+void checkSharedInput(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    ForestDist fd;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        NodeIndexer<StringNodeData> ni1(n1.get(), &costModel), ni2(n2.get(), &costModel);
+        float zhsh = fd.treeDist(&ni1, &ni2, costModel);
+        Apted<StringNodeData> algorithm(&costModel);
+        float apted = algorithm.computeEditDistance(&ni1, &ni2);
+        float again = fd.treeDist(&ni1, &ni2, costModel);
+        report.expect(zhsh == test.distance && apted == test.distance && again == test.distance,
+                      describe(file, test) + ": com os mesmos indexadores, ZHSH " + to_string(zhsh) + ", APTED "
+                      + to_string(apted) + ", ZHSH de novo " + to_string(again) + ", esperado " + to_string(test.distance));
+    }
+}
+
+/**
+ * @brief Calcula cada caso com o Zhang-Shasha paralelo
+ *
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param report - recebe as verificações
+ */
+void checkParallelZhangShasha(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    ThreadPool pool(4);
+    ForestDist parallel;
+    parallel.setThreadPool(&pool);
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        NodeIndexer<StringNodeData> ni1(n1.get(), &costModel), ni2(n2.get(), &costModel);
+        float distance = parallel.treeDist(&ni1, &ni2, costModel);
+        report.expect(distance == test.distance, describe(file, test) + ": ZHSH paralelo calculou "
+                      + to_string(distance) + ", esperado " + to_string(test.distance));
+    }
+}
+
+/**
+ * @brief Confere que o limite inferior por sequências de rótulos nunca passa
+ *        da distância calculada pelo APTED
+ *
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param report - recebe as verificações
+ */
+void checkLowerBound(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    LabelSequenceBound bound;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        Apted<StringNodeData> algorithm(&costModel);
+        float distance = algorithm.computeEditDistance(n1.get(), n2.get());
+        float lower = bound.lowerBound(n1.get(), n2.get());
+        report.expect(lower <= distance, describe(file, test) + ": limite inferior " + to_string(lower)
+                      + " acima da distância " + to_string(distance));
+    }
+}
+
+/**
+ * @brief Confere as estatísticas de fases: sem a medição, nenhum tempo é
+ *        registrado e as chamadas de spf são as mesmas da execução medida, e
+ *        o tempo das spf cabe no tempo de gted
+ *
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param report - recebe as verificações
+ */
+void checkPhaseStats(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        Apted<StringNodeData> untimed(&costModel), timed(&costModel);
+        timed.setPhaseTiming(true);
+        untimed.computeEditDistance(n1.get(), n2.get());
+        timed.computeEditDistance(n1.get(), n2.get());
+
+        const PhaseStats& off = untimed.getPhaseStats();
+        const PhaseStats& on = timed.getPhaseStats();
+        report.expect(off.totalNs() == 0 && off.spfL.ns == 0 && off.spfR.ns == 0 && off.spfA.ns == 0 && off.spf1.ns == 0,
+                      describe(file, test) + ": tempo registrado com a medição de fases desligada");
+        report.expect(off.spfL.calls == on.spfL.calls && off.spfR.calls == on.spfR.calls
+                      && off.spfA.calls == on.spfA.calls && off.spf1.calls == on.spf1.calls,
+                      describe(file, test) + ": chamadas de spf diferem com a medição de fases ligada");
+        double spfNs = on.spfL.ns + on.spfR.ns + on.spfA.ns + on.spf1.ns;
+        report.expect(spfNs <= on.gtedNs, describe(file, test) + ": tempo das spf " + to_string(spfNs)
+                      + " ns acima do tempo de gted " + to_string(on.gtedNs) + " ns");
+    }
+}
+
+/**
+ * @brief Confere a instrumentação por contagem: no APTED, as células contadas
+ *        são os subproblemas e as chamadas de spf são as das estatísticas de
+ *        fases; no Zhang-Shasha, a execução paralela conta o mesmo que a sequencial
+ *
+ * @param file - nome do arquivo de casos, para as mensagens
+ * @param cases - casos com a distância esperada
+ * @param report - recebe as verificações
+ */
+void checkInstrumentation(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    ThreadPool pool(4);
+    CountingForestDist sequential;
+    CountingForestDist parallel;
+    parallel.setThreadPool(&pool);
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        Apted<StringNodeData, Integer, DenseFloatMatrix, CountingInstrumentation> algorithm(&costModel);
+        algorithm.computeEditDistance(n1.get(), n2.get());
+        const InstrumentationCounts& counts = algorithm.getInstrumentation().counts();
+        const PhaseStats& phases = algorithm.getPhaseStats();
+        report.expect(counts.cells == algorithm.getSubproblemCount(), describe(file, test) + ": "
+                      + to_string(counts.cells) + " células contadas, " + to_string(algorithm.getSubproblemCount())
+                      + " subproblemas");
+        report.expect(counts.spfCalls == phases.spfL.calls + phases.spfR.calls + phases.spfA.calls + phases.spf1.calls,
+                      describe(file, test) + ": chamadas de spf contadas diferem das estatísticas de fases");
+
+        NodeIndexer<StringNodeData> ni1(n1.get(), &costModel), ni2(n2.get(), &costModel);
+        sequential.treeDist(&ni1, &ni2, costModel);
+        parallel.treeDist(&ni1, &ni2, costModel);
+        const InstrumentationCounts& one = sequential.getInstrumentation().counts();
+        const InstrumentationCounts& many = parallel.getInstrumentation().counts();
+        report.expect(one.cells == many.cells && one.spfCalls == many.spfCalls,
+                      describe(file, test) + ": ZHSH paralelo contou " + to_string(many.cells) + " células e "
+                      + to_string(many.spfCalls) + " spf, sequencial " + to_string(one.cells) + " e "
+                      + to_string(one.spfCalls));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Cache do NodeIndexer
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Grava e recarrega o índice de t1, que deve dar a mesma distância e ser
+ *        recusado com outro modelo de custo ou outra árvore
+ */
+void checkIndexerCache(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    static const uint64_t COST_MODEL_ID = 7;
+    StringCostModel costModel;
+    string path = tempPath("index.cache");
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        NodeIndexer<StringNodeData> ni1(n1.get(), &costModel), ni2(n2.get(), &costModel);
+        if (!ni1.save(path, COST_MODEL_ID)) {
+            report.expect(false, describe(file, test) + ": não foi possível gravar " + path);
+            continue;
+        }
+
+        unique_ptr<NodeIndexer<StringNodeData>> loaded(NodeIndexer<StringNodeData>::load(path, n1.get(), &costModel, COST_MODEL_ID));
+        report.expect(loaded != nullptr, describe(file, test) + ": o cache gravado não foi carregado");
+        if (loaded != nullptr) {
+            Apted<StringNodeData> algorithm(&costModel);
+            float distance = algorithm.computeEditDistance(loaded.get(), &ni2);
+            report.expect(distance == test.distance, describe(file, test) + ": distância com o índice carregado "
+                          + to_string(distance) + ", esperado " + to_string(test.distance));
+        }
+
+        unique_ptr<NodeIndexer<StringNodeData>> otherModel(NodeIndexer<StringNodeData>::load(path, n1.get(), &costModel, COST_MODEL_ID + 1));
+        report.expect(otherModel == nullptr, describe(file, test) + ": cache aceito com outro modelo de custo");
+        if (BracketStringSerializer::toString(n1.get()) != BracketStringSerializer::toString(n2.get())) {
+            unique_ptr<NodeIndexer<StringNodeData>> otherTree(NodeIndexer<StringNodeData>::load(path, n2.get(), &costModel, COST_MODEL_ID));
+            report.expect(otherTree == nullptr, describe(file, test) + ": cache aceito para outra árvore");
+        }
+    }
+    remove(path.c_str());
+}
+
+//------------------------------------------------------------------------------
+// Serializadores
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Reescreve as árvores em notação de chaves e no formato binário (todas
+ *        no mesmo buffer) e confere que a leitura devolve as mesmas árvores
+ */
+void checkSerializers(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    vector<string> expected;
+    string binary;
+
+    for (const CheckCase& test : cases) {
+        for (const string* tree : {&test.t1, &test.t2}) {
+            unique_ptr<Node<StringNodeData>> root(parseBracket(*tree));
+            string bracket = BracketStringSerializer::toString(root.get());
+            report.expect(BracketStringSerializer::measure(root.get()) == bracket.size(),
+                          describe(file, test) + ": measure difere do tamanho da notação de chaves");
+            unique_ptr<Node<StringNodeData>> reparsed(parseBracket(bracket));
+            report.expect(BracketStringSerializer::toString(reparsed.get()) == bracket,
+                          describe(file, test) + ": notação de chaves não se mantém após releitura");
+
+            size_t before = binary.size();
+            BinaryTreeSerializer::append(root.get(), binary);
+            report.expect(binary.size() - before == BinaryTreeSerializer::measure(root.get()),
+                          describe(file, test) + ": measure difere do tamanho binário");
+            expected.push_back(bracket);
+        }
+    }
+
+    BinaryTreeInputParser parser(binary.data(), binary.size());
+    for (const string& bracket : expected) {
+        unique_ptr<Node<StringNodeData>> root(parser.getRoot());
+        report.expect(root != nullptr && BracketStringSerializer::toString(root.get()) == bracket,
+                      file + ": árvore binária lida difere de " + bracket.substr(0, 40));
+    }
+    report.expect(parser.consumed() == binary.size(), file + ": bytes binários não consumidos");
+
+    BinaryTreeInputParser truncated(binary.data(), binary.size() - 1);
+    Node<StringNodeData>* last = nullptr;
+    for (size_t i = 0; i < expected.size(); i++) {
+        delete last;
+        last = truncated.getRoot();
+    }
+    report.expect(last == nullptr, file + ": buffer binário truncado foi aceito");
+    delete last;
+}
+
+//------------------------------------------------------------------------------
+// Florestas
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Acrescenta as árvores a um SuccinctForest, intercalando entradas
+ *        inválidas que não devem alterar a floresta, e confere a reconstrução
+ */
+void checkSuccinctForest(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    SuccinctForest forest;
+    vector<string> expected;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1));
+        forest.addTree(n1.get());
+        expected.push_back(BracketStringSerializer::toString(n1.get()));
+
+        uint64_t trees = forest.numTrees(), nodes = forest.numNodes();
+        for (const char* invalid : {"{a{b}", "", "sem chaves", "{a{b{c}}"}) {
+            report.expect(!forest.addBracketString(invalid), describe(file, test) + ": SuccinctForest aceitou \"" + invalid + "\"");
+            report.expect(forest.numTrees() == trees && forest.numNodes() == nodes,
+                          describe(file, test) + ": SuccinctForest mudou após uma entrada inválida");
+        }
+
+        SuccinctForest::Checkpoint mark = forest.checkpoint();
+        forest.openNode("parcial");
+        forest.openNode("filho");
+        forest.rollback(mark);
+        report.expect(forest.numTrees() == trees && forest.numNodes() == nodes,
+                      describe(file, test) + ": rollback não restaurou o SuccinctForest");
+
+        report.expect(forest.addBracketString(test.t2), describe(file, test) + ": SuccinctForest recusou t2");
+        unique_ptr<Node<StringNodeData>> n2(parseBracket(test.t2));
+        expected.push_back(BracketStringSerializer::toString(n2.get()));
+    }
+
+    forest.build();
+    report.expect(forest.numTrees() == expected.size(), file + ": SuccinctForest com quantidade errada de árvores");
+    for (uint64_t i = 0; i < forest.numTrees() && i < expected.size(); i++) {
+        unique_ptr<Node<StringNodeData>> root(forest.toNode(i));
+        report.expect(BracketStringSerializer::toString(root.get()) == expected[i],
+                      file + ": árvore " + to_string(i) + " do SuccinctForest difere da original");
+    }
+}
+
+/**
+ * @brief Acrescenta as árvores a um SubtreeDag e confere a expansão e as distâncias
+ */
+void checkSubtreeDag(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    SubtreeDag dag;
+
+    for (const CheckCase& test : cases) {
+        report.expect(dag.addBracketString(test.t1), describe(file, test) + ": SubtreeDag recusou t1");
+        unique_ptr<Node<StringNodeData>> n2(parseBracket(test.t2));
+        dag.addTree(n2.get());
+
+        size_t trees = dag.numTrees();
+        report.expect(!dag.addBracketString("{a{b}"), describe(file, test) + ": SubtreeDag aceitou uma árvore inválida");
+        report.expect(dag.numTrees() == trees, describe(file, test) + ": SubtreeDag mudou após uma entrada inválida");
+    }
+
+    AdaptiveApted<StringNodeData> ted(&costModel);
+    for (size_t i = 0; i < cases.size(); i++) {
+        const CheckCase& test = cases[i];
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), expanded(dag.expandTree(2 * i));
+        report.expect(BracketStringSerializer::toString(expanded.get()) == BracketStringSerializer::toString(n1.get()),
+                      describe(file, test) + ": t1 expandido do SubtreeDag difere do original");
+        float distance = dag.computeEditDistance(ted, 2 * i, 2 * i + 1);
+        report.expect(distance == test.distance, describe(file, test) + ": distância pelo SubtreeDag "
+                      + to_string(distance) + ", esperado " + to_string(test.distance));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Lotes de pares
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Indexa t1 e t2 de cada caso (nas posições 2i e 2i + 1) e uma última
+ *        entrada cuja leitura falha
+ */
+shared_ptr<const IndexStore<StringNodeData>> buildStore(const vector<CheckCase>& cases, const StringCostModel* costModel,
+                                                        ThreadPool& pool) {
+    vector<string> inputs;
+    for (const CheckCase& test : cases) {
+        inputs.push_back(test.t1);
+        inputs.push_back(test.t2);
+    }
+    return IndexStore<StringNodeData>::build(inputs.size() + 1, [&inputs](size_t i) -> Node<StringNodeData>* {
+        return i < inputs.size() ? parseBracket(inputs[i]) : nullptr;
+    }, costModel, pool);
+}
+
+/**
+ * @brief Indexa as árvores em um IndexStore e calcula cada caso com os
+ *        indexadores do repositório
+ */
+void checkIndexStore(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    ThreadPool pool(4);
+    auto store = buildStore(cases, &costModel, pool);
+    size_t failing = 2 * cases.size();
+    report.expect(store->size() == failing + 1 && store->numFailures() == 1 && store->failed(failing)
+                  && !store->error(failing).empty(), file + ": IndexStore não marcou a entrada inválida");
+
+    for (size_t i = 0; i < cases.size(); i++) {
+        report.expect(!store->failed(2 * i) && !store->failed(2 * i + 1),
+                      describe(file, cases[i]) + ": IndexStore não indexou o par");
+        if (store->failed(2 * i) || store->failed(2 * i + 1)) {
+            continue;
+        }
+        Apted<StringNodeData> algorithm(&costModel);
+        float distance = algorithm.computeEditDistance(store->index(2 * i), store->index(2 * i + 1));
+        report.expect(distance == cases[i].distance, describe(file, cases[i]) + ": distância com o IndexStore "
+                      + to_string(distance) + ", esperado " + to_string(cases[i].distance));
+    }
+}
+
+/**
+ * @brief Calcula os pares com PairExecutor, dos indexadores de um IndexStore
+ *        (com uma entrada que falha) e das árvores, com matrizes mapeadas e um
+ *        limite de memória que enfileira ou rejeita os pares
+ */
+void checkPairExecutor(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+    ThreadPool pool(4);
+    auto store = buildStore(cases, &costModel, pool);
+
+    // Os pares com a última entrada, que falhou na leitura, devem trazer o erro.
+    size_t failing = 2 * cases.size();
+    vector<pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < cases.size(); i++) {
+        pairs.push_back({2 * i, 2 * i + 1});
+    }
+    pairs.push_back({0, failing});
+
+    PairExecutor<StringNodeData> executor(&costModel, pool);
+    vector<PairResult> results = executor.run(*store, pairs);
+    for (size_t i = 0; i < cases.size(); i++) {
+        report.expect(results[i].error.empty() && results[i].distance == cases[i].distance,
+                      describe(file, cases[i]) + ": PairExecutor calculou " + to_string(results[i].distance)
+                      + ", esperado " + to_string(cases[i].distance));
+    }
+    report.expect(!results.back().error.empty(), file + ": PairExecutor não devolveu o erro da entrada inválida");
+
+    vector<unique_ptr<Node<StringNodeData>>> roots;
+    vector<pair<Node<StringNodeData>*, Node<StringNodeData>*>> nodePairs;
+    for (const CheckCase& test : cases) {
+        roots.emplace_back(parseBracket(test.t1));
+        roots.emplace_back(parseBracket(test.t2));
+        nodePairs.push_back({roots[roots.size() - 2].get(), roots.back().get()});
+    }
+    ExecutorOptions options;
+    options.matrixOptions.residentBytes = (size_t)1 << 20;
+    options.memoryBudget = (size_t)8 << 20;
+    PairExecutor<StringNodeData, Integer, MappedFloatMatrix> mapped(&costModel, pool, options);
+    results = mapped.run(nodePairs);
+    for (size_t i = 0; i < cases.size(); i++) {
+        report.expect(results[i].error.empty() && !results[i].rejected && results[i].distance == cases[i].distance,
+                      describe(file, cases[i]) + ": PairExecutor mapeado calculou " + to_string(results[i].distance)
+                      + ", esperado " + to_string(cases[i].distance));
+    }
+
+    options.memoryBudget = 1;
+    options.overBudget = OverBudgetPolicy::Reject;
+    PairExecutor<StringNodeData> rejecting(&costModel, pool, options);
+    results = rejecting.run(nodePairs);
+    for (size_t i = 0; i < cases.size(); i++) {
+        report.expect(results[i].rejected, describe(file, cases[i]) + ": par acima do limite não foi rejeitado");
+    }
+}
+
+//------------------------------------------------------------------------------
+// Edições locais do NodeIndexer
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Confere o indexador editado contra um indexador novo da árvore editada
+ */
+void expectSameIndex(NodeIndexer<StringNodeData>& edited, Node<StringNodeData>* tree, NodeIndexer<StringNodeData>& other,
+                     const string& message, CheckReport& report) {
+    StringCostModel costModel;
+    NodeIndexer<StringNodeData> fresh(tree, &costModel);
+    report.expect(edited.getSize() == fresh.getSize() && edited.treeHash() == fresh.treeHash(),
+                  message + ": índice editado difere do reindexado");
+
+    Apted<StringNodeData> incremental(&costModel), rebuilt(&costModel);
+    float distance = incremental.computeEditDistance(&edited, &other);
+    float expected = rebuilt.computeEditDistance(&fresh, &other);
+    report.expect(distance == expected, message + ": distância com o índice editado " + to_string(distance)
+                  + ", reindexado " + to_string(expected));
+}
+
+/**
+ * @brief Aplica inserções, remoções e substituições em t1 pelo indexador e
+ *        confere cada passo contra a reindexação completa
+ */
+void checkIncrementalIndexer(const string& file, const vector<CheckCase>& cases, CheckReport& report) {
+    StringCostModel costModel;
+
+    for (const CheckCase& test : cases) {
+        unique_ptr<Node<StringNodeData>> n1(parseBracket(test.t1)), n2(parseBracket(test.t2));
+        NodeIndexer<StringNodeData> ni1(n1.get(), &costModel), ni2(n2.get(), &costModel);
+        string name = describe(file, test);
+
+        ni1.addChild(n1.get(), parseBracket("{x}"));
+        expectSameIndex(ni1, n1.get(), ni2, name + " addChild", report);
+
+        ni1.insertChild(n1.get(), n1->getChildren().begin(), parseBracket("{y{z}{x}}"));
+        expectSameIndex(ni1, n1.get(), ni2, name + " insertChild", report);
+
+        Node<StringNodeData>* first = n1->getChildren().front();
+        ni1.replaceChild(n1.get(), first, parseBracket("{w{v}}"));
+        delete first;
+        expectSameIndex(ni1, n1.get(), ni2, name + " replaceChild", report);
+
+        // v é filho de w, não da raiz: o índice e a árvore não devem mudar.
+        Node<StringNodeData>* grandchild = n1->getChildren().front()->getChildren().front();
+        unique_ptr<Node<StringNodeData>> stray(parseBracket("{u}"));
+        bool threw = false;
+        try {
+            ni1.replaceChild(n1.get(), grandchild, stray.get());
+        } catch (const invalid_argument&) {
+            threw = true;
+        }
+        report.expect(threw, name + ": replaceChild aceitou um filho de outro nó");
+        expectSameIndex(ni1, n1.get(), ni2, name + " replaceChild recusado", report);
+
+        Node<StringNodeData>* last = n1->getChildren().back();
+        ni1.detachFromParent(last);
+        delete last;
+        expectSameIndex(ni1, n1.get(), ni2, name + " detachFromParent", report);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Documentos
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Lê um documento JSON e um XML como Node e no SuccinctForest, e confere
+ *        que documentos inválidos não alteram a floresta
+ */
+void checkDocuments(CheckReport& report) {
+    const string jsonDocument = "{\"a\": [1, \"x\"], \"b\": true, \"c\": {}}";
+    const string jsonTree = "{object{a{array{1}{x}}}{b{true}}{c{object}}}";
+    const string xmlDocument = "<r k=\"v\"><c>t</c><d/></r>";
+    const string xmlTree = "{r{@k{v}}{c{t}}{d}}";
+
+    istringstream jsonIn(jsonDocument);
+    JsonInputParser jsonParser(jsonIn);
+    unique_ptr<Node<StringNodeData>> jsonRoot(jsonParser.getRoot());
+    report.expect(jsonRoot != nullptr && BracketStringSerializer::toString(jsonRoot.get()) == jsonTree,
+                  "JsonInputParser: árvore diferente de " + jsonTree + " " + jsonParser.error());
+
+    istringstream xmlIn(xmlDocument);
+    XmlInputParser xmlParser(xmlIn);
+    unique_ptr<Node<StringNodeData>> xmlRoot(xmlParser.getRoot());
+    report.expect(xmlRoot != nullptr && BracketStringSerializer::toString(xmlRoot.get()) == xmlTree,
+                  "XmlInputParser: árvore diferente de " + xmlTree + " " + xmlParser.error());
+
+    SuccinctForest forest;
+    istringstream jsonForestIn(jsonDocument), xmlForestIn(xmlDocument);
+    report.expect(addJsonDocument(jsonForestIn, forest), "addJsonDocument recusou um documento válido");
+    report.expect(addXmlDocument(xmlForestIn, forest), "addXmlDocument recusou um documento válido");
+
+    uint64_t trees = forest.numTrees(), nodes = forest.numNodes();
+    for (const char* invalid : {"{\"a\": [1, 2}", "{\"a\": ", "[1, 2] 3"}) {
+        istringstream in(invalid);
+        string error;
+        report.expect(!addJsonDocument(in, forest, DocumentLabeling(), &error) && !error.empty(),
+                      string("addJsonDocument aceitou ") + invalid);
+        report.expect(forest.numTrees() == trees && forest.numNodes() == nodes,
+                      string("addJsonDocument alterou a floresta com ") + invalid);
+    }
+    for (const char* invalid : {"<r><c></r>", "<r>", "<r/><s/>"}) {
+        istringstream in(invalid);
+        string error;
+        report.expect(!addXmlDocument(in, forest, DocumentLabeling(), &error) && !error.empty(),
+                      string("addXmlDocument aceitou ") + invalid);
+        report.expect(forest.numTrees() == trees && forest.numNodes() == nodes,
+                      string("addXmlDocument alterou a floresta com ") + invalid);
+    }
+
+    forest.build();
+    unique_ptr<Node<StringNodeData>> first(forest.toNode(0)), second(forest.toNode(1));
+    report.expect(BracketStringSerializer::toString(first.get()) == jsonTree, "documento JSON difere no SuccinctForest");
+    report.expect(BracketStringSerializer::toString(second.get()) == xmlTree, "documento XML difere no SuccinctForest");
+}
+
+//------------------------------------------------------------------------------
+// PairStream
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Lê um arquivo com PairStream
+ *
+ * @param path - arquivo
+ * @param contents - conteúdo gravado antes da leitura
+ * @param pairs - recebe a quantidade de pares lidos
+ * @param error - recebe a mensagem de erro
+ * @return true - se a leitura terminou por erro
+ */
+bool readPairs(const string& path, const string& contents, size_t& pairs, string& error) {
+    ofstream(path) << contents;
+    PairStream stream(path);
+    TreePair pair;
+    pairs = 0;
+    while (stream.next(pair)) {
+        pairs++;
+    }
+    error = stream.error();
+    remove(path.c_str());
+    return stream.failed();
+}
+
+/**
+ * @brief Confere que cada formato do PairStream para no primeiro registro
+ *        inválido com uma mensagem que aponta o registro
+ */
+void checkPairStream(const string& casesPath, size_t numCases, CheckReport& report) {
+    PairStream valid(casesPath);
+    TreePair pair;
+    size_t count = 0;
+    while (valid.next(pair)) {
+        count++;
+    }
+    report.expect(!valid.failed() && count == numCases, "PairStream leu " + to_string(count) + " pares de " + casesPath);
+
+    struct BrokenFile {
+        string name;
+        string contents;
+        size_t pairs;
+        string position;
+    };
+    const BrokenFile files[] = {
+        {"pairs.json", "[{\"t1\": \"{a}\", \"t2\": \"{b}\"}, {\"t1\": \"{a}\"}, {\"t1\": \"{c}\", \"t2\": \"{d}\"}]", 1, "elemento 1"},
+        {"pairs.ndjson", "{\"t1\": \"{a}\", \"t2\": \"{b}\"}\n{\"x\": 1}\n{\"t1\": \"{c}\", \"t2\": \"{d}\"}\n", 1, ":2:"},
+        {"object.json", "{\"t1\": \"{a}\", \"t2\": \"{b}\"}", 0, "não contém um array JSON"},
+        {"scalar.json", "[{\"t1\": \"{a}\", \"t2\": \"{b}\"}, 1, {\"t1\": \"{c}\", \"t2\": \"{d}\"}]", 1, "elemento 1"},
+        {"nested.json", "[{\"t1\": \"{a}\", \"t2\": \"{b}\"}, [{\"t1\": \"{c}\", \"t2\": \"{d}\"}]]", 1, "elemento 1"},
+        {"pairs.txt", "{a} {b}\n{a}\n{c} {d}\n", 1, ":2:"},
+        {"unbalanced.txt", "{a} {b}\n{a} {b}}}\n{c} {d}\n", 1, ":2:"},
+        {"trailing.txt", "{a} {b}\n{a} {b} junk {c}\n{c} {d}\n", 1, ":2:"}
+    };
+    for (const BrokenFile& file : files) {
+        size_t pairs;
+        string error;
+        bool failed = readPairs(tempPath(file.name), file.contents, pairs, error);
+        report.expect(failed && pairs == file.pairs && error.find(file.position) != string::npos,
+                      "PairStream em " + file.name + ": " + to_string(pairs) + " pares, erro \"" + error + "\"");
+    }
+
+    PairStream missing(tempPath("ausente.json"));
+    report.expect(!missing.next(pair) && missing.failed(), "PairStream não falhou com um arquivo ausente");
+}
+
+//------------------------------------------------------------------------------
+// Gerador
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Lista os filhos de cada nó de uma árvore gerada, na ordem dos índices
+ */
+vector<vector<int>> childLists(const GeneratedTree& tree) {
+    vector<vector<int>> children(tree.size());
+    for (size_t i = 1; i < tree.size(); i++) {
+        children[tree.parent[i]].push_back(i);
+    }
+    return children;
+}
+
+/**
+ * @brief Confere que cada família de formatos gera árvores do tamanho pedido,
+ *        com os pais antes dos filhos, e a estrutura própria de cada família
+ */
+void checkShapes(CheckReport& report) {
+    const TreeShape shapes[] = {TreeShape::Path, TreeShape::Star, TreeShape::FullKary, TreeShape::RandomRecursive,
+                                TreeShape::LeftBranch, TreeShape::RightBranch, TreeShape::ZigZag,
+                                TreeShape::RandomFanout, TreeShape::RandomSplit};
+    Tree_generator generator;
+
+    for (TreeShape shape : shapes) {
+        for (int n : {1, 2, 7, 50}) {
+            for (int arity : {1, 3}) {
+                TreeRng rng = generator.stream(n * 10 + arity);
+                GeneratedTree tree = Tree_generator::createShape(rng, shape, n, arity);
+                string name = string(Tree_generator::shapeName(shape)) + " n=" + to_string(n) + " k=" + to_string(arity);
+                report.expect((int)tree.size() == n && tree.label.size() == tree.size() && tree.parent[0] == -1,
+                              name + ": árvore com " + to_string(tree.size()) + " nós");
+                if ((int)tree.size() != n) {
+                    continue;
+                }
+
+                bool parentsFirst = true, structure = true;
+                for (int i = 1; i < n; i++) {
+                    parentsFirst = parentsFirst && tree.parent[i] >= 0 && tree.parent[i] < i;
+                    switch (shape) {
+                        case TreeShape::Path: structure = structure && tree.parent[i] == i - 1; break;
+                        case TreeShape::Star: structure = structure && tree.parent[i] == 0; break;
+                        case TreeShape::FullKary: structure = structure && tree.parent[i] == (i - 1) / arity; break;
+                        default: break;
+                    }
+                }
+                report.expect(parentsFirst, name + ": pai depois do filho");
+
+                vector<vector<int>> children = childLists(tree);
+                if (shape == TreeShape::RandomFanout) {
+                    for (const vector<int>& kids : children) {
+                        structure = structure && (int)kids.size() <= 2 * arity - 1;
+                    }
+                }
+                if (shape == TreeShape::LeftBranch || shape == TreeShape::RightBranch || shape == TreeShape::ZigZag) {
+                    // O caminho segue pelo filho que não é folha; a folha fica do outro lado.
+                    int node = 0;
+                    for (int step = 0; structure && !children[node].empty(); step++) {
+                        const vector<int>& kids = children[node];
+                        structure = kids.size() <= 2;
+                        if (kids.size() < 2) {
+                            node = kids[0];
+                            continue;
+                        }
+                        bool left = shape == TreeShape::LeftBranch || (shape == TreeShape::ZigZag && step % 2 == 0);
+                        int leaf = left ? kids[1] : kids[0];
+                        structure = structure && children[leaf].empty();
+                        node = left ? kids[0] : kids[1];
+                    }
+                }
+                report.expect(structure, name + ": estrutura diferente do formato");
+            }
+        }
+    }
+}
+
+/**
+ * @brief Confere que k edições plantadas em uma árvore a deixam a uma distância
+ *        de no máximo k da original
+ */
+void checkPlantedEdits(CheckReport& report) {
+    StringCostModel costModel;
+    Tree_generator generator;
+    uint64_t stream = 0;
+
+    for (TreeShape shape : {TreeShape::RandomRecursive, TreeShape::FullKary, TreeShape::Path}) {
+        for (int edits : {0, 1, 3, 8}) {
+            TreeRng rng = generator.stream(stream++);
+            GeneratedTree base = Tree_generator::createShape(rng, shape, 40, 3);
+            GeneratedTree edited = Tree_generator::plantEdits(rng, base, edits);
+            unique_ptr<Node<StringNodeData>> n1(parseBracket(Tree_generator::toBracket(base)));
+            unique_ptr<Node<StringNodeData>> n2(parseBracket(Tree_generator::toBracket(edited)));
+            Apted<StringNodeData> algorithm(&costModel);
+            float distance = algorithm.computeEditDistance(n1.get(), n2.get());
+            report.expect(distance <= edits, string(Tree_generator::shapeName(shape)) + ": " + to_string(edits)
+                          + " edições plantadas, distância " + to_string(distance));
+        }
+    }
+}
+
+/**
+ * @brief Lê um arquivo inteiro, removendo-o em seguida
+ */
+string readAndRemove(const string& path) {
+    ifstream in(path, ios::binary);
+    string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    remove(path.c_str());
+    return contents;
+}
+
+/**
+ * @brief Confere que cada fluxo de TreeRng depende só da semente e do número do
+ *        fluxo, e que um corpus gerado com uma ou várias threads é o mesmo
+ */
+void checkDeterminism(CheckReport& report) {
+    TreeRng first(42, 7), same(42, 7), otherStream(42, 8);
+    bool repeats = true, differs = false;
+    for (int i = 0; i < 100; i++) {
+        uint64_t value = first.next();
+        repeats = repeats && value == same.next();
+        differs = differs || value != otherStream.next();
+    }
+    report.expect(repeats, "TreeRng: mesma semente e fluxo deram sequências diferentes");
+    report.expect(differs, "TreeRng: fluxos diferentes deram a mesma sequência");
+
+    Tree_generator generator(42, tempPath("pairs.json"));
+    for (CorpusFormat format : {CorpusFormat::Ndjson, CorpusFormat::Binary}) {
+        string single = tempPath("corpus-1"), parallel = tempPath("corpus-4");
+        bool written = generator.generateCorpus(single, format, TreeShape::RandomRecursive, 60, 200, 2, 1)
+                    && generator.generateCorpus(parallel, format, TreeShape::RandomRecursive, 60, 200, 2, 4);
+        string one = readAndRemove(single), many = readAndRemove(parallel);
+        report.expect(written && !one.empty() && one == many, "generateCorpus: corpus com 4 threads difere do gerado com 1");
+    }
+}
+
+/**
+ * @brief Gera um corpus a partir de um perfil conhecido e confere que o ajuste
+ *        sobre o corpus recupera o alfabeto e o expoente de Zipf dos rótulos
+ */
+void checkProfileFit(CheckReport& report) {
+    TreeProfile profile;
+    profile.alphabetSize = 20;
+    profile.zipfExponent = 1.2;
+    profile.fanout = {TreeProfile::powerLawFanout(4, 1.0)};
+    profile.sizes = {100};
+
+    Tree_generator generator(42, tempPath("pairs.json"));
+    string path = tempPath("profile.ndjson");
+    TreeProfile fitted;
+    string error;
+    bool ok = generator.generateCorpus(path, CorpusFormat::Ndjson, profile, 300)
+           && fitProfile(path, SampleFormat::Trees, fitted, &error);
+    remove(path.c_str());
+    report.expect(ok, "fitProfile falhou com o corpus gerado: " + error);
+    report.expect(fitted.alphabetSize == profile.alphabetSize,
+                  "fitProfile: alfabeto de " + to_string(fitted.alphabetSize) + " rótulos, esperado "
+                  + to_string(profile.alphabetSize));
+    report.expect(fabs(fitted.zipfExponent - profile.zipfExponent) < 0.15,
+                  "fitProfile: expoente de Zipf " + to_string(fitted.zipfExponent) + ", esperado "
+                  + to_string(profile.zipfExponent));
+}
+
+// --- main --- //
+int main(int argc, char const *argv[]) {
+    string directory = argc > 1 ? argv[1] : "tests";
+    CheckReport report;
+
+    for (const string file : {"correctness_test_cases.json", "worst_cases.json"}) {
+        vector<CheckCase> cases;
+        if (!loadCases(directory + "/" + file, cases)) {
+            cerr << "não foi possível ler " << directory << "/" << file << endl;
+            return 1;
+        }
+        fillReference(cases);
+
+        checkApted<int16_t, DenseFloatMatrix>(file, cases, "int16/dense", report);
+        checkApted<int32_t, DenseFloatMatrix>(file, cases, "int32/dense", report);
+        checkApted<int64_t, DenseFloatMatrix>(file, cases, "int64/dense", report);
+        checkApted<int16_t, MappedFloatMatrix>(file, cases, "int16/mapped", report);
+        checkApted<int32_t, MappedFloatMatrix>(file, cases, "int32/mapped", report);
+        checkApted<int64_t, MappedFloatMatrix>(file, cases, "int64/mapped", report);
+        checkZhangShasha(file, cases, report);
+        checkSharedInput(file, cases, report);
+        checkParallelZhangShasha(file, cases, report);
+        checkLowerBound(file, cases, report);
+        checkPhaseStats(file, cases, report);
+        checkInstrumentation(file, cases, report);
+        checkIndexerCache(file, cases, report);
+        checkSerializers(file, cases, report);
+        checkSuccinctForest(file, cases, report);
+        checkSubtreeDag(file, cases, report);
+        checkIndexStore(file, cases, report);
+        checkPairExecutor(file, cases, report);
+        checkIncrementalIndexer(file, cases, report);
+        checkPairStream(directory + "/" + file, cases.size(), report);
+        cout << file << ": " << cases.size() << " pares" << endl;
+    }
+    checkDocuments(report);
+    checkShapes(report);
+    checkPlantedEdits(report);
+    checkDeterminism(report);
+    checkProfileFit(report);
+
+    cout << report.checks << " verificações, " << report.failures << " falhas" << endl;
+    return report.failures == 0 ? 0 : 1;
+}
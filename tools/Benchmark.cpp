@@ -0,0 +1,701 @@
+/**
+ * @file Benchmark.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Medição de desempenho dos algoritmos de distância de edição sobre uma
+ *        matriz de tamanhos, formatos e algoritmos
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ *
+ * Uso:
+ *   benchmark [--sizes 10,50,100] [--shapes random-split,zig-zag]
+ *             [--engines apted,zhsh] [--pairs P] [--edits K] [--warmup W]
+ *             [--reps R] [--seed S] [--phases on|off] [--format csv|json]
+ *             [--output arquivo]
+ *
+ * Para cada combinação de tamanho, formato e algoritmo, P pares são gerados e
+ * indexados em memória (com --edits K, t2 é t1 com K edições; sem ele, as duas
+ * árvores são independentes). Cada par é calculado W vezes sem medição e R
+ * vezes com medição; cada medição é uma amostra. A saída tem uma linha por
+ * combinação, em CSV ou JSON.
+ *
+ * Com --phases on, cada par é calculado mais uma vez pelo APTED com a medição de
+ * fases ligada (fora das amostras, que não pagam a leitura do relógio), e as
+ * linhas do APTED ganham o tempo médio de cada fase e de cada tipo de spf.
+ *
+ * Cada combinação é medida em um processo filho, então peak_rss_delta_kb (o
+ * pico de memória residente acima da memória no início da combinação, que já
+ * contém os pares indexados) não herda a memória liberada por combinações
+ * anteriores nem os buffers do ForestDist de outra combinação. Em árvores
+ * pequenas o valor é dominado pelas páginas de código e de pilha que o filho
+ * toca pela primeira vez (algumas centenas de KB).
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../includes/json.hpp"
+#include "../APTED/lib/Capted.h"
+#include "../ZHSH/forest_dist.hpp"
+#include "../generator/Tree_generator.hpp"
+#include "NodeBuilder.hpp"
+
+using namespace capted;
+using json = nlohmann::json;
+
+/**
+ * @brief Configuração da medição, lida da linha de comando
+ */
+struct BenchmarkOptions {
+    vector<int> sizes = {10, 50, 100};
+    vector<TreeShape> shapes = {TreeShape::RandomSplit};
+    vector<string> engines = {"apted", "zhsh"};
+    int pairs = 20;                          /**< Pares por combinação */
+    int edits = -1;                          /**< Edições de t1 para t2; -1 gera t2 independente */
+    int warmup = 2;                          /**< Cálculos não medidos por par */
+    int reps = 5;                            /**< Cálculos medidos por par */
+    uint64_t seed = Tree_generator::DEFAULT_SEED;
+    bool phases = false;                     /**< Mede as fases do APTED em uma passada extra */
+    bool json = false;                       /**< Saída em JSON em vez de CSV */
+    string output = "-";                     /**< Arquivo de saída; "-" para a saída padrão */
+};
+
+/**
+ * @brief Par de árvores já indexado, reaproveitado por todas as medições
+ */
+struct IndexedPair {
+    Node<StringNodeData>* n1;
+    Node<StringNodeData>* n2;
+    NodeIndexer<StringNodeData>* ni1;
+    NodeIndexer<StringNodeData>* ni2;
+};
+
+/**
+ * @brief Resultado de uma combinação de tamanho, formato e algoritmo
+ */
+struct BenchmarkRow {
+    string engine;
+    string shape;
+    int nodes = 0;
+    size_t samples = 0;
+    size_t outliers = 0;     /**< Amostras fora das cercas de Tukey, excluídas da média e do desvio */
+    double meanNs = 0;
+    double stddevNs = 0;
+    double minNs = 0;
+    double p50Ns = 0;
+    double p90Ns = 0;
+    double p99Ns = 0;
+    double maxNs = 0;
+    double pairsPerSecond = 0;
+    long peakRssDeltaKb = 0; /**< Pico de memória residente da combinação acima da memória inicial */
+    double distanceSum = 0;  /**< Soma das distâncias, para conferir os algoritmos entre si */
+    bool hasPhases = false;  /**< Se phases foi medido (só APTED, com --phases on) */
+    PhaseStats phases;       /**< Média por par dos tempos e chamadas das fases */
+};
+
+//------------------------------------------------------------------------------
+// Memória
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Reinicia o pico de memória residente do processo (Linux 4.0 ou
+ *        superior). Sem suporte, o pico medido é o do processo inteiro.
+ */
+void resetPeakRss() {
+    ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs) {
+        clearRefs << "5";
+    }
+}
+
+/**
+ * @brief Lê um campo em KB de /proc/self/status
+ *
+ * @param field - nome do campo com os dois pontos, como "VmRSS:"
+ * @return long - valor em KB, ou -1 se /proc não estiver disponível
+ */
+long statusKb(const string& field) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0) {
+            return atol(line.c_str() + field.size());
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Obtém o pico de memória residente desde resetPeakRss (VmHWM), ou o
+ *        pico do processo inteiro por getrusage se /proc não estiver disponível
+ *
+ * @return long - pico em KB
+ */
+long peakRssKb() {
+    long peak = statusKb("VmHWM:");
+    if (peak >= 0) {
+        return peak;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief Obtém a memória residente atual (VmRSS), ou 0 se /proc não estiver disponível
+ *
+ * @return long - memória em KB
+ */
+long currentRssKb() {
+    return max(statusKb("VmRSS:"), 0L);
+}
+
+//------------------------------------------------------------------------------
+// Estatísticas
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Percentil por interpolação linear entre as amostras ordenadas
+ *
+ * @param sorted - amostras em ordem crescente, não vazias
+ * @param p - percentil entre 0 e 100
+ * @return double - valor do percentil
+ */
+double percentile(const vector<double>& sorted, double p) {
+    double position = p / 100.0 * (sorted.size() - 1);
+    size_t below = (size_t)position;
+    size_t above = min(below + 1, sorted.size() - 1);
+    return sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+}
+
+/**
+ * @brief Preenche as estatísticas da linha. Os percentis usam todas as
+ *        amostras; a média e o desvio padrão ignoram as amostras fora das
+ *        cercas de Tukey (Q1 - 1,5 IQR, Q3 + 1,5 IQR).
+ *
+ * @param samples - tempo de cada cálculo medido, em ns
+ * @param row - recebe as estatísticas
+ */
+void summarize(vector<double> samples, BenchmarkRow& row) {
+    row.samples = samples.size();
+    if (samples.empty()) {
+        return;
+    }
+    sort(samples.begin(), samples.end());
+
+    double q1 = percentile(samples, 25);
+    double q3 = percentile(samples, 75);
+    double low = q1 - 1.5 * (q3 - q1);
+    double high = q3 + 1.5 * (q3 - q1);
+
+    double sum = 0, sumSquares = 0, total = 0;
+    size_t kept = 0;
+    for (double sample : samples) {
+        total += sample;
+        if (sample < low || sample > high) {
+            continue;
+        }
+        sum += sample;
+        sumSquares += sample * sample;
+        kept++;
+    }
+
+    row.outliers = samples.size() - kept;
+    row.meanNs = sum / kept;
+    row.stddevNs = kept > 1 ? sqrt(max(0.0, (sumSquares - sum * sum / kept) / (kept - 1))) : 0;
+    row.minNs = samples.front();
+    row.p50Ns = percentile(samples, 50);
+    row.p90Ns = percentile(samples, 90);
+    row.p99Ns = percentile(samples, 99);
+    row.maxNs = samples.back();
+    row.pairsPerSecond = total > 0 ? samples.size() / (total * 1e-9) : 0;
+}
+
+//------------------------------------------------------------------------------
+// Medição
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Mede um algoritmo sobre pares já indexados
+ *
+ * @param engine - calcula a distância de um par
+ * @param pairs - pares indexados
+ * @param options - configuração da medição
+ * @param row - recebe as estatísticas
+ */
+void measure(const function<float(const IndexedPair&)>& engine, const vector<IndexedPair>& pairs,
+             const BenchmarkOptions& options, BenchmarkRow& row) {
+    vector<double> samples;
+    samples.reserve(pairs.size() * max(options.reps, 0));
+
+    for (const IndexedPair& pair : pairs) {
+        for (int w = 0; w < options.warmup; ++w) {
+            engine(pair);
+        }
+        for (int r = 0; r < options.reps; ++r) {
+            auto startTime = std::chrono::steady_clock::now();
+            float distance = engine(pair);
+            auto endTime = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(endTime - startTime).count());
+            if (r == 0) {
+                row.distanceSum += distance;
+            }
+        }
+    }
+    summarize(samples, row);
+}
+
+/**
+ * @brief Mede as fases do APTED: uma passada com a medição de fases ligada, com
+ *        a média por par de cada tempo e de cada contagem de chamadas
+ *
+ * @param pairs - pares indexados
+ * @param costModel - modelo de custo
+ * @param row - recebe as fases
+ */
+void measurePhases(const vector<IndexedPair>& pairs, StringCostModel& costModel, BenchmarkRow& row) {
+    PhaseStats sum;
+    auto add = [](SpfStats& total, const SpfStats& spf) {
+        total.calls += spf.calls;
+        total.ns += spf.ns;
+    };
+    for (const IndexedPair& pair : pairs) {
+        Apted<StringNodeData> algorithm(&costModel);
+        algorithm.setPhaseTiming(true);
+        algorithm.computeEditDistance(pair.ni1, pair.ni2);
+        const PhaseStats& stats = algorithm.getPhaseStats();
+        sum.indexingNs += stats.indexingNs;
+        sum.strategyNs += stats.strategyNs;
+        sum.tedInitNs += stats.tedInitNs;
+        sum.gtedNs += stats.gtedNs;
+        add(sum.spfL, stats.spfL);
+        add(sum.spfR, stats.spfR);
+        add(sum.spfA, stats.spfA);
+        add(sum.spf1, stats.spf1);
+    }
+
+    double count = max(pairs.size(), (size_t)1);
+    auto average = [count](SpfStats& spf) {
+        spf.calls = lround(spf.calls / count);
+        spf.ns /= count;
+    };
+    sum.indexingNs /= count;
+    sum.strategyNs /= count;
+    sum.tedInitNs /= count;
+    sum.gtedNs /= count;
+    average(sum.spfL);
+    average(sum.spfR);
+    average(sum.spfA);
+    average(sum.spf1);
+    row.phases = sum;
+    row.hasPhases = true;
+}
+
+/**
+ * @brief Gera e indexa os pares de uma combinação de tamanho e formato. O par i
+ *        usa os fluxos 2i e 2i + 1, então é o mesmo em qualquer execução com a
+ *        mesma semente.
+ *
+ * @param gen - gerador
+ * @param shape - família do formato
+ * @param nodes - tamanho das árvores
+ * @param options - configuração da medição
+ * @param costModel - modelo de custo dos indexadores
+ * @return vector<IndexedPair> - pares indexados (liberados com releasePairs)
+ */
+vector<IndexedPair> buildPairs(const Tree_generator& gen, TreeShape shape, int nodes,
+                               const BenchmarkOptions& options, StringCostModel& costModel) {
+    vector<IndexedPair> pairs(options.pairs);
+    for (int i = 0; i < options.pairs; ++i) {
+        TreeRng rng1 = gen.stream(2 * i), rng2 = gen.stream(2 * i + 1);
+        GeneratedTree t1 = Tree_generator::createShape(rng1, shape, nodes);
+        GeneratedTree t2 = options.edits >= 0 ? Tree_generator::plantEdits(rng2, t1, options.edits)
+                                              : Tree_generator::createShape(rng2, shape, nodes);
+        pairs[i].n1 = buildNodes(t1);
+        pairs[i].n2 = buildNodes(t2);
+        pairs[i].ni1 = new NodeIndexer<StringNodeData>(pairs[i].n1, &costModel);
+        pairs[i].ni2 = new NodeIndexer<StringNodeData>(pairs[i].n2, &costModel);
+    }
+    return pairs;
+}
+
+/**
+ * @brief Libera os pares criados por buildPairs
+ *
+ * @param pairs - pares indexados
+ */
+void releasePairs(vector<IndexedPair>& pairs) {
+    for (IndexedPair& pair : pairs) {
+        delete pair.ni1;
+        delete pair.ni2;
+        delete pair.n1;
+        delete pair.n2;
+    }
+    pairs.clear();
+}
+
+//------------------------------------------------------------------------------
+// Linha de comando e saída
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Separa uma lista separada por vírgulas
+ *
+ * @param value - lista
+ * @return vector<string> - itens não vazios
+ */
+vector<string> splitList(const string& value) {
+    vector<string> items;
+    stringstream in(value);
+    string item;
+    while (getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * @brief Lê as opções da linha de comando
+ *
+ * @param argc - quantidade de argumentos
+ * @param argv - argumentos
+ * @param options - recebe as opções
+ * @return true - se todas as opções são válidas
+ */
+bool parseOptions(int argc, char const *argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string name = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "valor ausente para " << name << endl;
+            return false;
+        }
+        string value = argv[++i];
+        if (name == "--sizes") {
+            options.sizes.clear();
+            for (const string& size : splitList(value)) {
+                options.sizes.push_back(max(atoi(size.c_str()), 1));
+            }
+        } else if (name == "--shapes") {
+            options.shapes.clear();
+            for (const string& shapeName : splitList(value)) {
+                TreeShape shape;
+                if (!Tree_generator::parseShape(shapeName, shape)) {
+                    cerr << "formato desconhecido: " << shapeName << endl;
+                    return false;
+                }
+                options.shapes.push_back(shape);
+            }
+        } else if (name == "--engines") {
+            options.engines = splitList(value);
+            for (const string& engine : options.engines) {
+                if (engine != "apted" && engine != "zhsh") {
+                    cerr << "algoritmo desconhecido: " << engine << endl;
+                    return false;
+                }
+            }
+        } else if (name == "--pairs") {
+            options.pairs = max(atoi(value.c_str()), 1);
+        } else if (name == "--edits") {
+            options.edits = atoi(value.c_str());
+        } else if (name == "--warmup") {
+            options.warmup = max(atoi(value.c_str()), 0);
+        } else if (name == "--reps") {
+            options.reps = max(atoi(value.c_str()), 1);
+        } else if (name == "--seed") {
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        } else if (name == "--phases" && (value == "on" || value == "off")) {
+            options.phases = value == "on";
+        } else if (name == "--format" && (value == "csv" || value == "json")) {
+            options.json = value == "json";
+        } else if (name == "--output") {
+            options.output = value;
+        } else {
+            cerr << "opção inválida: " << name << " " << value << endl;
+            return false;
+        }
+    }
+    return !options.sizes.empty() && !options.shapes.empty() && !options.engines.empty();
+}
+
+/**
+ * @brief Converte uma linha para JSON
+ *
+ * @param row - resultado de uma combinação
+ * @return json - objeto com as estatísticas e, se medidas, as fases
+ */
+json rowToJson(const BenchmarkRow& row) {
+    json entry = {
+        {"engine", row.engine}, {"shape", row.shape}, {"nodes", row.nodes},
+        {"samples", row.samples}, {"outliers", row.outliers},
+        {"mean_ns", row.meanNs}, {"stddev_ns", row.stddevNs}, {"min_ns", row.minNs},
+        {"p50_ns", row.p50Ns}, {"p90_ns", row.p90Ns}, {"p99_ns", row.p99Ns}, {"max_ns", row.maxNs},
+        {"pairs_per_second", row.pairsPerSecond}, {"peak_rss_delta_kb", row.peakRssDeltaKb},
+        {"distance_sum", row.distanceSum}
+    };
+    if (row.hasPhases) {
+        const PhaseStats& phases = row.phases;
+        auto spf = [](const SpfStats& stats) { return json{{"calls", stats.calls}, {"ns", stats.ns}}; };
+        entry["phases"] = {
+            {"strategy_ns", phases.strategyNs}, {"ted_init_ns", phases.tedInitNs}, {"gted_ns", phases.gtedNs},
+            {"spfL", spf(phases.spfL)}, {"spfR", spf(phases.spfR)}, {"spfA", spf(phases.spfA)}, {"spf1", spf(phases.spf1)}
+        };
+    }
+    return entry;
+}
+
+/**
+ * @brief Lê uma linha gravada por rowToJson
+ *
+ * @param entry - objeto JSON
+ * @param row - recebe as estatísticas e, se presentes, as fases
+ */
+void rowFromJson(const json& entry, BenchmarkRow& row) {
+    row.engine = entry.at("engine").get<string>();
+    row.shape = entry.at("shape").get<string>();
+    row.nodes = entry.at("nodes").get<int>();
+    row.samples = entry.at("samples").get<size_t>();
+    row.outliers = entry.at("outliers").get<size_t>();
+    row.meanNs = entry.at("mean_ns").get<double>();
+    row.stddevNs = entry.at("stddev_ns").get<double>();
+    row.minNs = entry.at("min_ns").get<double>();
+    row.p50Ns = entry.at("p50_ns").get<double>();
+    row.p90Ns = entry.at("p90_ns").get<double>();
+    row.p99Ns = entry.at("p99_ns").get<double>();
+    row.maxNs = entry.at("max_ns").get<double>();
+    row.pairsPerSecond = entry.at("pairs_per_second").get<double>();
+    row.peakRssDeltaKb = entry.at("peak_rss_delta_kb").get<long>();
+    row.distanceSum = entry.at("distance_sum").get<double>();
+
+    auto found = entry.find("phases");
+    row.hasPhases = found != entry.end();
+    if (row.hasPhases) {
+        const json& phases = *found;
+        auto spf = [](const json& stats, SpfStats& spf) {
+            spf.calls = stats.at("calls").get<long>();
+            spf.ns = stats.at("ns").get<double>();
+        };
+        row.phases.strategyNs = phases.at("strategy_ns").get<double>();
+        row.phases.tedInitNs = phases.at("ted_init_ns").get<double>();
+        row.phases.gtedNs = phases.at("gted_ns").get<double>();
+        spf(phases.at("spfL"), row.phases.spfL);
+        spf(phases.at("spfR"), row.phases.spfR);
+        spf(phases.at("spfA"), row.phases.spfA);
+        spf(phases.at("spf1"), row.phases.spf1);
+    }
+}
+
+/**
+ * @brief Converte as linhas para JSON
+ *
+ * @param rows - resultados
+ * @param options - configuração da medição, gravada junto
+ * @return json - objeto com a configuração e as linhas
+ */
+json toJson(const vector<BenchmarkRow>& rows, const BenchmarkOptions& options) {
+    json result;
+    result["pairs"] = options.pairs;
+    result["edits"] = options.edits;
+    result["warmup"] = options.warmup;
+    result["reps"] = options.reps;
+    result["seed"] = options.seed;
+    result["results"] = json::array();
+    for (const BenchmarkRow& row : rows) {
+        result["results"].push_back(rowToJson(row));
+    }
+    return result;
+}
+
+/**
+ * @brief Grava as linhas em CSV, com cabeçalho
+ *
+ * @param out - destino
+ * @param rows - resultados
+ * @param options - configuração da medição (com --phases on, grava as colunas das fases)
+ */
+void writeCsv(ostream& out, const vector<BenchmarkRow>& rows, const BenchmarkOptions& options) {
+    out << "engine,shape,nodes,samples,outliers,mean_ns,stddev_ns,min_ns,p50_ns,p90_ns,p99_ns,max_ns,"
+           "pairs_per_second,peak_rss_delta_kb,distance_sum";
+    if (options.phases) {
+        out << ",strategy_ns,ted_init_ns,gted_ns,spfL_calls,spfL_ns,spfR_calls,spfR_ns,"
+               "spfA_calls,spfA_ns,spf1_calls,spf1_ns";
+    }
+    out << '\n' << fixed << setprecision(1);
+    for (const BenchmarkRow& row : rows) {
+        out << row.engine << ',' << row.shape << ',' << row.nodes << ',' << row.samples << ','
+            << row.outliers << ',' << row.meanNs << ',' << row.stddevNs << ',' << row.minNs << ','
+            << row.p50Ns << ',' << row.p90Ns << ',' << row.p99Ns << ',' << row.maxNs << ','
+            << row.pairsPerSecond << ',' << row.peakRssDeltaKb << ',' << row.distanceSum;
+        if (options.phases) {
+            // Linhas sem fases (Zhang-Shasha) ficam com zeros.
+            const PhaseStats& phases = row.phases;
+            out << ',' << phases.strategyNs << ',' << phases.tedInitNs << ',' << phases.gtedNs;
+            for (const SpfStats* spf : {&phases.spfL, &phases.spfR, &phases.spfA, &phases.spf1}) {
+                out << ',' << spf->calls << ',' << spf->ns;
+            }
+        }
+        out << '\n';
+    }
+}
+
+//------------------------------------------------------------------------------
+// Isolamento das combinações
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Mede uma combinação em um processo filho. O filho herda os pares já
+ *        indexados, zera o pico de memória, mede e devolve a linha em JSON por
+ *        um pipe, com o pico relativo à memória residente do início da medição.
+ *
+ * @param cell - mede a combinação, preenchendo a linha
+ * @param row - linha com engine, shape e nodes; recebe o resultado
+ * @return true - se o filho terminou e devolveu a linha
+ */
+bool measureInChild(const function<void(BenchmarkRow&)>& cell, BenchmarkRow& row) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    cout.flush();
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        long startKb = currentRssKb();
+        resetPeakRss();
+        cell(row);
+        row.peakRssDeltaKb = max(peakRssKb() - startKb, 0L);
+
+        string data = rowToJson(row).dump();
+        for (size_t written = 0; written < data.size();) {
+            ssize_t count = write(fds[1], data.data() + written, data.size() - written);
+            if (count <= 0) {
+                _exit(1);
+            }
+            written += count;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    string data;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, count);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return false;
+    }
+    json entry = json::parse(data, nullptr, false);
+    if (entry.is_discarded()) {
+        return false;
+    }
+    rowFromJson(entry, row);
+    return true;
+}
+
+// --- main --- //
+int main(int argc, char const *argv[]) {
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "uso: " << argv[0] << " [--sizes 10,50,100] [--shapes random-split,zig-zag] [--engines apted,zhsh]"
+             << " [--pairs P] [--edits K] [--warmup W] [--reps R] [--seed S] [--phases on|off]"
+             << " [--format csv|json] [--output arquivo]" << endl;
+        return 1;
+    }
+
+    Tree_generator gen(options.seed);
+    StringCostModel costModel;
+    ForestDist fd; // Reaproveita os buffers entre os pares, como em main; cada filho tem a sua cópia
+
+    map<string, function<float(const IndexedPair&)>> engines;
+    engines["apted"] = [&costModel](const IndexedPair& pair) {
+        Apted<StringNodeData> algorithm(&costModel);
+        return algorithm.computeEditDistance(pair.ni1, pair.ni2);
+    };
+    engines["zhsh"] = [&costModel, &fd](const IndexedPair& pair) {
+        return fd.treeDist(pair.ni1, pair.ni2, costModel);
+    };
+
+    vector<BenchmarkRow> rows;
+    for (TreeShape shape : options.shapes) {
+        for (int nodes : options.sizes) {
+            vector<IndexedPair> pairs = buildPairs(gen, shape, nodes, options, costModel);
+            for (const string& engine : options.engines) {
+                BenchmarkRow row;
+                row.engine = engine;
+                row.shape = Tree_generator::shapeName(shape);
+                row.nodes = nodes;
+                bool measured = measureInChild([&](BenchmarkRow& cellRow) {
+                    measure(engines[engine], pairs, options, cellRow);
+                    if (options.phases && engine == "apted") {
+                        measurePhases(pairs, costModel, cellRow);
+                    }
+                }, row);
+                if (!measured) {
+                    cerr << "falha ao medir " << row.engine << " " << row.shape << " " << row.nodes << endl;
+                    return 1;
+                }
+                rows.push_back(row);
+                cerr << row.engine << " " << row.shape << " " << row.nodes << ": p50 " << row.p50Ns << " ns" << endl;
+            }
+            releasePairs(pairs);
+        }
+    }
+
+    ofstream file;
+    if (options.output != "-") {
+        file.open(options.output);
+        if (!file) {
+            cerr << "não foi possível gravar " << options.output << endl;
+            return 1;
+        }
+    }
+    ostream& out = options.output == "-" ? cout : file;
+    if (options.json) {
+        out << toJson(rows, options).dump(4) << endl;
+    } else {
+        writeCsv(out, rows, options);
+    }
+    return 0;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file GenerateCorpus.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Geração de corpora de árvores e de pares de teste pela linha de comando
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ *
+ * Uso:
+ *   generate_corpus --out arquivo [--count N] [--nodes N] [--out-format ndjson|binary|pairs]
+ *                   [--shape random-split] [--arity A] [--edits K] [--mix I,R,N]
+ *                   [--fit amostra [--format pairs|trees|json|xml]] [--profile perfil.json]
+ *                   [--save-profile perfil.json] [--seed S] [--threads T]
+ *
+ * Sem --fit nem --profile, as árvores vêm da família --shape (generateCorpus).
+ * Com --fit, um perfil é ajustado à amostra (fitProfile) e as árvores seguem as
+ * suas distribuições de rótulos, filhos e tamanhos; com --profile, o perfil é
+ * lido de um arquivo gravado antes com --save-profile. Com perfil, o tamanho
+ * de cada árvore é sorteado entre os tamanhos do perfil, a menos que --nodes
+ * seja dado; sem perfil, --nodes vale 100 por padrão.
+ *
+ * --out-format pairs grava pares no formato de tests/trees.json em que t2 é t1
+ * com --edits edições (generatePlantedPairs), com o limite superior da
+ * distância em "bound"; só é aceito com --shape.
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../includes/json.hpp"
+#include "../generator/Tree_generator.hpp"
+#include "../generator/TreeProfile.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief Configuração da geração, lida da linha de comando
+ */
+struct CorpusOptions {
+    string output;                           /**< Arquivo de saída */
+    size_t count = 1000;                     /**< Árvores do corpus, ou pares com --out-format pairs */
+    int nodes = -1;                          /**< Tamanho das árvores; 0 sorteia entre os tamanhos do perfil, -1 usa o padrão do modo */
+    bool pairs = false;                      /**< Grava pares com edições plantadas em vez de um corpus */
+    CorpusFormat format = CorpusFormat::Ndjson;
+    TreeShape shape = TreeShape::RandomSplit;
+    int arity = 2;                           /**< Quantidade (ou média) de filhos, ver createShape */
+    int edits = 1;                           /**< Edições de t1 para t2 com --out-format pairs */
+    EditMix mix;
+    string sample;                           /**< Amostra para fitProfile; vazio gera por --shape */
+    SampleFormat sampleFormat = SampleFormat::Pairs;
+    string profile;                          /**< Perfil gravado por --save-profile */
+    string saveProfile;                      /**< Arquivo em que o perfil usado é gravado */
+    uint64_t seed = Tree_generator::DEFAULT_SEED;
+    size_t threads = 0;                      /**< Threads do gerador; 0 usa todos os núcleos */
+};
+
+/**
+ * @brief Lê os pesos de inserção, remoção e troca de rótulo de --mix
+ *
+ * @param value - três inteiros separados por vírgulas
+ * @param mix - recebe os pesos
+ * @return true - se há três pesos não negativos e ao menos um positivo
+ */
+bool parseMix(const string& value, EditMix& mix) {
+    stringstream in(value);
+    char comma1 = 0, comma2 = 0;
+    if (!(in >> mix.insert >> comma1 >> mix.remove >> comma2 >> mix.rename) || comma1 != ',' || comma2 != ',') {
+        return false;
+    }
+    return mix.insert >= 0 && mix.remove >= 0 && mix.rename >= 0 && mix.insert + mix.remove + mix.rename > 0;
+}
+
+/**
+ * @brief Lê as opções da linha de comando
+ *
+ * @param argc - quantidade de argumentos
+ * @param argv - argumentos
+ * @param options - recebe as opções
+ * @return true - se todas as opções são válidas
+ */
+bool parseOptions(int argc, char const *argv[], CorpusOptions& options) {
+    bool shapeGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        string name = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "valor ausente para " << name << endl;
+            return false;
+        }
+        string value = argv[++i];
+        if (name == "--out") {
+            options.output = value;
+        } else if (name == "--count") {
+            options.count = strtoul(value.c_str(), nullptr, 10);
+        } else if (name == "--nodes") {
+            options.nodes = max(atoi(value.c_str()), 0);
+        } else if (name == "--out-format" && (value == "ndjson" || value == "binary" || value == "pairs")) {
+            options.pairs = value == "pairs";
+            options.format = value == "binary" ? CorpusFormat::Binary : CorpusFormat::Ndjson;
+        } else if (name == "--shape") {
+            if (!Tree_generator::parseShape(value, options.shape)) {
+                cerr << "formato desconhecido: " << value << endl;
+                return false;
+            }
+            shapeGiven = true;
+        } else if (name == "--arity") {
+            options.arity = max(atoi(value.c_str()), 1);
+        } else if (name == "--edits") {
+            options.edits = max(atoi(value.c_str()), 0);
+        } else if (name == "--mix") {
+            if (!parseMix(value, options.mix)) {
+                cerr << "pesos inválidos: " << value << endl;
+                return false;
+            }
+        } else if (name == "--fit") {
+            options.sample = value;
+        } else if (name == "--format" && value == "pairs") {
+            options.sampleFormat = SampleFormat::Pairs;
+        } else if (name == "--format" && value == "trees") {
+            options.sampleFormat = SampleFormat::Trees;
+        } else if (name == "--format" && value == "json") {
+            options.sampleFormat = SampleFormat::Json;
+        } else if (name == "--format" && value == "xml") {
+            options.sampleFormat = SampleFormat::Xml;
+        } else if (name == "--profile") {
+            options.profile = value;
+        } else if (name == "--save-profile") {
+            options.saveProfile = value;
+        } else if (name == "--seed") {
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        } else if (name == "--threads") {
+            options.threads = strtoul(value.c_str(), nullptr, 10);
+        } else {
+            cerr << "opção inválida: " << name << " " << value << endl;
+            return false;
+        }
+    }
+
+    bool fromProfile = !options.sample.empty() || !options.profile.empty();
+    if (!options.sample.empty() && !options.profile.empty()) {
+        cerr << "--fit e --profile não podem ser usados juntos" << endl;
+        return false;
+    }
+    if (fromProfile && shapeGiven) {
+        cerr << "--shape não pode ser usado com --fit ou --profile" << endl;
+        return false;
+    }
+    if (options.pairs && fromProfile) {
+        cerr << "--out-format pairs só é aceito com --shape" << endl;
+        return false;
+    }
+    if (!fromProfile && options.nodes == 0) {
+        cerr << "--nodes 0 só é aceito com --fit ou --profile" << endl;
+        return false;
+    }
+    if (!fromProfile && !options.saveProfile.empty()) {
+        cerr << "--save-profile só é aceito com --fit ou --profile" << endl;
+        return false;
+    }
+    if (options.nodes < 0) {
+        options.nodes = fromProfile ? 0 : 100;
+    }
+    return !options.output.empty() && options.count > 0;
+}
+
+/**
+ * @brief Obtém o perfil das árvores: ajustado à amostra de --fit ou lido de --profile
+ *
+ * @param options - configuração da geração
+ * @param profile - recebe o perfil
+ * @return true - se o perfil foi obtido
+ */
+bool loadProfile(const CorpusOptions& options, TreeProfile& profile) {
+    if (!options.sample.empty()) {
+        string error;
+        if (!fitProfile(options.sample, options.sampleFormat, profile, &error)) {
+            cerr << "não foi possível ajustar o perfil: " << error << endl;
+            return false;
+        }
+        return true;
+    }
+
+    ifstream in(options.profile);
+    json object = json::parse(in, nullptr, false);
+    if (!in.is_open() || object.is_discarded() || !object.is_object()) {
+        cerr << "não foi possível ler o perfil " << options.profile << endl;
+        return false;
+    }
+    profile = TreeProfile::fromJson(object);
+    return true;
+}
+
+// --- main --- //
+int main(int argc, char const *argv[]) {
+    CorpusOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "uso: " << argv[0] << " --out arquivo [--count N] [--nodes N] [--out-format ndjson|binary|pairs]"
+             << " [--shape random-split] [--arity A] [--edits K] [--mix I,R,N]"
+             << " [--fit amostra [--format pairs|trees|json|xml]] [--profile perfil.json]"
+             << " [--save-profile perfil.json] [--seed S] [--threads T]" << endl;
+        return 1;
+    }
+
+    Tree_generator gen(options.seed, options.output);
+    if (options.pairs) {
+        gen.generatePlantedPairs(options.shape, options.nodes, options.edits, (int)options.count, options.mix, options.arity);
+        if (!ifstream(options.output)) {
+            cerr << "não foi possível gravar " << options.output << endl;
+            return 1;
+        }
+        cerr << options.count << " pares gravados em " << options.output << endl;
+        return 0;
+    }
+
+    bool written;
+    if (options.sample.empty() && options.profile.empty()) {
+        written = gen.generateCorpus(options.output, options.format, options.shape, options.nodes,
+                                     options.count, options.arity, options.threads);
+    } else {
+        TreeProfile profile;
+        if (!loadProfile(options, profile)) {
+            return 1;
+        }
+        if (!options.saveProfile.empty()) {
+            ofstream out(options.saveProfile);
+            out << profile.toJson().dump(4) << endl;
+            if (!out) {
+                cerr << "não foi possível gravar " << options.saveProfile << endl;
+                return 1;
+            }
+        }
+        written = gen.generateCorpus(options.output, options.format, profile, options.count,
+                                     options.nodes, options.threads);
+    }
+
+    if (!written) {
+        cerr << "não foi possível gravar " << options.output << endl;
+        return 1;
+    }
+    cerr << options.count << " árvores gravadas em " << options.output << endl;
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * @file NodeBuilder.hpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Conversão das árvores do gerador para Node, usada pelas ferramentas
+ * @date 2024-06-22
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ */
+
+#include <vector>
+#include "../APTED/lib/Capted.h"
+#include "../generator/Tree_generator.hpp"
+
+/**
+ * @brief Monta uma árvore de Node a partir da árvore plana, sem passar pela
+ *        notação de chaves (e sem recursão, então árvores profundas servem)
+ *
+ * @param tree - árvore gerada, com pelo menos um nó
+ * @return capted::Node<capted::StringNodeData>* - raiz da árvore (o chamador libera)
+ */
+inline capted::Node<capted::StringNodeData>* buildNodes(const GeneratedTree& tree) {
+    std::vector<capted::Node<capted::StringNodeData>*> nodes(tree.size());
+    for (size_t i = 0; i < tree.size(); ++i) {
+        nodes[i] = new capted::Node<capted::StringNodeData>(
+            new capted::StringNodeData(Tree_generator::labelName(tree.label[i])));
+        if (tree.parent[i] >= 0) {
+            nodes[tree.parent[i]]->addChild(nodes[i]);
+        }
+    }
+    return nodes[0];
+}
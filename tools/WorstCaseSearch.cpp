@@ -0,0 +1,309 @@
+/**
+ * @file WorstCaseSearch.cpp
+ * @author Bernardo Marques
+ * @author Bruno Santiago
+ * @author Fabio Freire
+ * @author Marcos Antônio Lommez
+ * @author Saulo de Moura
+ * @brief Busca evolutiva de pares de formatos de árvore que maximizam o trabalho
+ *        do APTED (quantidade de subproblemas ou tempo) para um tamanho fixo
+ * @date 2024-06-22
+ *
+ * Algoritmo original retirado de:
+ * <p>See the source code para mais comentários relacionados ao algoritmo.
+ *
+ * <p>Referências:
+ * <ul>
+ * <li>[1] M. Pawlik e N. Augsten. Efficient Computation of the Tree Edit
+ *      Distance. ACM Transactions on Database Systems (TODS) 40(1). 2015.
+ * <li>[2] M. Pawlik e N. Augsten. Tree edit distance: Robust and memory-
+ *      efficient. Information Systems 56. 2016.
+ * </ul>
+ *
+ * Algoritmo Original retirado de: https://github.com/DatabaseGroup/apted.git
+ * Algoritmo traduzido retirado de: https://github.com/Trinovantes/capted.git
+ *
+ * Algumas funções foram alteradas do algoritmo original ou traduzido para melhor compreensão do grupo.
+ *
+ * Uso:
+ *   worst_case_search [--nodes N] [--generations G] [--population P]
+ *                     [--metric counter|time] [--reps R] [--keep K]
+ *                     [--seed S] [--threads T] [--output arquivo]
+ *
+ * Os K piores pares encontrados são acrescentados ao arquivo de saída (array
+ * JSON no formato de tests/trees.json, lido por PairStream), sem repetir pares
+ * já gravados, para servirem de entradas de regressão.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../includes/json.hpp"
+#include "../APTED/lib/Capted.h"
+#include "../generator/Tree_generator.hpp"
+#include "NodeBuilder.hpp"
+
+using namespace capted;
+using json = nlohmann::json;
+
+/**
+ * @brief Configuração da busca, lida da linha de comando
+ */
+struct SearchOptions {
+    int nodes = 100;                         /**< Tamanho das duas árvores */
+    int generations = 200;                   /**< Quantidade de gerações */
+    int population = 16;                     /**< Pares mantidos a cada geração */
+    bool timeMetric = false;                 /**< Maximiza o tempo em vez dos subproblemas */
+    int reps = 3;                            /**< Medições por par com --metric time (usa a menor) */
+    int keep = 5;                            /**< Pares gravados ao fim */
+    uint64_t seed = Tree_generator::DEFAULT_SEED;
+    size_t threads = 0;                      /**< Threads na avaliação por subproblemas; 0 usa todos os núcleos */
+    string output = "tests/worst_cases.json";
+};
+
+/**
+ * @brief Par candidato e o trabalho medido para ele
+ */
+struct Candidate {
+    GeneratedTree t1;
+    GeneratedTree t2;
+    long subproblems = 0;
+    double timeNs = 0;
+
+    double fitness(bool timeMetric) const { return timeMetric ? timeNs : (double)subproblems; }
+};
+
+/**
+ * @brief Mede o par: quantidade de subproblemas do APTED e, com --metric time,
+ *        o menor tempo entre as repetições (só do cálculo, sem a indexação)
+ *
+ * @param candidate - par a ser medido
+ * @param options - configuração da busca
+ */
+void evaluate(Candidate& candidate, const SearchOptions& options) {
+    StringCostModel costModel;
+    Node<StringNodeData>* n1 = buildNodes(candidate.t1);
+    Node<StringNodeData>* n2 = buildNodes(candidate.t2);
+    NodeIndexer<StringNodeData> ni1(n1, &costModel);
+    NodeIndexer<StringNodeData> ni2(n2, &costModel);
+
+    int reps = options.timeMetric ? max(options.reps, 1) : 1;
+    candidate.timeNs = 0;
+    for (int r = 0; r < reps; ++r) {
+        Apted<StringNodeData> algorithm(&costModel);
+        auto startTime = std::chrono::steady_clock::now();
+        algorithm.computeEditDistance(&ni1, &ni2);
+        auto endTime = std::chrono::steady_clock::now();
+
+        double elapsed = std::chrono::duration<double, std::nano>(endTime - startTime).count();
+        candidate.timeNs = r == 0 ? elapsed : min(candidate.timeNs, elapsed);
+        candidate.subproblems = algorithm.getSubproblemCount();
+    }
+
+    delete n1;
+    delete n2;
+}
+
+/**
+ * @brief Mede vários pares; por subproblemas em paralelo, por tempo em sequência
+ *        (para uma medição não atrapalhar a outra)
+ *
+ * @param candidates - pares a serem medidos
+ * @param first - primeiro par ainda não medido
+ * @param pool - threads
+ * @param options - configuração da busca
+ */
+void evaluateAll(vector<Candidate>& candidates, size_t first, ThreadPool& pool, const SearchOptions& options) {
+    if (options.timeMetric) {
+        for (size_t i = first; i < candidates.size(); ++i) {
+            evaluate(candidates[i], options);
+        }
+        return;
+    }
+    pool.parallelFor(candidates.size() - first, [&](size_t i) {
+        evaluate(candidates[first + i], options);
+    });
+}
+
+/**
+ * @brief Lê as opções da linha de comando
+ *
+ * @param argc - quantidade de argumentos
+ * @param argv - argumentos
+ * @param options - recebe as opções
+ * @return true - se todas as opções são válidas
+ */
+bool parseOptions(int argc, char const *argv[], SearchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string name = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "valor ausente para " << name << endl;
+            return false;
+        }
+        string value = argv[++i];
+        if (name == "--nodes") {
+            options.nodes = atoi(value.c_str());
+        } else if (name == "--generations") {
+            options.generations = atoi(value.c_str());
+        } else if (name == "--population") {
+            options.population = max(atoi(value.c_str()), 1);
+        } else if (name == "--metric" && (value == "counter" || value == "time")) {
+            options.timeMetric = value == "time";
+        } else if (name == "--reps") {
+            options.reps = atoi(value.c_str());
+        } else if (name == "--keep") {
+            options.keep = atoi(value.c_str());
+        } else if (name == "--seed") {
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        } else if (name == "--threads") {
+            options.threads = strtoul(value.c_str(), nullptr, 10);
+        } else if (name == "--output") {
+            options.output = value;
+        } else {
+            cerr << "opção inválida: " << name << " " << value << endl;
+            return false;
+        }
+    }
+    return options.nodes > 0;
+}
+
+/**
+ * @brief Lê os pares já gravados no arquivo de saída. Um arquivo que não é um
+ *        array JSON (truncado, ou de outro formato) é recusado, para que não
+ *        seja sobrescrito e os resultados anteriores não se percam.
+ *
+ * @param path - arquivo JSON de pares
+ * @param pairs - recebe os pares gravados (vazio se o arquivo não existe)
+ * @return true - se o arquivo não existe, está vazio ou é um array JSON
+ */
+bool loadWorstPairs(const string& path, json& pairs) {
+    pairs = json::array();
+    ifstream in(path);
+    if (!in || in.peek() == ifstream::traits_type::eof()) {
+        return true;
+    }
+    json existing = json::parse(in, nullptr, false);
+    if (!existing.is_array()) {
+        cerr << path << " não contém um array JSON de pares; o arquivo não foi alterado" << endl;
+        return false;
+    }
+    pairs = existing;
+    return true;
+}
+
+/**
+ * @brief Acrescenta os pares ao arquivo de saída, sem repetir pares já gravados
+ *
+ * @param path - arquivo JSON de pares
+ * @param best - pares em ordem decrescente de trabalho
+ * @param options - configuração da busca
+ * @return int - quantidade de pares acrescentados, ou -1 se nada foi gravado
+ */
+int saveWorstPairs(const string& path, const vector<Candidate>& best, const SearchOptions& options) {
+    json pairs;
+    if (!loadWorstPairs(path, pairs)) {
+        return -1;
+    }
+
+    int added = 0;
+    for (int i = 0; i < (int)best.size() && i < options.keep; ++i) {
+        string t1 = Tree_generator::toBracket(best[i].t1);
+        string t2 = Tree_generator::toBracket(best[i].t2);
+        bool known = any_of(pairs.begin(), pairs.end(), [&](const json& pair) {
+            return pair.value("t1", "") == t1 && pair.value("t2", "") == t2;
+        });
+        if (known) {
+            continue;
+        }
+        json pair;
+        pair["ID"] = pairs.size();
+        pair["subproblems"] = best[i].subproblems;
+        if (options.timeMetric) {
+            pair["timeNs"] = best[i].timeNs;
+        }
+        pair["t1"] = t1;
+        pair["t2"] = t2;
+        pairs.push_back(pair);
+        added++;
+    }
+
+    ofstream out(path);
+    out << pairs.dump(4) << endl;
+    if (!out) {
+        cerr << "não foi possível gravar " << path << endl;
+        return -1;
+    }
+    return added;
+}
+
+// --- main --- //
+int main(int argc, char const *argv[]) {
+    SearchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "uso: " << argv[0] << " [--nodes N] [--generations G] [--population P] [--metric counter|time]"
+             << " [--reps R] [--keep K] [--seed S] [--threads T] [--output arquivo]" << endl;
+        return 1;
+    }
+
+    // Confere o arquivo de saída antes da busca, e não só ao gravar.
+    json previous;
+    if (!loadWorstPairs(options.output, previous)) {
+        return 1;
+    }
+
+    Tree_generator gen(options.seed);
+    ThreadPool pool(options.threads);
+    const bool timeMetric = options.timeMetric;
+    auto better = [timeMetric](const Candidate& a, const Candidate& b) {
+        return a.fitness(timeMetric) > b.fitness(timeMetric);
+    };
+
+    // População inicial: pares de famílias de formatos, incluindo os piores casos conhecidos.
+    const TreeShape shapes[] = {
+        TreeShape::ZigZag, TreeShape::LeftBranch, TreeShape::RightBranch, TreeShape::FullKary,
+        TreeShape::RandomSplit, TreeShape::RandomFanout, TreeShape::RandomRecursive, TreeShape::Path
+    };
+    const size_t numShapes = sizeof(shapes) / sizeof(shapes[0]);
+    uint64_t nextStream = 0;
+    vector<Candidate> population(options.population);
+    for (int i = 0; i < options.population; ++i) {
+        TreeRng rng = gen.stream(nextStream++);
+        population[i].t1 = Tree_generator::createShape(rng, shapes[i % numShapes], options.nodes);
+        population[i].t2 = Tree_generator::createShape(rng, shapes[(i / numShapes + i + 1) % numShapes], options.nodes);
+    }
+    evaluateAll(population, 0, pool, options);
+    sort(population.begin(), population.end(), better);
+
+    // (mu + lambda): cada par gera um filho com alguns movimentos de subárvore em
+    // uma das árvores, e os melhores entre pais e filhos seguem.
+    for (int generation = 1; generation <= options.generations; ++generation) {
+        size_t parents = population.size();
+        for (size_t i = 0; i < parents; ++i) {
+            TreeRng rng = gen.stream(nextStream++);
+            Candidate child = population[i];
+            GeneratedTree& target = rng.below(2) == 0 ? child.t1 : child.t2;
+            for (int moves = 1 + rng.below(3); moves > 0; --moves) {
+                target = Tree_generator::moveSubtree(rng, target);
+            }
+            population.push_back(std::move(child));
+        }
+        evaluateAll(population, parents, pool, options);
+        stable_sort(population.begin(), population.end(), better);
+        population.resize(parents);
+
+        if (generation % 10 == 0 || generation == options.generations) {
+            cout << "geração " << generation << ": " << population[0].subproblems << " subproblemas, "
+                 << population[0].timeNs << " ns" << endl;
+        }
+    }
+
+    int added = saveWorstPairs(options.output, population, options);
+    if (added < 0) {
+        return 1;
+    }
+    cout << added << " pares acrescentados a " << options.output << endl;
+    return 0;
+}